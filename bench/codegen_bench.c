@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "compilercontext.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+#include "Semantics/nameresolution.h"
+#include "Semantics/typechecker.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+#include "RegAlloc/regalloc.h"
+#include "Codegen/codegen.h"
+#include "errors.h"
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+int main(int argc, char** argv) {
+	char* file = argc == 3 && strcmp(argv[1], "--emit-asm") == 0 ? argv[2] : argv[1];
+	if (argc < 2 || argc > 3 || (argc == 3 && file == argv[1])) {
+		printf("usage: codegen_bench [--emit-asm] <file.z>\n");
+		return 1;
+	}
+
+	CompilerContext* ctx = create_compiler_context();
+	if (!ctx) return 1;
+	ctx->asm_listing = argc == 3;
+
+	Lexer* lexer = lex(ctx, file);
+	Node* ast_root = parse(ctx, lexer);
+	if (!phase_accumulated_errors(ctx)) resolve_tree(ctx, ast_root);
+	if (!phase_accumulated_errors(ctx)) typecheck_tree(ctx, ast_root);
+	if (phase_accumulated_errors(ctx)) {
+		emit_errors(ctx);
+		free_compiler_context(ctx);
+		return 1;
+	}
+
+	TACTable* tac_table = build_tacs(ctx, ast_root);
+	FunctionList* function_list = build_cfg(ctx, tac_table);
+	reg_alloc(ctx, function_list);
+
+	// encoding (and the listing, if asked for) is timed; writing the ELF is not
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ASMWriter* writer = emit_asm(ctx, function_list, file);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	printf("%s: %d functions, %zu bytes of code", file, function_list->size, writer->code->length);
+	if (writer->listing) {
+		printf(", %zu bytes of asm", writer->length);
+	}
+	printf("\ncodegen %.2f ms\n", elapsed_ms(start, end));
+	free_compiler_context(ctx);
+	return 0;
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# Sweeps one gen_program.py knob at a time, compiles each program with
+# zxal --time-report=json and records the per-phase times. For each sweep it
+# also prints the growth exponent of every phase against the token count
+# (time ~ tokens^k between the smallest and largest program), so a phase
+# with k well above 1 is the one that scales super-linearly.
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+
+PHASES = ["lex", "parse", "resolve", "typecheck", "tac", "fold", "cfg", "regalloc", "codegen"]
+
+# the knobs a sweep leaves alone stay at gen_program.py's defaults
+SWEEPS = [
+	("functions", [100, 200, 400, 800]),
+	("length", [25, 50, 100, 200]),
+	("depth", [1, 2, 3, 4, 5]),
+	("nesting", [2, 4, 8, 16]),
+	("fanout", [1, 4, 16, 64]),
+]
+
+def compile_program(zxal, flags, path, runs):
+	best = None
+	for _ in range(runs):
+		result = subprocess.run([zxal, "--time-report=json"] + flags + [path], capture_output=True, text=True)
+		if result.returncode != 0:
+			sys.exit("%s failed on %s:\n%s" % (zxal, path, result.stdout + result.stderr))
+		report = json.loads(result.stdout.strip().splitlines()[-1])
+		if best is None or report["total_ms"] < best["total_ms"]:
+			best = report
+	return best
+
+def exponent(first, last, key):
+	if first[key] <= 0 or last[key] <= 0: return float("nan")
+	return math.log(last[key] / first[key]) / math.log(last["tokens"] / first["tokens"])
+
+def main():
+	parser = argparse.ArgumentParser(description="time each zxal phase over generated programs")
+	parser.add_argument("--zxal", default="./zxal")
+	parser.add_argument("--out", default="bench/out")
+	parser.add_argument("--runs", type=int, default=3, help="keep the fastest of this many compiles")
+	parser.add_argument("--sweep", action="append", help="only run these sweeps")
+	parser.add_argument("flags", nargs="*", help="passed on to zxal, e.g. -- --linear-scan")
+	args = parser.parse_args()
+
+	os.makedirs(args.out, exist_ok=True)
+	generator = os.path.join(os.path.dirname(os.path.abspath(__file__)), "gen_program.py")
+	columns = ["sweep", "value", "tokens", "instructions", "blocks", "edges"] + PHASES + ["backend", "total"]
+	rows = []
+
+	print("\t".join(columns))
+	for knob, values in SWEEPS:
+		if args.sweep and knob not in args.sweep: continue
+
+		sweep = []
+		for value in values:
+			path = os.path.join(args.out, "program_%s_%d.z" % (knob, value))
+			with open(path, "w") as program:
+				subprocess.run([sys.executable, generator, "--%s" % knob, str(value)], stdout=program, check=True)
+
+			report = compile_program(args.zxal, args.flags, path, args.runs)
+			counts = report["counts"]
+			row = {
+				"sweep": knob, "value": value, "tokens": counts["tokens"], "instructions": counts["tac_instructions"],
+				"blocks": counts["basic_blocks"], "edges": counts["interference_edges"],
+				"backend": report["backend_ms"], "total": report["total_ms"],
+			}
+			row.update(report["phases_ms"])
+			sweep.append(row)
+			rows.append(row)
+			print("\t".join(("%.3f" % row[c]) if isinstance(row[c], float) else str(row[c]) for c in columns))
+			sys.stdout.flush()
+
+		if len(sweep) > 1 and sweep[-1]["tokens"] > sweep[0]["tokens"]:
+			growth = ["%s %.2f" % (key, exponent(sweep[0], sweep[-1], key)) for key in PHASES + ["total"]]
+			print("# %s growth vs tokens: %s" % (knob, ", ".join(growth)))
+
+	with open(os.path.join(args.out, "compile_bench.tsv"), "w") as table:
+		table.write("\t".join(columns) + "\n")
+		for row in rows:
+			table.write("\t".join(str(row[c]) for c in columns) + "\n")
+
+main()
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+# Emits a ZXAL program of roughly N lines whose statements are long
+# expressions mixing every binary precedence level, unary operators and
+# parentheses, for timing expression parsing.
+import random
+import sys
+
+ARITHMETIC = ["+", "-", "*", "/", "%"]
+RELATIONAL = ["<", ">", "<=", ">=", "==", "!="]
+LOGICAL = ["&&", "||"]
+
+def operand(rng, depth):
+	choice = rng.randrange(6)
+	if choice == 0 and depth < 2:
+		return "(%s)" % arithmetic(rng, rng.randint(2, 4), depth + 1)
+	if choice == 1:
+		return "-%s" % rng.choice(["a", "b", "c"])
+	if choice == 2:
+		return str(rng.randint(1, 99))
+	return rng.choice(["a", "b", "c"])
+
+def arithmetic(rng, operands, depth):
+	parts = [operand(rng, depth)]
+	for _ in range(operands - 1):
+		parts.append(rng.choice(ARITHMETIC))
+		parts.append(operand(rng, depth))
+	return " ".join(parts)
+
+def condition(rng, comparisons, operands):
+	parts = []
+	for i in range(comparisons):
+		if i: parts.append(rng.choice(LOGICAL))
+		parts.append("%s %s %s" % (arithmetic(rng, operands, 0), rng.choice(RELATIONAL), arithmetic(rng, operands, 0)))
+	return " ".join(parts)
+
+def function(out, rng, index, statements, operands):
+	out.append("function e%d(a: int, b: int) -> int {" % index)
+	out.append("\tlet c: int = a + b;")
+	for i in range(statements):
+		if i % 4 == 3:
+			out.append("\tif (%s) {" % condition(rng, 3, operands // 3))
+			out.append("\t\tc = c + 1;")
+			out.append("\t}")
+		else:
+			out.append("\tc = %s;" % arithmetic(rng, operands, 0))
+	out.append("\treturn c;")
+	out.append("}")
+	out.append("")
+
+def main():
+	lines = int(sys.argv[1]) if len(sys.argv) > 1 else 50000
+	operands = int(sys.argv[2]) if len(sys.argv) > 2 else 24
+	statements = 40
+
+	rng = random.Random(1)
+	out = []
+	index = 0
+	while len(out) < lines:
+		function(out, rng, index, statements, operands)
+		index += 1
+
+	out.append("function main() -> int {")
+	out.append("\treturn e0(1, 2);")
+	out.append("}")
+	sys.stdout.write("\n".join(out) + "\n")
+
+main()
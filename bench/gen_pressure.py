@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+# Emits a ZXAL program whose functions each keep N values live at once:
+# every local is defined up front and only consumed by the final sum, for
+# timing liveness, interference graph construction and register allocation.
+import sys
+
+def function(out, index, live_values):
+	out.append("function p%d(a: int) -> int {" % index)
+	for i in range(live_values):
+		out.append("\tlet v%d: int = a + %d;" % (i, i))
+	out.append("\tlet s: int = 0;")
+	for i in reversed(range(live_values)):
+		out.append("\ts = s + v%d;" % i)
+	out.append("\treturn s;")
+	out.append("}")
+	out.append("")
+
+def main():
+	functions = int(sys.argv[1]) if len(sys.argv) > 1 else 4
+	live_values = int(sys.argv[2]) if len(sys.argv) > 2 else 2000
+
+	out = []
+	for index in range(functions):
+		function(out, index, live_values)
+
+	out.append("function main() -> int {")
+	out.append("\treturn p0(1);")
+	out.append("}")
+	sys.stdout.write("\n".join(out) + "\n")
+
+main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# Emits a ZXAL program shaped by five knobs, for timing how each compiler
+# phase scales with one of them while the others stay put:
+#   --functions  number of functions besides main
+#   --length     statements per function
+#   --depth      depth of the expression tree on the right of each statement
+#   --nesting    how deeply if and while blocks nest inside a function
+#   --fanout     calls each function makes to the functions before it
+import argparse
+import random
+import sys
+
+ARITHMETIC = ["+", "-", "*"]
+RELATIONAL = ["<", ">", "<=", ">=", "==", "!="]
+
+def expression(rng, depth, names):
+	if depth <= 0:
+		if rng.randrange(3) == 0:
+			return str(rng.randint(1, 99))
+		return rng.choice(names)
+	left = expression(rng, depth - 1, names)
+	right = expression(rng, depth - 1, names)
+	return "(%s %s %s)" % (left, rng.choice(ARITHMETIC), right)
+
+def condition(rng, names):
+	return "%s %s %s" % (rng.choice(names), rng.choice(RELATIONAL), expression(rng, 1, names))
+
+class Function:
+	def __init__(self, rng, index, args):
+		self.rng = rng
+		self.index = index
+		self.args = args
+		self.lines = []
+		self.statements = 0
+		self.loops = 0
+
+	def statement(self, indent):
+		self.lines.append("%sc = %s;" % (indent, expression(self.rng, self.args.depth, ["a", "b", "c"])))
+		self.statements += 1
+
+	# one statement per level on the way in and out, so a function of
+	# length L and nesting N holds about L / (2N) full nests
+	def nest(self, level):
+		indent = "\t" * (level + 1)
+		self.statement(indent)
+		if level < self.args.nesting and self.statements < self.args.length:
+			if level % 2 == 0:
+				self.lines.append("%sif (%s) {" % (indent, condition(self.rng, ["a", "b", "c"])))
+				self.nest(level + 1)
+				self.lines.append("%s}" % indent)
+			else:
+				counter = "w%d" % self.loops
+				self.loops += 1
+				self.lines.append("%slet %s: int = 0;" % (indent, counter))
+				self.lines.append("%swhile (%s < a) {" % (indent, counter))
+				self.nest(level + 1)
+				self.lines.append("%s\t%s = %s + 1;" % (indent, counter, counter))
+				self.lines.append("%s}" % indent)
+			self.statement(indent)
+
+	def emit(self, out):
+		out.append("function f%d(a: int, b: int) -> int {" % self.index)
+		out.append("\tlet c: int = a + b;")
+		for k in range(self.args.fanout):
+			callee = self.index - 1 - k
+			if callee < 0: break
+			out.append("\tc = c + f%d(b, c);" % callee)
+		while self.statements < self.args.length:
+			self.nest(0)
+		out.extend(self.lines)
+		out.append("\treturn c;")
+		out.append("}")
+		out.append("")
+
+def main():
+	parser = argparse.ArgumentParser(description="generate a ZXAL program for compile time benchmarks")
+	parser.add_argument("--functions", type=int, default=100)
+	parser.add_argument("--length", type=int, default=20)
+	parser.add_argument("--depth", type=int, default=2)
+	parser.add_argument("--nesting", type=int, default=2)
+	parser.add_argument("--fanout", type=int, default=1)
+	parser.add_argument("--seed", type=int, default=1)
+	args = parser.parse_args()
+
+	rng = random.Random(args.seed)
+	out = []
+	for index in range(args.functions):
+		Function(rng, index, args).emit(out)
+
+	out.append("function main() -> int {")
+	if args.functions > 0:
+		out.append("\treturn f%d(1, 2);" % (args.functions - 1))
+	else:
+		out.append("\treturn 0;")
+	out.append("}")
+	sys.stdout.write("\n".join(out) + "\n")
+
+main()
@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+# Emits a ZXAL program of roughly N lines made of functions with many
+# locals spread across nested if/while scopes, for timing name resolution.
+import sys
+
+def function(out, index, locals_per_function, depth):
+	out.append("function f%d(a: int, b: int) -> int {" % index)
+	out.append("\tlet v0: int = a + b;")
+	indent = "\t"
+	for d in range(depth):
+		out.append("%sif (v0 > %d) {" % (indent, d))
+		indent += "\t"
+	for i in range(1, locals_per_function):
+		out.append("%slet v%d: int = v%d + a * %d;" % (indent, i, i - 1, i % 7 + 1))
+	out.append("%sv0 = v%d;" % (indent, locals_per_function - 1))
+	for d in range(depth):
+		indent = indent[:-1]
+		out.append("%s}" % indent)
+	out.append("\treturn v0;")
+	out.append("}")
+	out.append("")
+
+def main():
+	lines = int(sys.argv[1]) if len(sys.argv) > 1 else 50000
+	locals_per_function = int(sys.argv[2]) if len(sys.argv) > 2 else 200
+	depth = 4
+
+	out = []
+	index = 0
+	while len(out) < lines:
+		function(out, index, locals_per_function, depth)
+		index += 1
+
+	out.append("function main() -> int {")
+	out.append("\treturn f0(1, 2);")
+	out.append("}")
+	sys.stdout.write("\n".join(out) + "\n")
+
+main()
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "compilercontext.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+#include "Semantics/nameresolution.h"
+#include "Semantics/typechecker.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+#include "RegAlloc/regalloc.h"
+#include "errors.h"
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+int main(int argc, char** argv) {
+	bool linear_scan = argc == 3 && strcmp(argv[1], "--linear-scan") == 0;
+	if (argc != 2 && !linear_scan) {
+		printf("usage: interference_bench [--linear-scan] <file.z>\n");
+		return 1;
+	}
+	char* file = argv[argc - 1];
+
+	CompilerContext* ctx = create_compiler_context();
+	if (!ctx) return 1;
+	ctx->linear_scan = linear_scan;
+
+	Lexer* lexer = lex(ctx, file);
+	Node* ast_root = parse(ctx, lexer);
+	if (!phase_accumulated_errors(ctx)) resolve_tree(ctx, ast_root);
+	if (!phase_accumulated_errors(ctx)) typecheck_tree(ctx, ast_root);
+	if (phase_accumulated_errors(ctx)) {
+		emit_errors(ctx);
+		free_compiler_context(ctx);
+		return 1;
+	}
+
+	TACTable* tac_table = build_tacs(ctx, ast_root);
+
+	struct timespec start, mid, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	FunctionList* function_list = build_cfg(ctx, tac_table);
+	clock_gettime(CLOCK_MONOTONIC, &mid);
+	reg_alloc(ctx, function_list);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	int nodes = 0;
+	int edges = 0;
+	int max_degree = 0;
+	int spilled = 0;
+	for (int i = 0; i < function_list->size; i++) {
+		OperandNumbering* numbering = function_list->infos[i]->cfg->numbering;
+		for (int j = 0; j < numbering->count; j++) {
+			if (numbering->operands[j]->permanent_frame_position) spilled++;
+		}
+
+		InterferenceGraph* graph = function_list->infos[i]->graph;
+		if (!graph) continue;
+
+		nodes += graph->num_nodes;
+		edges += graph->num_edges;
+		for (int j = 0; j < graph->num_nodes; j++) {
+			if (graph->degrees[j] > max_degree) max_degree = graph->degrees[j];
+		}
+	}
+
+	if (linear_scan) {
+		printf("%s: %d functions, linear scan, %d in frame\n", file, function_list->size, spilled);
+		printf("liveness %.2f ms, register allocation %.2f ms\n",
+			elapsed_ms(start, mid), elapsed_ms(mid, end));
+	} else {
+		printf("%s: %d functions, %d nodes, %d edges, max degree %d, %d in frame\n",
+			file, function_list->size, nodes, edges, max_degree, spilled);
+		printf("liveness + interference %.2f ms, register allocation %.2f ms\n",
+			elapsed_ms(start, mid), elapsed_ms(mid, end));
+	}
+	free_compiler_context(ctx);
+	return 0;
+}
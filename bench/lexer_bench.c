@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "compilercontext.h"
+#include "Lexer/lexer.h"
+#include "Lexer/token.h"
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// each run lexes the file from scratch in a fresh context; the best run is
+// reported so page cache and allocator warm-up do not count. --stream pulls
+// every token through a streaming lexer the way the parser does
+int main(int argc, char** argv) {
+	char* file = argc == 3 && strcmp(argv[1], "--stream") == 0 ? argv[2] : argv[1];
+	if (argc < 2 || argc > 3 || (argc == 3 && file == argv[1])) {
+		printf("usage: lexer_bench [--stream] <file.z>\n");
+		return 1;
+	}
+	bool streaming = argc == 3;
+
+	int runs = 5;
+	double best = -1;
+	int tokens = 0;
+	size_t bytes = 0;
+	size_t token_bytes = 0;
+
+	for (int i = 0; i < runs; i++) {
+		CompilerContext* ctx = create_compiler_context();
+		if (!ctx) return 1;
+
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		Lexer* lexer = NULL;
+		if (streaming) {
+			lexer = stream_tokens(ctx, file);
+			for (int index = 0; lexer->kinds[fetch_token(ctx, lexer, index)] != TOKEN_EOF; index++);
+		} else {
+			lexer = lex(ctx, file);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		double ms = elapsed_ms(start, end);
+		if (best < 0 || ms < best) best = ms;
+		tokens = lexer->size;
+		bytes = lexer->info->length;
+		token_bytes = lexer->capacity * (sizeof(uint8_t) + 2 * sizeof(uint32_t));
+		free_compiler_context(ctx);
+	}
+
+	printf("%s: %zu bytes, %d tokens, %zu bytes of token storage\n", file, bytes, tokens, token_bytes);
+	printf("lex %.2f ms, %.1f MB/s\n", best, (bytes / (1024.0 * 1024.0)) / (best / 1000.0));
+	return 0;
+}
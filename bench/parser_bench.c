@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <time.h>
+#include "compilercontext.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+#include "errors.h"
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// each run lexes the file up front and times only the parse; the best run
+// is reported so page cache and allocator warm-up do not count
+int main(int argc, char** argv) {
+	if (argc != 2) {
+		printf("usage: parser_bench <file.z>\n");
+		return 1;
+	}
+
+	int runs = 5;
+	double best = -1;
+	int tokens = 0;
+	uint32_t nodes = 0;
+
+	for (int i = 0; i < runs; i++) {
+		CompilerContext* ctx = create_compiler_context();
+		if (!ctx) return 1;
+
+		Lexer* lexer = lex(ctx, argv[1]);
+		if (phase_accumulated_errors(ctx)) {
+			emit_errors(ctx);
+			free_compiler_context(ctx);
+			return 1;
+		}
+
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		parse(ctx, lexer);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		if (phase_accumulated_errors(ctx)) {
+			emit_errors(ctx);
+			free_compiler_context(ctx);
+			return 1;
+		}
+
+		double ms = elapsed_ms(start, end);
+		if (best < 0 || ms < best) best = ms;
+		tokens = lexer->size;
+		nodes = ctx->node_pool->num_nodes - 1;
+		free_compiler_context(ctx);
+	}
+
+	printf("%s: %d tokens, %u nodes\n", argv[1], tokens, nodes);
+	printf("parse %.2f ms, %.1f M tokens/s\n", best, tokens / (best * 1000.0));
+	return 0;
+}
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <time.h>
+#include "compilercontext.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+#include "Semantics/nameresolution.h"
+#include "errors.h"
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+int main(int argc, char** argv) {
+	if (argc != 2) {
+		printf("usage: resolve_bench <file.z>\n");
+		return 1;
+	}
+
+	CompilerContext* ctx = create_compiler_context();
+	if (!ctx) return 1;
+
+	Lexer* lexer = lex(ctx, argv[1]);
+	Node* ast_root = parse(ctx, lexer);
+	if (phase_accumulated_errors(ctx)) {
+		emit_errors(ctx);
+		free_compiler_context(ctx);
+		return 1;
+	}
+
+	// measured before resolution, which hangs symbols off the names
+	int lines = lexer->info->line_count;
+	uint32_t nodes = ctx->node_pool->num_nodes - 1;
+	uint32_t bindings = ctx->node_pool->num_bindings - 1;
+	size_t ast_bytes = node_pool_bytes(ctx->node_pool);
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	resolve_tree(ctx, ast_root);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	printf("%s: %d lines, name resolution %.2f ms\n", argv[1], lines, elapsed_ms(start, end));
+	printf("%u nodes, %u bindings, %zu AST bytes, %.1f AST bytes per line\n", 
+		nodes, bindings, ast_bytes, (double)ast_bytes / lines);
+	free_compiler_context(ctx);
+	return 0;
+}
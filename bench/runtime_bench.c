@@ -0,0 +1,264 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+
+// runs executables zxal produced and reports the median wall time, cycles
+// and instructions of each, against a baseline of the same numbers. the
+// counters come from perf_event_open on the child; where the kernel does not
+// allow that (perf_event_paranoid, containers) only the time is reported.
+// a kernel returns its result as the exit status, which is checked against
+// the baseline so a codegen change that speeds a kernel up by breaking it
+// does not pass for an improvement. times and counters only compare on the
+// machine that wrote the baseline, so the one in the tree carries just the
+// exit statuses, with -1 for the rest.
+
+#define MAX_KERNELS 64
+#define MAX_RUNS 101
+
+typedef struct {
+	char name[64];
+	int exit_status;
+	double ms;
+	long long cycles; // -1 when the counter was not available
+	long long instructions;
+} KernelResult;
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+static int open_counter(pid_t pid, uint64_t config) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.enable_on_exec = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+}
+
+static long long read_counter(int fd) {
+	long long value;
+	if (fd == -1 || read(fd, &value, sizeof(value)) != sizeof(value)) return -1;
+	return value;
+}
+
+// the child waits on a pipe until the counters are attached, so they see
+// the exec and nothing before it
+static bool run_once(char* path, int* exit_status, double* ms, long long* cycles, long long* instructions) {
+	int go[2];
+	if (pipe(go) == -1) {
+		perror("pipe");
+		return false;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pid_t pid = fork();
+	if (pid == -1) {
+		perror("fork");
+		return false;
+	}
+	if (pid == 0) {
+		char byte;
+		close(go[1]);
+		if (read(go[0], &byte, 1) != 1) _exit(127);
+		char* argv[] = {path, NULL};
+		execv(path, argv);
+		_exit(127);
+	}
+
+	close(go[0]);
+	int cycles_fd = open_counter(pid, PERF_COUNT_HW_CPU_CYCLES);
+	int instructions_fd = open_counter(pid, PERF_COUNT_HW_INSTRUCTIONS);
+	if (write(go[1], "x", 1) != 1) perror("write");
+	close(go[1]);
+
+	int status;
+	waitpid(pid, &status, 0);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	*ms = elapsed_ms(start, end);
+	*cycles = read_counter(cycles_fd);
+	*instructions = read_counter(instructions_fd);
+	if (cycles_fd != -1) close(cycles_fd);
+	if (instructions_fd != -1) close(instructions_fd);
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) == 127) {
+		printf("%s did not run to completion\n", path);
+		return false;
+	}
+	*exit_status = WEXITSTATUS(status);
+	return true;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+static int compare_counts(const void* a, const void* b) {
+	long long x = *(const long long*)a, y = *(const long long*)b;
+	return (x > y) - (x < y);
+}
+
+static bool run_kernel(char* path, int runs, KernelResult* result) {
+	double ms[MAX_RUNS];
+	long long cycles[MAX_RUNS], instructions[MAX_RUNS];
+
+	snprintf(result->name, sizeof(result->name), "%s", basename(path));
+	for (int i = 0; i < runs; i++) {
+		int status;
+		if (!run_once(path, &status, &ms[i], &cycles[i], &instructions[i])) return false;
+		if (i > 0 && status != result->exit_status) {
+			printf("%s exited with %d and then %d\n", path, result->exit_status, status);
+			return false;
+		}
+		result->exit_status = status;
+	}
+
+	qsort(ms, runs, sizeof(double), compare_doubles);
+	qsort(cycles, runs, sizeof(long long), compare_counts);
+	qsort(instructions, runs, sizeof(long long), compare_counts);
+	result->ms = ms[runs / 2];
+	result->cycles = cycles[0] == -1 ? -1 : cycles[runs / 2];
+	result->instructions = instructions[0] == -1 ? -1 : instructions[runs / 2];
+	return true;
+}
+
+static int read_baseline(char* file, KernelResult* baseline) {
+	FILE* in = fopen(file, "r");
+	if (!in) {
+		perror(file);
+		return -1;
+	}
+
+	char line[256];
+	int count = 0;
+	while (fgets(line, sizeof(line), in) && count < MAX_KERNELS) {
+		if (line[0] == '#' || strncmp(line, "kernel\t", 7) == 0) continue;
+
+		KernelResult* entry = &baseline[count];
+		if (sscanf(line, "%63s %d %lf %lld %lld", entry->name, &entry->exit_status,
+			&entry->ms, &entry->cycles, &entry->instructions) == 5) {
+			count++;
+		}
+	}
+	fclose(in);
+	return count;
+}
+
+static bool write_baseline(char* file, KernelResult* results, int count) {
+	FILE* out = fopen(file, "w");
+	if (!out) {
+		perror(file);
+		return false;
+	}
+
+	fprintf(out, "# measured on one machine, rewrite it before comparing on another\n");
+	fprintf(out, "kernel\texit\tms\tcycles\tinstructions\n");
+	for (int i = 0; i < count; i++) {
+		fprintf(out, "%s\t%d\t%.2f\t%lld\t%lld\n", results[i].name, results[i].exit_status,
+			results[i].ms, results[i].cycles, results[i].instructions);
+	}
+	fclose(out);
+	return true;
+}
+
+static KernelResult* find_baseline(KernelResult* baseline, int count, char* name) {
+	for (int i = 0; i < count; i++) {
+		if (strcmp(baseline[i].name, name) == 0) return &baseline[i];
+	}
+	return NULL;
+}
+
+static void print_change(long long now, long long before) {
+	if (now == -1) {
+		printf("%14s %8s", "-", "");
+	} else if (before <= 0) {
+		printf("%14lld %8s", now, "");
+	} else {
+		printf("%14lld %+7.1f%%", now, 100.0 * (now - before) / before);
+	}
+}
+
+int main(int argc, char** argv) {
+	int runs = 5;
+	char* baseline_file = NULL;
+	char* write_file = NULL;
+	int first = 1;
+
+	for (; first < argc && strncmp(argv[first], "--", 2) == 0; first++) {
+		if (strcmp(argv[first], "--runs") == 0 && first + 1 < argc) {
+			runs = atoi(argv[++first]);
+		} else if (strcmp(argv[first], "--baseline") == 0 && first + 1 < argc) {
+			baseline_file = argv[++first];
+		} else if (strcmp(argv[first], "--write-baseline") == 0 && first + 1 < argc) {
+			write_file = argv[++first];
+		} else {
+			break;
+		}
+	}
+
+	if (first >= argc || argc - first > MAX_KERNELS || runs < 1 || runs > MAX_RUNS) {
+		printf("usage: runtime_bench [--runs N] [--baseline file] [--write-baseline file] <executable>...\n");
+		return 1;
+	}
+
+	KernelResult baseline[MAX_KERNELS];
+	int num_baseline = 0;
+	if (baseline_file) {
+		num_baseline = read_baseline(baseline_file, baseline);
+		if (num_baseline == -1) return 1;
+	}
+
+	KernelResult results[MAX_KERNELS];
+	int count = 0;
+	bool failed = false;
+
+	printf("%-16s %4s %10s %8s %14s %8s %14s %8s\n", "kernel", "exit", "ms", "", "cycles", "", "instructions", "");
+	for (int i = first; i < argc; i++) {
+		KernelResult* result = &results[count];
+		memset(result, 0, sizeof(KernelResult));
+		if (!run_kernel(argv[i], runs, result)) {
+			failed = true;
+			continue;
+		}
+		count++;
+
+		KernelResult* before = find_baseline(baseline, num_baseline, result->name);
+		printf("%-16s %4d %10.2f", result->name, result->exit_status, result->ms);
+		if (before && before->ms > 0) {
+			printf(" %+7.1f%%", 100.0 * (result->ms - before->ms) / before->ms);
+		} else {
+			printf(" %8s", "");
+		}
+		print_change(result->cycles, before ? before->cycles : -1);
+		print_change(result->instructions, before ? before->instructions : -1);
+		printf("\n");
+
+		if (before && before->exit_status != result->exit_status) {
+			printf("%s: exit status %d, the baseline has %d\n", result->name, result->exit_status, before->exit_status);
+			failed = true;
+		}
+	}
+
+	if (count > 0 && results[0].cycles == -1) {
+		printf("(hardware counters unavailable, see /proc/sys/kernel/perf_event_paranoid)\n");
+	}
+	if (write_file && !failed && !write_baseline(write_file, results, count)) return 1;
+	return failed ? 1 : 0;
+}
@@ -1,20 +1,149 @@
 #include "stdlib.h"
 #include "codegen.h"
+#include "elfwriter.h"
 #include "assert.h"
-
-static jmp_true_index = 1;
-static jmp_false_index = 1;
-static jmp_end_index = 1;
+#include "backend.h"
+#include "RegAlloc/regalloc.h"
 
 char* registers[] = {
 	"rax", "rbx", "rdi", "rsi", "rdx", "rcx",
-	"r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+	"r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
+	"rsp", "rbp"
 };
 
+void reserve_asm(ASMWriter* writer, size_t length) {
+	if (writer->length + length <= writer->capacity) return;
+
+	size_t new_capacity = writer->capacity * 2;
+	while (writer->length + length > new_capacity) {
+		new_capacity *= 2;
+	}
+
+	char* new_buffer = arena_reallocate(writer->arena, writer->buffer, writer->length, new_capacity);
+	assert(new_buffer);
+
+	writer->buffer = new_buffer;
+	writer->capacity = new_capacity;
+}
+
+void append_asm(ASMWriter* writer, const char* text, size_t length) {
+	reserve_asm(writer, length);
+	memcpy(writer->buffer + writer->length, text, length);
+	writer->length += length;
+}
+
+void append_asm_text(ASMWriter* writer, const char* text) {
+	append_asm(writer, text, strlen(text));
+}
+
+void append_asm_register(ASMWriter* writer, int reg) {
+	append_asm_text(writer, registers[reg]);
+}
+
+void append_asm_immediate(ASMWriter* writer, long long value) {
+	char digits[24];
+	int length = 0;
+
+	unsigned long long magnitude = value < 0 ? -(unsigned long long)value : (unsigned long long)value;
+	do {
+		digits[sizeof(digits) - 1 - length++] = '0' + magnitude % 10;
+		magnitude /= 10;
+	} while (magnitude);
+
+	if (value < 0) {
+		digits[sizeof(digits) - 1 - length++] = '-';
+	}
+	append_asm(writer, digits + sizeof(digits) - length, length);
+}
+
+void append_asm_frame_slot(ASMWriter* writer, size_t frame_byte_offset) {
+	append_asm(writer, "[rbp - ", 7);
+	append_asm_immediate(writer, (long long)frame_byte_offset);
+	append_asm(writer, "]", 1);
+}
+
+void append_asm_operand(ASMWriter* writer, AsmOperand operand) {
+	switch (operand.kind) {
+		case ASM_REGISTER: append_asm_register(writer, operand.value.reg); break;
+		case ASM_IMMEDIATE: append_asm_immediate(writer, operand.value.immediate); break;
+		case ASM_FRAME_SLOT: append_asm_frame_slot(writer, operand.value.frame_byte_offset); break;
+		case ASM_LABEL: append_asm_text(writer, operand.value.label); break;
+		default: break;
+	}
+}
+
+void end_asm_line(ASMWriter* writer) {
+	append_asm(writer, "\n", 1);
+}
+
+// every instruction is encoded, and also formatted when --emit-asm wants the
+// listing; a frame slot without a register operand needs an explicit size
+void emit_instruction(ASMWriter* writer, x86_op_t op, AsmOperand dest, AsmOperand src) {
+	encode_instruction(writer->code, op, dest, src);
+	if (!writer->listing) return;
+
+	append_asm(writer, "\t", 1);
+	append_asm_text(writer, x86_mnemonic(op));
+	if (dest.kind != ASM_NONE) {
+		append_asm(writer, " ", 1);
+		if (dest.kind == ASM_FRAME_SLOT && src.kind != ASM_REGISTER) {
+			append_asm(writer, "qword ", 6);
+		}
+		append_asm_operand(writer, dest);
+	}
+
+	if (src.kind != ASM_NONE) {
+		append_asm(writer, ", ", 2);
+		append_asm_operand(writer, src);
+	}
+	end_asm_line(writer);
+}
+
+void emit_reg(ASMWriter* writer, x86_op_t op, int reg) {
+	emit_instruction(writer, op, asm_register(reg), asm_none());
+}
+
+void emit_reg_reg(ASMWriter* writer, x86_op_t op, int dest, int src) {
+	emit_instruction(writer, op, asm_register(dest), asm_register(src));
+}
+
+void emit_reg_frame(ASMWriter* writer, x86_op_t op, int dest, size_t frame_byte_offset) {
+	emit_instruction(writer, op, asm_register(dest), asm_frame_slot(frame_byte_offset));
+}
+
+void emit_frame_reg(ASMWriter* writer, x86_op_t op, size_t frame_byte_offset, int src) {
+	emit_instruction(writer, op, asm_frame_slot(frame_byte_offset), asm_register(src));
+}
+
+void emit_reg_immediate(ASMWriter* writer, x86_op_t op, int dest, long long value) {
+	emit_instruction(writer, op, asm_register(dest), asm_immediate(value));
+}
+
+void emit_asm_jump(ASMWriter* writer, x86_op_t op, const char* label) {
+	emit_instruction(writer, op, asm_label(label), asm_none());
+}
+
+void emit_asm_label(ASMWriter* writer, const char* label) {
+	define_code_label(writer->code, label);
+	if (!writer->listing) return;
+
+	append_asm_text(writer, label);
+	append_asm(writer, ":\n", 2);
+}
+
+// listing-only text such as fasm directives and blank lines
 void write_asm_to_file(ASMWriter* writer, char* text) {
-	if (!text) return;
-	fseek(writer->file, 0, SEEK_END);
-	fprintf(writer->file, "%s\n", text);
+	if (!text || !writer->listing) return;
+	append_asm_text(writer, text);
+	end_asm_line(writer);
+}
+
+void flush_asm_writer(ASMWriter* writer) {
+	size_t written = fwrite(writer->buffer, 1, writer->length, writer->file);
+	if (written != writer->length) {
+		perror("Unable to write assembly output.\n");
+	}
+	fclose(writer->file);
 }
 
 bool is_caller_saved(int reg) {
@@ -37,31 +166,32 @@ bool is_callee_saved(int reg) {
 	return false;
 }
 
-char* operator_to_string(tac_t type) {
+x86_op_t operator_to_op(tac_t type) {
 	switch (type) {
-		case TAC_ADD: return "add";
-		case TAC_SUB: return "sub";
-		case TAC_MUL: return "mul";
-		case TAC_DIV: return "div";
+		case TAC_ADD: return X86_ADD;
+		case TAC_SUB: return X86_SUB;
+		case TAC_MUL: return X86_IMUL;
+		default: return X86_DIV;
 	}
 }
 
 char* generate_jmp_label(CompilerContext* ctx, jmp_label_t type) {   
-	char buffer[40];
+	FunctionContext* function = ctx->function;
+	char buffer[160];
 
 	switch (type) {
 		case TRUE: {
-	    	snprintf(buffer, sizeof(buffer), ".L_true%d", jmp_true_index++);
+	    	snprintf(buffer, sizeof(buffer), ".L%s_true%d", function->name, function->jmp_true_index++);
 	    	break;
 	 	}
 
 	 	case FALSE: {
-	    	snprintf(buffer, sizeof(buffer), ".L_false%d", jmp_false_index++);
+	    	snprintf(buffer, sizeof(buffer), ".L%s_false%d", function->name, function->jmp_false_index++);
 	    	break;
 	 	}
 
 		case END: {
-	     	snprintf(buffer, sizeof(buffer), ".L_end%d", jmp_end_index++);
+	     	snprintf(buffer, sizeof(buffer), ".L%s_end%d", function->name, function->jmp_end_index++);
 	     	break;
 	 	}
  	}
@@ -75,28 +205,27 @@ char* generate_jmp_label(CompilerContext* ctx, jmp_label_t type) {
 	return jmp_label;
 }
 
-char* get_op_code(tac_t type) {
+x86_op_t get_op_code(tac_t type) {
 	switch (type) {
-		case TAC_NOT_EQUAL: return "je";
-		case TAC_EQUAL: return "jne";
-		case TAC_LESS: return "jge"; 
-		case TAC_LESS_EQUAL: return "jg";
- 		case TAC_GREATER: return "jle";
- 		case TAC_GREATER_EQUAL: return "jl";
+		case TAC_NOT_EQUAL: return X86_JE;
+		case TAC_EQUAL: return X86_JNE;
+		case TAC_LESS: return X86_JGE; 
+		case TAC_LESS_EQUAL: return X86_JG;
+ 		case TAC_GREATER: return X86_JLE;
+ 		default: return X86_JL;
 	}
 }
 
 void generate_corresponding_jump(ASMWriter* writer, tac_t kind, char* jmp_label) {
-	char buffer[32];
 	switch (kind) {
-		case TAC_LESS: snprintf(buffer, sizeof(buffer), "\tjge %s", jmp_label); break;
-		case TAC_LESS_EQUAL: snprintf(buffer, sizeof(buffer), "\tjge %s", jmp_label); break;
-		case TAC_GREATER: snprintf(buffer, sizeof(buffer), "\tjle %s", jmp_label); break;
-		case TAC_GREATER_EQUAL: snprintf(buffer, sizeof(buffer), "\tjle %s", jmp_label); break;
-		case TAC_EQUAL: snprintf(buffer, sizeof(buffer), "\tjne %s", jmp_label); break;
-		case TAC_NOT_EQUAL: snprintf(buffer, sizeof(buffer), "\tje %s", jmp_label); break;
+		case TAC_LESS: emit_asm_jump(writer, X86_JGE, jmp_label); break;
+		case TAC_LESS_EQUAL: emit_asm_jump(writer, X86_JG, jmp_label); break;
+		case TAC_GREATER: emit_asm_jump(writer, X86_JLE, jmp_label); break;
+		case TAC_GREATER_EQUAL: emit_asm_jump(writer, X86_JL, jmp_label); break;
+		case TAC_EQUAL: emit_asm_jump(writer, X86_JNE, jmp_label); break;
+		case TAC_NOT_EQUAL: emit_asm_jump(writer, X86_JE, jmp_label); break;
+		case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 	}
-	write_asm_to_file(writer, buffer);
 }
 
 ArgumentList* find_arg_list(BasicBlock* block, TACInstruction* tac) {
@@ -104,59 +233,68 @@ ArgumentList* find_arg_list(BasicBlock* block, TACInstruction* tac) {
 		ArgumentList* current = block->sargs->lists[i];
 		CallInstruction* call_instr = current->c_instr;
 		if ((call_instr && call_instr->instr_id == tac->id )&&
-			(strcmp(call_instr->func_name, tac->result->value.sym->name) == 0)) {
+			call_instr->func_name == tac->result->value.sym->name) {
 			return current;
 		}
 	}
 	return NULL;
 }
 
+// where codegen reads an operand from: its register, or the register it
+// borrowed for this instruction if it lives in the frame. one that was
+// never given a register would be encoded as garbage
+int operand_register(Operand* op) {
+	assert(!op->permanent_frame_position || op->temp_register != -1);
+	return op->permanent_frame_position ? op->temp_register : op->assigned_register;
+}
+
+// where an instruction can address an operand directly
+AsmOperand operand_location(Operand* op) {
+	if (op->permanent_frame_position) return asm_frame_slot(op->frame_byte_offset);
+	return asm_register(op->assigned_register);
+}
+
 void emit_reloads(ASMWriter* writer, ReloadBundle* bundle) {
 	if (bundle) {
-		char buffer[30];
 		for (int i = 0; i < bundle->size; i++) {
 			Reload* r = &bundle->reloads[i];
 			switch (r->direction) {
-				case REG_TO_FRAME: {
-					snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s", r->frame_byte_offset, registers[r->assigned_register]);
-					break;
-				}
-				case FRAME_TO_REG: {
-					snprintf(buffer, sizeof(buffer), "\tmov %s, [rbp - %zu]", registers[r->assigned_register], r->frame_byte_offset);
-					break;
-				}
-				case POP_FROM_STACK: {
-					snprintf(buffer, sizeof(buffer), "\tpop %s", registers[r->assigned_register]);
-					break;
-				}
+				case REG_TO_FRAME: emit_frame_reg(writer, X86_MOV, r->frame_byte_offset, r->assigned_register); break;
+				case FRAME_TO_REG: emit_reg_frame(writer, X86_MOV, r->assigned_register, r->frame_byte_offset); break;
+				case POP_FROM_STACK: emit_reg(writer, X86_POP, r->assigned_register); break;
 			}
-			write_asm_to_file(writer, buffer);
 		}
 	}
 }
 
 void emit_spills(ASMWriter* writer, SpillBundle* bundle) {
 	if (bundle) {
-		char buffer[30];
 		for (int i = 0; i < bundle->size; i++) {
 			Spill* s = &bundle->spills[i];
 			switch (s->direction) {
-				case REG_TO_FRAME: {
-					snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s", s->frame_byte_offset, registers[s->assigned_register]);
-					break;
-				}
+				case REG_TO_FRAME: emit_frame_reg(writer, X86_MOV, s->frame_byte_offset, s->assigned_register); break;
+				case FRAME_TO_REG: emit_reg_frame(writer, X86_MOV, s->assigned_register, s->frame_byte_offset); break;
+				case PUSH_TO_STACK: emit_reg(writer, X86_PUSH, s->assigned_register); break;
+			}
+		}
+	}
+}
 
-				case FRAME_TO_REG: {
-					snprintf(buffer, sizeof(buffer), "\tmov %s, [rbp - %zu]", registers[s->assigned_register], s->frame_byte_offset);
-					break;
-				}
+// a variable's operand is shared by all of its uses, so the scratch register
+// a use was scheduled to load it into is taken from that use's own spills
+void claim_temp_registers(TACInstruction* tac, SpillBundle* bundle) {
+	if (!bundle) return;
 
-				case PUSH_TO_STACK: {
-					snprintf(buffer, sizeof(buffer), "\tpush %s", registers[s->assigned_register]);
-					break;
-				}
+	for (int i = 0; i < bundle->size; i++) {
+		Spill* s = &bundle->spills[i];
+		if (s->direction != FRAME_TO_REG) continue;
+
+		Operand* operands[2] = {tac->op1, tac->op2};
+		for (int k = 0; k < 2; k++) {
+			Operand* op = operands[k];
+			if (op && op->permanent_frame_position && (int)op->frame_byte_offset == s->frame_byte_offset) {
+				op->temp_register = s->assigned_register;
 			}
-			write_asm_to_file(writer, buffer); 
 		}
 	}
 }
@@ -219,8 +357,79 @@ ReloadBundle* gather_matching_reloads(CompilerContext* ctx, ReloadSchedule* relo
 	return bundle;
 }
 
+// registers the callee may overwrite that hold a value still needed after
+// the call; the allocator keeps its own values out of them, so these are
+// parameters still sitting in the registers they arrived in. a call reads
+// none of its own operands, so what is live into it is what is live across
+// it. rax is left out since it carries the return value
+int caller_saved_live_across(TACInstruction* call) {
+	int saved = 0;
+	if (!call->live_out) return 0;
+
+	for (int i = 0; i < call->live_out->size; i++) {
+		Operand* op = call->live_out->elements[i];
+		if (op->permanent_frame_position) continue;
+
+		int reg = op->assigned_register;
+		if (reg > 0 && is_caller_saved(reg)) saved |= 1 << reg;
+	}
+	return saved;
+}
+
+// an instruction's live_out holds what is live going into it, so what is
+// live after instruction index is what the next one that records a set
+// needs, or the block's out set after the last
+bool live_after(CFG* cfg, BasicBlock* block, int index, Operand* op) {
+	for (int i = index + 1; i < block->num_instructions; i++) {
+		TACInstruction* next = block->instructions[i];
+		if (!next || next->kind == TAC_IF_FALSE || next->kind == TAC_LABEL || next->kind == TAC_GOTO) continue;
+		return contains_operand(next->live_out, op);
+	}
+
+	int number = find_operand_number(cfg->numbering, op);
+	return number != -1 && bitset_contains(block->out_set, number);
+}
+
+// the result is computed in op1's register, then moved out. when op1 is
+// still live afterwards it is computed in the result's register instead, or
+// op1's register is saved around it if the result has none to spare
+void emit_binary_operation(ASMWriter* writer, CFG* cfg, BasicBlock* block, int index) {
+	TACInstruction* tac = block->instructions[index];
+	if (tac->op1->permanent_frame_position) {
+		assert(tac->op1->temp_register != -1);
+	}
+
+	x86_op_t op = operator_to_op(tac->kind);
+	int dest = operand_register(tac->op1);
+	int result = tac->result->permanent_frame_position ? -1 : tac->result->assigned_register;
+	bool op1_live = !tac->op1->permanent_frame_position && result != dest && live_after(cfg, block, index, tac->op1);
+
+	if (op1_live && result != -1) {
+		bool op2_in_result = !tac->op2->permanent_frame_position && tac->op2->assigned_register == result;
+		if (!op2_in_result) {
+			emit_reg_reg(writer, X86_MOV, result, dest);
+			emit_instruction(writer, op, asm_register(result), operand_location(tac->op2));
+			return;
+		}
+
+		if (tac->kind != TAC_SUB) {
+			emit_reg_reg(writer, op, result, dest);
+			return;
+		}
+	}
+
+	if (op1_live) emit_reg(writer, X86_PUSH, dest);
+	emit_instruction(writer, op, asm_register(dest), operand_location(tac->op2));
+
+	if (tac->result->permanent_frame_position) {
+		emit_frame_reg(writer, X86_MOV, tac->result->frame_byte_offset, dest);
+	} else {
+		emit_reg_reg(writer, X86_MOV, tac->result->assigned_register, dest);
+	}
+	if (op1_live) emit_reg(writer, X86_POP, dest);
+}
+
 void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInfo* info) {
-	char buffer[100];
 	CFG* cfg = info->cfg;
 	for (int i = 0; i < cfg->num_blocks; i++) {
 		BasicBlock* block = cfg->all_blocks[i]; 
@@ -228,187 +437,94 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 			TACInstruction* tac = block->instructions[j];
 			if (tac && tac->handled) continue;
 
-			SpillBundle* spill_bundle = gather_matching_spills(ctx, block->spill_schedule, j);
+			SpillBundle* spill_bundle = (i == 0 && j == 0) ? NULL : gather_matching_spills(ctx, block->spill_schedule, j);
 			ReloadBundle* reload_bundle = gather_matching_reloads(ctx, block->reload_schedule, j);
 
-			if (spill_bundle && spill_bundle->size > 0) {
-				emit_spills(writer, spill_bundle);
-			}
-			
+			// what earlier instructions saved comes back before this one
+			// saves anything, so pushes and pops stay nested
 			if (reload_bundle && reload_bundle->size > 0) {
 				emit_reloads(writer, reload_bundle);
 			}
+
+			if (spill_bundle && spill_bundle->size > 0) {
+				emit_spills(writer, spill_bundle);
+				claim_temp_registers(tac, spill_bundle);
+			}
 			
 			switch (tac->kind) {
 				case TAC_BOOL:
 				case TAC_CHAR:
 				case TAC_INTEGER: {
-					if (tac->result->permanent_frame_position) {
-						// if (tac->result->access_via_rsp) {
-						// 	snprintf(buffer, sizeof(buffer), "\tmov [rsp + %zu], %d",
-						// 		tac->result->frame_byte_offset,
-						// 		tac->op1->value.int_val);
-						// } else {
-						// 	snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %d",
-						// 		tac->result->frame_byte_offset,
-						// 		tac->op1->value.int_val);							
-						// }
-					snprintf(buffer, sizeof(buffer), "\tmov qword [rbp - %zu], %d",
-						tac->result->frame_byte_offset,
-						tac->op1->value.int_val);							
-					} else {
-						snprintf(buffer, sizeof(buffer), "\tmov %s, %d",
-							registers[tac->result->assigned_register],
-							tac->op1->value.int_val);
-					}
-					write_asm_to_file(writer, buffer);
+					emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(tac->op1->value.int_val));
 					break;
 				}
 
 				case TAC_LABEL: {
-					snprintf(buffer, sizeof(buffer), "%s:", tac->result->value.label_name);
-					write_asm_to_file(writer, buffer);
+					emit_asm_label(writer, tac->result->value.label_name);
 					break;
 				}
 
 				case TAC_GOTO: {
-					snprintf(buffer, sizeof(buffer), "\tjmp %s", tac->result->value.label_name);
-					write_asm_to_file(writer, buffer);
+					emit_asm_jump(writer, X86_JMP, tac->result->value.label_name);
+					break;
+				}
+
+				// a branch on a value computed earlier; the ones right after
+				// the compare that computes them are fused with it
+				case TAC_IF_FALSE: {
+					emit_instruction(writer, X86_CMP, operand_location(tac->op1), asm_immediate(0));
+					emit_asm_jump(writer, X86_JE, tac->op2->value.label_name);
 					break;
 				}
 
 				case TAC_UNARY_ADD:
 					break;
 
+				// flipped in the result's location, so op1 keeps its value; bools
+				// are 0 or 1. in front of a branch only the flags are needed
 				case TAC_NOT: {
-					if (tac->op1->permanent_frame_position) {
-						snprintf(buffer, sizeof(buffer), "\txor %s, 1", registers[tac->op1->temp_register]);
-					} else {
-						snprintf(buffer, sizeof(buffer), "\txor %s, 1", registers[tac->op1->assigned_register]);
-					}
-					write_asm_to_file(writer, buffer);
-
-					if (tac->op1->permanent_frame_position) {
-						snprintf(buffer, sizeof(buffer), "\ttest %s, %s", registers[tac->op1->temp_register], registers[tac->op1->temp_register]);
-					} else {
-						snprintf(buffer, sizeof(buffer), "\ttest %s, %s", registers[tac->op1->assigned_register], registers[tac->op1->assigned_register]);
+					TACInstruction* next_tac = j + 1 < block->num_instructions ? block->instructions[j + 1] : NULL;
+					if (next_tac && next_tac->kind == TAC_IF_FALSE) {
+						next_tac->handled = true;
+						emit_instruction(writer, X86_CMP, operand_location(tac->op1), asm_immediate(0));
+						emit_reloads(writer, gather_matching_reloads(ctx, block->reload_schedule, j + 1));
+						emit_asm_jump(writer, X86_JNE, next_tac->op2->value.label_name);
+						break;
 					}
-					write_asm_to_file(writer, buffer);
-
-					if (j + 1 < block->num_instructions) {
-						Operand* jmp_op = NULL;
-						TACInstruction* next_tac = block->instructions[j + 1];
-						
-						switch (next_tac->kind) {
-							case TAC_IF_FALSE: {
-								jmp_op = next_tac->op2;
-								next_tac->handled = true;
-								break;
-							}
-						}
-
-						if (jmp_op) {
-							snprintf(buffer, sizeof(buffer), "\tjz %s", jmp_op->value.label_name);
-							write_asm_to_file(writer, buffer);
-						} else {
-							char* label_true = generate_jmp_label(ctx, TRUE);
-							char* label_false = generate_jmp_label(ctx, FALSE);
-							char* label_end = generate_jmp_label(ctx, END);
-							assert(label_true && label_false && label_end);
 
-							snprintf(buffer, sizeof(buffer), "\tjz %s", label_false);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->permanent_frame_position) {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 1", tac->result->frame_byte_offset);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 1", registers[tac->result->assigned_register]);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tjmp %s", label_end);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_false);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->permanent_frame_position) {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 0", tac->result->frame_byte_offset);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 0", registers[tac->result->assigned_register]);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_end);
-							write_asm_to_file(writer, buffer);
-						}
+					if (tac->result->permanent_frame_position) {
+						emit_frame_reg(writer, X86_MOV, tac->result->frame_byte_offset, operand_register(tac->op1));
+					} else if (tac->op1->permanent_frame_position || tac->op1->assigned_register != tac->result->assigned_register) {
+						emit_instruction(writer, X86_MOV, asm_register(tac->result->assigned_register), operand_location(tac->op1));
 					}
+					emit_instruction(writer, X86_XOR, operand_location(tac->result), asm_immediate(1));
 					break;
 				}
 
+				// negated in the result's location, so a live op1 keeps its value
 				case TAC_UNARY_SUB: {
-					if (tac->op1->permanent_frame_position) {
-						snprintf(buffer, sizeof(buffer), "\tneg [rbp - %zu]", tac->op1->frame_byte_offset);
-					}else {
-						snprintf(buffer, sizeof(buffer), "\tneg %s", registers[tac->op1->assigned_register]);
-					}
-					write_asm_to_file(writer, buffer);
-
 					if (tac->result->permanent_frame_position) {
-						if (tac->op1->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op1->temp_register]);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op1->assigned_register]);
-						}
-					} else {
-						if (tac->op1->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, [rbp - %zu]",
-								registers[tac->result->assigned_register],
-								tac->op1->frame_byte_offset);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, %s", 
-								registers[tac->result->assigned_register],
-								registers[tac->op1->assigned_register]);
-						}
+						emit_frame_reg(writer, X86_MOV, tac->result->frame_byte_offset, operand_register(tac->op1));
+					} else if (tac->op1->permanent_frame_position || tac->op1->assigned_register != tac->result->assigned_register) {
+						emit_instruction(writer, X86_MOV, asm_register(tac->result->assigned_register), operand_location(tac->op1));
 					}
-					write_asm_to_file(writer, buffer);
+					emit_instruction(writer, X86_NEG, operand_location(tac->result), asm_none());
 					break;
 				}
 
 				case TAC_RETURN: {
 					if (tac->result) {
 						if (tac->op1) {
-							bool can_emit = false;
 							if (tac->op1->permanent_frame_position) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, [rbp - %zu]",
-									registers[tac->result->assigned_register],
-									tac->op1->frame_byte_offset
-								);
-								can_emit = true;
-
-							} else {
-								if (strcmp(registers[tac->op1->assigned_register], "rax") != 0) {
-									snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-										registers[tac->result->assigned_register],
-										registers[tac->op1->assigned_register]
-									);									
-									can_emit = true;
-								}
+								emit_reg_frame(writer, X86_MOV, tac->result->assigned_register, tac->op1->frame_byte_offset);
+							} else if (tac->op1->assigned_register != 0) {
+								emit_reg_reg(writer, X86_MOV, tac->result->assigned_register, tac->op1->assigned_register);
 							}
-
-							if (can_emit) {
-								write_asm_to_file(writer, buffer);
-							}							
 						}
 						
 						emit_reloads(writer, block->reload_bundle);
-
-						snprintf(buffer, sizeof(buffer), "\tleave\n\tret");
-						write_asm_to_file(writer, buffer);
+						emit_instruction(writer, X86_LEAVE, asm_none(), asm_none());
+						emit_instruction(writer, X86_RET, asm_none(), asm_none());
 					} 
 					break;
 				}
@@ -416,40 +532,19 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 				case TAC_ASSIGNMENT: {
 					if (tac->op2->kind == OP_RETURN) {
 						if (tac->result->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], rax", tac->result->frame_byte_offset);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, rax", registers[tac->result->assigned_register]);
+							emit_frame_reg(writer, X86_MOV, tac->result->frame_byte_offset, 0);
+						} else if (tac->result->assigned_register != 0) {
+							emit_reg_reg(writer, X86_MOV, tac->result->assigned_register, 0);
 						}
-						write_asm_to_file(writer, buffer);
 						break;
 					}
 
 					if (tac->result->permanent_frame_position) {
-						if (tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op2->temp_register]
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op2->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					} else {
-						if (tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, [rbp - %zu]",
-								registers[tac->result->assigned_register],
-								tac->op2->frame_byte_offset
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-								registers[tac->result->assigned_register],
-								registers[tac->op2->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
+						emit_frame_reg(writer, X86_MOV, tac->result->frame_byte_offset, operand_register(tac->op2));
+					} else if (tac->op2->permanent_frame_position) {
+						emit_reg_frame(writer, X86_MOV, tac->result->assigned_register, tac->op2->frame_byte_offset);
+					} else if (tac->result->assigned_register != tac->op2->assigned_register) {
+						emit_reg_reg(writer, X86_MOV, tac->result->assigned_register, tac->op2->assigned_register);
 					}
 					break;
 				}
@@ -461,27 +556,10 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 				case TAC_LESS_EQUAL:
 				case TAC_GREATER_EQUAL: {
 					if (tac->op1->permanent_frame_position && tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], %s",
-								tac->op1->frame_byte_offset,
-								registers[tac->op2->temp_register]
-							);
-					} else if (tac->op1->assigned_register != -1 && tac->op2->permanent_frame_position) {
-						snprintf(buffer, sizeof(buffer), "\tcmp %s, [rbp - %zu]",
-							registers[tac->op1->assigned_register],
-							tac->op2->frame_byte_offset
-						);
-					} else if (tac->op1->permanent_frame_position && tac->op2->assigned_register != -1) {
-						snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], %s",
-							tac->op1->frame_byte_offset,
-							registers[tac->op2->assigned_register]
-						);
+						emit_frame_reg(writer, X86_CMP, tac->op1->frame_byte_offset, tac->op2->temp_register);
 					} else {
-						snprintf(buffer, sizeof(buffer), "\tcmp %s, %s",
-							registers[tac->op1->assigned_register],
-							registers[tac->op2->assigned_register]
-						);
+						emit_instruction(writer, X86_CMP, operand_location(tac->op1), operand_location(tac->op2));
 					}
-					write_asm_to_file(writer, buffer);
 						
 					if (j + 1 < block->num_instructions) {
 						Operand* jmp_op = NULL;
@@ -493,9 +571,15 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 								next_tac->handled = true;
 								break;
 							}
+
+							case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 						}
 
+						// the branch is skipped as an instruction of its own, so
+						// what comes back before it does so here; pops and
+						// moves leave the flags alone
 						if (jmp_op) {
+							emit_reloads(writer, gather_matching_reloads(ctx, block->reload_schedule, j + 1));
 							generate_corresponding_jump(writer, tac->kind, jmp_op->value.label_name);							
 						} else {
 							char* label_true = generate_jmp_label(ctx, TRUE);
@@ -503,37 +587,13 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 							char* label_end = generate_jmp_label(ctx, END);
 							assert(label_true && label_false && label_end);
 
-							char* jmp_instr = get_op_code(tac->kind);
-							assert(jmp_instr);
-
-							snprintf(buffer, sizeof(buffer), "\t%s %s", jmp_instr, label_false);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_true);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 1", registers[tac->result->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 1", tac->result->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tjmp %s", label_end);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_false);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 0", registers[tac->result->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 0", tac->result->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_end);
-							write_asm_to_file(writer, buffer);
+							emit_asm_jump(writer, get_op_code(tac->kind), label_false);
+							emit_asm_label(writer, label_true);
+							emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(1));
+							emit_asm_jump(writer, X86_JMP, label_end);
+							emit_asm_label(writer, label_false);
+							emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(0));
+							emit_asm_label(writer, label_end);
 						}
 					}
 					break;
@@ -550,79 +610,36 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 								next_tac->handled = true;
 								break;
 							}
+
+							case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 						}
 
+						// jumps to the IF_FALSE's target only when neither side is true
 						if (jmp_op) {
-							if (tac->op1->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 1", registers[tac->op1->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 1", tac->op1->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", jmp_op->value.label_name);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->op2->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 1", registers[tac->op1->assigned_register]);								
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 1", tac->op2->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
+							char* label_true = generate_jmp_label(ctx, TRUE);
+							assert(label_true);
 
-							snprintf(buffer, sizeof(buffer), "\tje %s", jmp_op->value.label_name);
-							write_asm_to_file(writer, buffer);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op1), asm_immediate(1));
+							emit_asm_jump(writer, X86_JE, label_true);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op2), asm_immediate(1));
+							emit_asm_jump(writer, X86_JNE, jmp_op->value.label_name);
+							emit_asm_label(writer, label_true);
 						} else {
 							char* label_true = generate_jmp_label(ctx, TRUE);
 							char* label_false = generate_jmp_label(ctx, FALSE);
 							char* label_end = generate_jmp_label(ctx, END);
 							assert(label_true && label_false && label_end);
 
-							if (tac->op1->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 1", registers[tac->op1->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 1", tac->op1->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", label_true);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->op2->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 1", registers[tac->op2->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 1", tac->op2->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", label_true);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_false);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 0", registers[tac->result->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 0", tac->result->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tjmp %s", label_end);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_true);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 1", registers[tac->result->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu]", tac->result->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_end);
-							write_asm_to_file(writer, buffer);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op1), asm_immediate(1));
+							emit_asm_jump(writer, X86_JE, label_true);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op2), asm_immediate(1));
+							emit_asm_jump(writer, X86_JE, label_true);
+							emit_asm_label(writer, label_false);
+							emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(0));
+							emit_asm_jump(writer, X86_JMP, label_end);
+							emit_asm_label(writer, label_true);
+							emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(1));
+							emit_asm_label(writer, label_end);
 						}
 					} 
 					break;
@@ -639,263 +656,53 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 								next_tac->handled = true;
 								break;
 							}
+
+							case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 						}
 
 						if (jmp_op) {
-							if (tac->op1->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 0", registers[tac->op1->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp -  %zu], 0", tac->op1->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", jmp_op->value.label_name);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->op2->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 0", registers[tac->op2->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 0", tac->op2->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", jmp_op->value.label_name);
-							write_asm_to_file(writer, buffer);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op1), asm_immediate(0));
+							emit_asm_jump(writer, X86_JE, jmp_op->value.label_name);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op2), asm_immediate(0));
+							emit_asm_jump(writer, X86_JE, jmp_op->value.label_name);
 						} else {
 							char* label_false = generate_jmp_label(ctx, FALSE);
 							char* label_true = generate_jmp_label(ctx, TRUE);
 							char* label_end = generate_jmp_label(ctx, END);
 							assert(label_false && label_true && label_end);
 
-							if (tac->op1->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 0", registers[tac->op1->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 0", tac->op1->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", label_false);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->op2->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tcmp %s, 0", registers[tac->op2->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tcmp [rbp - %zu], 0", tac->op2->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tje %s", label_false);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_true);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 1", registers[tac->result->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 1", tac->result->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "\tjmp %s", label_end);
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_false);
-							write_asm_to_file(writer, buffer);
-
-							if (tac->result->assigned_register != -1) {
-								snprintf(buffer, sizeof(buffer), "\tmov %s, 0", registers[tac->result->assigned_register]);
-							} else {
-								snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], 0", tac->result->frame_byte_offset);
-							}
-							write_asm_to_file(writer, buffer);
-
-							snprintf(buffer, sizeof(buffer), "%s:", label_end);
-							write_asm_to_file(writer, buffer);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op1), asm_immediate(0));
+							emit_asm_jump(writer, X86_JE, label_false);
+							emit_instruction(writer, X86_CMP, operand_location(tac->op2), asm_immediate(0));
+							emit_asm_jump(writer, X86_JE, label_false);
+							emit_asm_label(writer, label_true);
+							emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(1));
+							emit_asm_jump(writer, X86_JMP, label_end);
+							emit_asm_label(writer, label_false);
+							emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_immediate(0));
+							emit_asm_label(writer, label_end);
 						}
 					} 
 					break;
 				}
 
 				case TAC_ADD:
-				case TAC_SUB: {					
-					if (tac->op1->permanent_frame_position) {
-						assert(tac->op1->temp_register != -1);
-						if (tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\t%s %s, [rbp - %zu]",
-								operator_to_string(tac->kind),
-								registers[tac->op1->temp_register],
-								tac->op2->frame_byte_offset
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\t%s %s, %s",
-								operator_to_string(tac->kind),
-								registers[tac->op1->temp_register],
-								registers[tac->op2->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					} else {
-						if (tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\t%s %s, [rbp - %zu]",
-								operator_to_string(tac->kind),
-								registers[tac->op1->assigned_register],
-								tac->op2->frame_byte_offset
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\t%s %s, %s",
-								operator_to_string(tac->kind),
-								registers[tac->op1->assigned_register],
-								registers[tac->op2->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					}
-					
-					if (tac->result->permanent_frame_position) {
-						if (tac->op1->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op1->temp_register]
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op1->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					} else {
-						if (tac->op1->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-								registers[tac->result->assigned_register],
-								registers[tac->op1->temp_register]
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-								registers[tac->result->assigned_register],
-								registers[tac->op1->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					}
-					break;
-				}
-
+				case TAC_SUB:
 				case TAC_MUL: {
-					if (tac->op1->permanent_frame_position) {
-						assert(tac->op1->temp_register != -1);
-						if (tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\timul %s, [rbp - %zu]", 
-								registers[tac->op1->temp_register], 
-								tac->op2->frame_byte_offset
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\timul %s, %s",
-								registers[tac->op1->temp_register],
-								registers[tac->op2->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					} else {
-						if (tac->op2->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\timul %s, [rbp - %zu]",
-								registers[tac->op1->assigned_register],
-								tac->op2->frame_byte_offset
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\timul %s, %s",
-								registers[tac->op1->assigned_register],
-								registers[tac->op2->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					}
-										
-					if (tac->result->permanent_frame_position) {	
-						if (tac->op1->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op1->temp_register]
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], %s",
-								tac->result->frame_byte_offset,
-								registers[tac->op1->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					} else {
-						if (tac->op1->permanent_frame_position) {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-								registers[tac->result->assigned_register],
-								registers[tac->op1->temp_register]
-							);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-								registers[tac->result->assigned_register],
-								registers[tac->op1->assigned_register]
-							);
-						}
-						write_asm_to_file(writer, buffer);
-					}
+					emit_binary_operation(writer, cfg, block, j);
 					break;
 				}
 
-				case TAC_MODULO: {
-					if (tac->op1->permanent_frame_position) {
-						snprintf(buffer, sizeof(buffer), "\tmov rax, [rbp - %zu]", tac->op1->frame_byte_offset);
-					} else if (tac->op1->assigned_register != -1) {
-						snprintf(buffer, sizeof(buffer), "\tmov rax, %s", registers[tac->op1->assigned_register]);
-					}
-					write_asm_to_file(writer, buffer);
+				// div leaves the quotient in rax and the remainder in rdx
+				case TAC_MODULO:
+				case TAC_DIV: {
+					emit_instruction(writer, X86_MOV, asm_register(0), operand_location(tac->op1));
+					emit_reg_reg(writer, X86_XOR, 4, 4);
+					emit_instruction(writer, X86_DIV, operand_location(tac->op2), asm_none());
 					
-					snprintf(buffer, sizeof(buffer), "\txor rdx, rdx");
-					write_asm_to_file(writer, buffer);
-
-					if (tac->op2->assigned_register != -1) {
-						snprintf(buffer, sizeof(buffer), "\tdiv %s", registers[tac->op2->assigned_register]);
-					} else {
-						snprintf(buffer, sizeof(buffer), "\tdiv [rbp - %zu]", tac->op2->frame_byte_offset);
-					}
-					write_asm_to_file(writer, buffer);
-
 					if (tac->result) {
-						if (tac->result->assigned_register != -1) {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, rdx", registers[tac->result->assigned_register]);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], rdx", tac->result->frame_byte_offset);
-						}
-						write_asm_to_file(writer, buffer);
-					}
-					break;
-				}
-
-				case TAC_DIV: {
-					if (tac->op1->permanent_frame_position) {
-						snprintf(buffer, sizeof(buffer), "\tmov rax, [rbp - %zu]", tac->op1->frame_byte_offset);
-					} else if (tac->op1->assigned_register != -1) {
-						snprintf(buffer, sizeof(buffer), "\tmov rax, %s", registers[tac->op1->assigned_register]);
-					}
-					write_asm_to_file(writer, buffer);
-
-					snprintf(buffer, sizeof(buffer), "\txor rdx, rdx");
-					write_asm_to_file(writer, buffer);
-
-					if (tac->op2->assigned_register != -1) {
-						snprintf(buffer, sizeof(buffer), "\tdiv %s", registers[tac->op2->assigned_register]);
-					} else {
-						snprintf(buffer, sizeof(buffer), "\tdiv [rbp - %zu]", tac->op2->frame_byte_offset);
-					}
-					write_asm_to_file(writer, buffer);
-					
-					if (tac->result) {
-						if (tac->result->assigned_register != -1) {
-							snprintf(buffer, sizeof(buffer), "\tmov %s, rax", registers[tac->result->assigned_register]);
-						} else {
-							snprintf(buffer, sizeof(buffer), "\tmov [rbp - %zu], rax", tac->result->frame_byte_offset);
-						}
-						write_asm_to_file(writer, buffer);
+						int reg = tac->kind == TAC_MODULO ? 4 : 0;
+						emit_instruction(writer, X86_MOV, operand_location(tac->result), asm_register(reg));
 					}
 					break;
 				}
@@ -910,20 +717,22 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 					bool args_on_stack = false;
 
 					if (corresponding_list) {
+						int saved = caller_saved_live_across(tac);
+						for (int reg = 0; reg < NUM_REGISTERS; reg++) {
+							if (saved & (1 << reg)) emit_reg(writer, X86_PUSH, reg);
+						}
+
 						for (int i = 0; i < corresponding_list->size; i++) {
 							ArgumentInfo* arg = corresponding_list->args[i];						
 							TACInstruction* arg_instr = arg->tac;	
 							if (arg->loc == REG) {
-								if (arg_instr->op1->assigned_register != -1) {
-									snprintf(buffer, sizeof(buffer), "\tmov %s, %s",
-										registers[arg_instr->result->assigned_register],
-										registers[arg_instr->op1->assigned_register]);								
+								if (arg_instr->op1->assigned_register == arg_instr->result->assigned_register) {
+									continue;
+								} else if (arg_instr->op1->assigned_register != -1) {
+									emit_reg_reg(writer, X86_MOV, arg_instr->result->assigned_register, arg_instr->op1->assigned_register);
 								} else {
-									snprintf(buffer, sizeof(buffer), "\tmov %s, [rbp - %zu]",
-										registers[arg_instr->result->assigned_register],
-										arg_instr->op1->frame_byte_offset);
+									emit_reg_frame(writer, X86_MOV, arg_instr->result->assigned_register, arg_instr->op1->frame_byte_offset);
 								}
-								write_asm_to_file(writer, buffer);
 							} else {
 								// args_on_stack = true;
 								// int stack_args_count = 0;
@@ -946,19 +755,27 @@ void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInf
 							}
 						}
 
-						snprintf(buffer, sizeof(buffer), "\tcall %s", tac->result->value.sym->name);
-						write_asm_to_file(writer, buffer);
+						emit_asm_jump(writer, X86_CALL, tac->result->value.sym->name);
 
 						if (args_on_stack) {
-							snprintf(buffer, sizeof(buffer), "\tadd rsp, %d", arg_space);
-							write_asm_to_file(writer, buffer);
+							emit_reg_immediate(writer, X86_ADD, REG_RSP, arg_space);
+						}
+
+						for (int reg = NUM_REGISTERS - 1; reg >= 0; reg--) {
+							if (saved & (1 << reg)) emit_reg(writer, X86_POP, reg);
 						}
 						write_asm_to_file(writer, "");
 					}
 					break;
 				}
+
+				case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 			}		
 		}
+
+		// a block that falls through after an instruction that saved a
+		// register restores it on the way out
+		emit_reloads(writer, gather_matching_reloads(ctx, block->reload_schedule, block->num_instructions));
 	}
 }
 
@@ -1139,6 +956,8 @@ void schedule_callee_register_spills(CompilerContext* ctx, FunctionList* functio
 								schedule_callee_reloads(ctx, cfg->all_blocks[0]->spill_schedule, block->reload_bundle);
 								break;
 							}
+
+							case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 						}
 					}
 				}
@@ -1148,37 +967,35 @@ void schedule_callee_register_spills(CompilerContext* ctx, FunctionList* functio
 }
 
 void generate_function_prologue(CompilerContext* ctx, ASMWriter* writer, FunctionInfo* info) {
-	write_asm_to_file(writer, "\tpush rbp");
-	write_asm_to_file(writer, "\tmov rbp, rsp");
+	emit_reg(writer, X86_PUSH, REG_RBP);
+	emit_reg_reg(writer, X86_MOV, REG_RBP, REG_RSP);
 
-	char buffer[40];
 	if (info->total_frame_bytes > 0) {
-		snprintf(buffer, sizeof(buffer), "\tsub rsp, %d\n", info->total_frame_bytes);
-		write_asm_to_file(writer, buffer);
+		emit_reg_immediate(writer, X86_SUB, REG_RSP, info->total_frame_bytes);
+		write_asm_to_file(writer, "");
 	}
-}
-
-char* create_function_label(CompilerContext* ctx, char* func_name) {
-	if (!func_name) return NULL;
 
-	int res_length = strlen(func_name) + 2;
-	char* func_label = arena_allocate(ctx->codegen_arena, res_length);
-	if (!func_label) return NULL;
-
-	strncpy(func_label, func_name, res_length - 2);
-	func_label[res_length - 2] = '\0';
-
-	strcat(func_label, ":");
-	return func_label;
-} 
+	// the callee saved pushes belong to the first block's first instruction;
+	// emitted here they run once even when that block is a loop header or
+	// has no instructions left
+	SpillBundle* pushes = gather_matching_spills(ctx, info->cfg->all_blocks[0]->spill_schedule, 0);
+	if (pushes && pushes->size > 0) {
+		emit_spills(writer, pushes);
+	}
+}
 
 void emit_asm_for_functions(CompilerContext* ctx, ASMWriter* writer, FunctionList* function_list) {
 	for (int i = 0; i < function_list->size; i++) {
 		FunctionInfo* info = function_list->infos[i];
 
+		// jump labels are numbered per function, like the .L labels from tac
+		ctx->function->name = info->symbol->name;
+		ctx->function->jmp_true_index = 1;
+		ctx->function->jmp_false_index = 1;
+		ctx->function->jmp_end_index = 1;
+
 		if (info->symbol) {
-			char* func_label = create_function_label(ctx, info->symbol->name);
-			write_asm_to_file(writer, func_label);
+			emit_asm_label(writer, info->symbol->name);
 		}
 		collect_args(ctx, info);
 		generate_function_prologue(ctx, writer, info);
@@ -1208,6 +1025,8 @@ int find_corrupting_instr_index(BasicBlock* block, op_check_t type, Operand* op,
 				}
 				break;
 			}
+
+			case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 		}
 	}
 }
@@ -1417,12 +1236,17 @@ char* get_full_text(CompilerContext* ctx, char* func_name) {
 
 void generate_globals(CompilerContext* ctx, ASMWriter* writer) {
 	write_asm_to_file(writer, "format ELF64 executable\n");
-	write_asm_to_file(writer, "entry _start\n_start:");
-
-	char buffer[256];
-
-	snprintf(buffer, sizeof(buffer), "\tsub rsp, 8\n\tcall main\n\tadd rsp, 8\n\tmov rdi, rax\n\tmov rax, 60\n\tsyscall\n");
-	write_asm_to_file(writer, buffer);
+	write_asm_to_file(writer, "entry _start");
+
+	// _start calls main and exits with its return value
+	emit_asm_label(writer, "_start");
+	emit_reg_immediate(writer, X86_SUB, REG_RSP, 8);
+	emit_asm_jump(writer, X86_CALL, "main");
+	emit_reg_immediate(writer, X86_ADD, REG_RSP, 8);
+	emit_reg_reg(writer, X86_MOV, 2, 0);
+	emit_reg_immediate(writer, X86_MOV, 0, 60);
+	emit_instruction(writer, X86_SYSCALL, asm_none(), asm_none());
+	write_asm_to_file(writer, "");
 }
 
 void ensure_alignment(int* op_size, int alignment) {
@@ -1451,7 +1275,7 @@ size_t get_size(Operand* op) {
 		case TYPE_BOOL:
 		case TYPE_CHAR: return sizeof(char);
 		default: {
-			if (op->value.sym && op->value.sym->type) {				
+			if (op->kind == OP_SYMBOL && op->value.sym && op->value.sym->type) {				
 				if (op->value.sym->type->subtype) {
 					switch (op->value.sym->type->subtype->kind) {
 						case TYPE_INTEGER: return sizeof(int);
@@ -1463,6 +1287,9 @@ size_t get_size(Operand* op) {
 			break;
 		}
 	}
+
+	// temps carry a label, not a symbol; without a type they get a whole slot
+	return EIGHT_BYTE_ALIGNMENT;
 }
 
 void get_bytes_from_operand(CompilerContext* ctx, OperandSet* symbols_set, Operand* op, int* total_frame_bytes) {
@@ -1518,7 +1345,8 @@ int determine_operand_use(BasicBlock* block, Operand* op, int start) {
 			case TAC_ADD:
 			case TAC_SUB:
 			case TAC_MUL:
-			case TAC_DIV: {
+			case TAC_DIV:
+			case TAC_MODULO: {
 				bool op1_equivalent = operands_equal(tac->op1, op);
 				bool op2_equivalent = operands_equal(tac->op2, op);
 				if (op1_equivalent || op2_equivalent) {
@@ -1527,6 +1355,15 @@ int determine_operand_use(BasicBlock* block, Operand* op, int start) {
 				break;
 			}
 
+			case TAC_UNARY_SUB:
+			case TAC_ARG:
+			case TAC_IF_FALSE: {
+				if (operands_equal(tac->op1, op)) {
+					return i;
+				}
+				break;
+			}
+
 			case TAC_ASSIGNMENT: {
 				if (tac->op2->kind != OP_RETURN) {
 					bool op2_equivalent = operands_equal(tac->op2, op);
@@ -1546,6 +1383,8 @@ int determine_operand_use(BasicBlock* block, Operand* op, int start) {
 				}
 				break;
 			}
+
+			case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 		}
 	}
 	return -1;
@@ -1567,7 +1406,8 @@ int determine_operand_use_within_call_boundary(BasicBlock* block, Operand* op, i
 			case TAC_ADD:
 			case TAC_SUB:
 			case TAC_MUL:
-			case TAC_DIV: {
+			case TAC_DIV:
+			case TAC_MODULO: {
 				bool op1_equivalent = operands_equal(tac->op1, op);
 				bool op2_equivalent = operands_equal(tac->op2, op);
 				if (op1_equivalent || op2_equivalent) {
@@ -1576,6 +1416,15 @@ int determine_operand_use_within_call_boundary(BasicBlock* block, Operand* op, i
 				break;
 			}
 
+			case TAC_UNARY_SUB:
+			case TAC_ARG:
+			case TAC_IF_FALSE: {
+				if (operands_equal(tac->op1, op)) {
+					return i;
+				}
+				break;
+			}
+
 			case TAC_ASSIGNMENT: {
 				if (tac->op2->kind != OP_RETURN) {
 					bool op2_equivalent = operands_equal(tac->op2, op);
@@ -1585,6 +1434,8 @@ int determine_operand_use_within_call_boundary(BasicBlock* block, Operand* op, i
 				}
 				break;
 			}
+
+			case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 		}   		
 	}
 	return -1;
@@ -1625,6 +1476,28 @@ Operand* operand_with_furthest_use(OperandSet* op_set) {
 	return furthest_op;
 }
 
+// the set holds what is live going into the instruction, its own operands
+// included, so a scratch register has to stay clear of the ones it reads
+// and writes. it is saved around the instruction, so when nothing else
+// live has a register any other one will do
+int scratch_register(OperandSet* op_set, int read, int written) {
+	Operand* furthest_op = NULL;
+	for (int i = 0; i < op_set->size; i++) {
+		Operand* current_op = op_set->elements[i];
+		int reg = current_op->assigned_register;
+		if (reg == -1 || reg == read || reg == written) continue;
+
+		if (!furthest_op || current_op->next_use > furthest_op->next_use) {
+			furthest_op = current_op;
+		}
+	}
+	if (furthest_op) return furthest_op->assigned_register;
+
+	int reg = 0;
+	while (reg == read || reg == written) reg++;
+	return reg;
+}
+
 Operand* find_non_restricted_operand(OperandSet* op_set, Operand* arg_op) {
 	// printf("Address of arg op is %p\n", (void*)arg_op);	
 	// for (int k = 0; k < arg_op->restricted_regs_count; k++) {
@@ -1744,101 +1617,40 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 
 						bool both_in_frame = tac->result->permanent_frame_position && tac->op2->permanent_frame_position;
 						if (both_in_frame) {
-							Operand* furthest_op = operand_with_furthest_use(tac->live_out);
-							if (furthest_op) {
-								Spill s1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.push_index = k,
-									.block_index = j,
-									.direction = PUSH_TO_STACK
-								};
-								add_spill(ctx, block->spill_schedule, s1);
+							int scratch = scratch_register(tac->live_out, -1, -1);
 
-								Spill s2 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = tac->op2->frame_byte_offset,
-									.push_index = k,
-									.block_index = j,
-									.direction = FRAME_TO_REG
-								};
-								add_spill(ctx, block->spill_schedule, s2);
+							Spill s1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.push_index = k,
+								.block_index = j,
+								.direction = PUSH_TO_STACK
+							};
+							add_spill(ctx, block->spill_schedule, s1);
 
-								tac->op2->temp_register = furthest_op->assigned_register; 
+							Spill s2 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = tac->op2->frame_byte_offset,
+								.push_index = k,
+								.block_index = j,
+								.direction = FRAME_TO_REG
+							};
+							add_spill(ctx, block->spill_schedule, s2);
 
-								Reload r1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.pop_index = k + 1,
-									.block_index = j,
-									.direction = POP_FROM_STACK
-								};
-								add_reload(ctx, block->reload_schedule, r1);
-							}
+							tac->op2->temp_register = scratch;
+
+							Reload r1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.pop_index = k + 1,
+								.block_index = j,
+								.direction = POP_FROM_STACK
+							};
+							add_reload(ctx, block->reload_schedule, r1);
 							break;	
 						}
 
-						int call_index = find_call_instr_index(block, k + 1);
-						
-						if (call_index > 0) {
-							int next_use_index = determine_operand_use_within_call_boundary(block, tac->result, k + 1, call_index);
-							
-							if (next_use_index == -1) {
-								bool caller_saved = is_caller_saved(tac->result->assigned_register);
-								bool still_live = contains_operand(block->instructions[call_index]->live_out, tac->result);
-								
-								if (caller_saved && still_live) {									
-									Spill s = {
-										.assigned_register = tac->result->assigned_register,
-										.frame_byte_offset = -1,
-										.push_index = k + 1,
-										.block_index = j,
-										.direction = PUSH_TO_STACK
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									// unloading from frame
-									int first_use_after_call = determine_operand_use(block, tac->result, call_index + 1);
-									assert(first_use_after_call != -1);
-
-									Reload r = {
-										.assigned_register = tac->result->assigned_register,
-										.frame_byte_offset = -1,
-										.pop_index = first_use_after_call,
-										.block_index = j,
-										.direction = POP_FROM_STACK
-									};
-									add_reload(ctx, block->reload_schedule, r);
-								}
-
-								bool op2_caller_saved = is_caller_saved(tac->op2->assigned_register);
-								bool op2_still_live = contains_operand(block->instructions[call_index]->live_out, tac->result);
-								
-								if (op2_caller_saved && op2_still_live) {
-									Spill s = {
-										.assigned_register = tac->op2->assigned_register,
-										.frame_byte_offset = -1,
-										.push_index = k + 1,
-										.block_index = j,
-										.direction = PUSH_TO_STACK
-									};
-									add_spill(ctx, block->spill_schedule, s);
-									
-									int first_use_after_call = determine_operand_use(block, tac->op2, call_index + 1);
-									assert(first_use_after_call != -1);
-
-									Reload r = {
-										.assigned_register = tac->op2->assigned_register,
-										.frame_byte_offset = -1,
-										.pop_index = first_use_after_call,
-										.block_index = j,
-										.direction = POP_FROM_STACK
-									};
-									add_reload(ctx, block->reload_schedule, r);
-									
-								}
-							}
-						}
+						// values live across a later call are saved around the call itself
 						break;
 					}
 
@@ -1847,59 +1659,38 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 							get_bytes_from_operand(ctx, symbols_set, tac->result, &info->total_frame_bytes);
 						}
 
-						if (tac->op1->permanent_frame_position) {
-							Operand* furthest_op = operand_with_furthest_use(tac->live_out);
-							if (furthest_op) {
-								Spill s1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.push_index = k,
-									.block_index = j,
-									.direction = PUSH_TO_STACK
-								};
-								add_spill(ctx, block->spill_schedule, s1);
+						bool both_in_frame = tac->result->permanent_frame_position && tac->op1->permanent_frame_position;
+						if (both_in_frame) {
+							int scratch = scratch_register(tac->live_out, -1, -1);
 
-								Spill s2 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = tac->op2->frame_byte_offset,
-									.push_index = k,
-									.block_index = j,
-									.direction = FRAME_TO_REG
-								};
-								add_spill(ctx, block->spill_schedule, s2);
+							Spill s1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.push_index = k,
+								.block_index = j,
+								.direction = PUSH_TO_STACK
+							};
+							add_spill(ctx, block->spill_schedule, s1);
 
-								tac->op1->temp_register = furthest_op->assigned_register; 
+							Spill s2 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = tac->op1->frame_byte_offset,
+								.push_index = k,
+								.block_index = j,
+								.direction = FRAME_TO_REG
+							};
+							add_spill(ctx, block->spill_schedule, s2);
 
-								Reload r1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.pop_index = k + 1,
-									.block_index = j,
-									.direction = POP_FROM_STACK
-								};
-								add_reload(ctx, block->reload_schedule, r1);
-							}
-						} else {
-							int next_use_index = determine_operand_use(block, tac->op1, k + 1); 
-							if (next_use_index != -1) {
-								Spill s = {
-									.assigned_register = tac->op1->assigned_register,
-									.frame_byte_offset = -1,
-									.push_index = k,
-									.block_index = j,
-									.direction = PUSH_TO_STACK
-								};
-								add_spill(ctx, block->spill_schedule, s);
+							tac->op1->temp_register = scratch;
 
-								Reload r = {
-									.assigned_register = tac->op1->assigned_register,
-									.frame_byte_offset = -1,
-									.pop_index = next_use_index,
-									.block_index = j,
-									.direction = POP_FROM_STACK
-								};
-								add_reload(ctx, block->reload_schedule, r);
-							}
+							Reload r1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.pop_index = k + 1,
+								.block_index = j,
+								.direction = POP_FROM_STACK
+							};
+							add_reload(ctx, block->reload_schedule, r1);
 						}
 						break;
 					}
@@ -1912,144 +1703,42 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 						}
 
 						if (tac->op1->permanent_frame_position) {	
-							Operand* furthest_op = operand_with_furthest_use(tac->live_out);
-							if (furthest_op) {
-								Spill s1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.push_index = k,
-									.block_index = j,
-									.direction = PUSH_TO_STACK
-								};
-								add_spill(ctx, block->spill_schedule, s1);
+							int op2_register = tac->op2->permanent_frame_position ? -1 : tac->op2->assigned_register;
+							int result_register = tac->result->permanent_frame_position ? -1 : tac->result->assigned_register;
+							int scratch = scratch_register(tac->live_out, op2_register, result_register);
 
-								Spill s2 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = tac->op1->frame_byte_offset,
-									.push_index = k,
-									.block_index = j,
-									.direction = FRAME_TO_REG
-								};
-								add_spill(ctx, block->spill_schedule, s2);
+							Spill s1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.push_index = k,
+								.block_index = j,
+								.direction = PUSH_TO_STACK
+							};
+							add_spill(ctx, block->spill_schedule, s1);
 
-								tac->op1->temp_register = furthest_op->assigned_register;
+							Spill s2 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = tac->op1->frame_byte_offset,
+								.push_index = k,
+								.block_index = j,
+								.direction = FRAME_TO_REG
+							};
+							add_spill(ctx, block->spill_schedule, s2);
 
-								Reload r1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.pop_index = k + 1,
-									.block_index = j,
-									.direction = POP_FROM_STACK
-								};
-								add_reload(ctx, block->reload_schedule, r1);
-							}
+							tac->op1->temp_register = scratch;
+
+							Reload r1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.pop_index = k + 1,
+								.block_index = j,
+								.direction = POP_FROM_STACK
+							};
+							add_reload(ctx, block->reload_schedule, r1);
 							break;
 						}
 
-						int call_index = find_call_instr_index(block, k + 1);
-						if (call_index > 0) {
-							int next_use_index = determine_operand_use_within_call_boundary(block, tac->op1, k + 1, call_index);  							
-							if (next_use_index != -1) {			
-								if (!tac->op1->permanent_frame_position) {
-									get_bytes_from_operand(ctx, symbols_set, tac->op1, &info->total_frame_bytes);
-
-									Spill s = {
-										.assigned_register = tac->op1->assigned_register,
-										.frame_byte_offset = tac->op1->frame_byte_offset,
-										.push_index = k,
-										.block_index = j,
-										.direction = REG_TO_FRAME
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									Reload next_use = {
-										.assigned_register = tac->op1->assigned_register,
-										.frame_byte_offset = tac->op1->frame_byte_offset,
-										.pop_index = next_use_index,
-										.block_index = j,
-										.direction = FRAME_TO_REG
-									};
-									add_reload(ctx, block->reload_schedule, next_use);	
-								}
-							} else {
-								bool caller_saved = is_caller_saved(tac->op1->assigned_register);
-								bool still_live = contains_operand(block->instructions[call_index]->live_out, tac->op1);
-								
-								if (caller_saved && still_live) {
-									Spill s = {
-										.assigned_register = tac->op1->assigned_register,
-										.frame_byte_offset = -1,
-										.push_index = k,
-										.block_index = j,
-										.direction = PUSH_TO_STACK
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									int next_use_for_op1 = determine_operand_use(block, tac->op1, call_index + 1);
-									if (next_use_for_op1 != -1) {
-										Reload r = {
-											.assigned_register = tac->op1->assigned_register,
-											.frame_byte_offset = -1,
-											.pop_index = next_use_for_op1,
-											.block_index = j,
-											.direction = POP_FROM_STACK
-										};
-										add_reload(ctx, block->reload_schedule, r);
-									}
-								}
-
-								bool op2_still_live = contains_operand(block->instructions[call_index]->live_out, tac->op2);
-								bool assigned_caller_saved_reg = is_caller_saved(tac->op2->assigned_register);
-
-								if (op2_still_live && assigned_caller_saved_reg) {
-									Spill s = {
-										.assigned_register = tac->op2->assigned_register,
-										.frame_byte_offset = -1,
-										.push_index = k,
-										.block_index = j,
-										.direction = PUSH_TO_STACK
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									int next_use_of_op2 = determine_operand_use(block, tac->op2, call_index + 1);
-									assert(next_use_of_op2 != -1);
-
-									Reload r = {
-										.assigned_register = tac->op2->assigned_register,
-										.frame_byte_offset = -1,
-										.pop_index = next_use_of_op2,
-										.block_index = j,
-										.direction = POP_FROM_STACK
-									};
-									add_reload(ctx, block->reload_schedule, r);									
-								}
-							}
-						} else if (call_index == -1) {
-							int next_use_index = determine_operand_use(block, tac->op1, k + 1);
-							if (next_use_index != -1) {
-								if (!tac->op1->permanent_frame_position) {
-									get_bytes_from_operand(ctx, symbols_set, tac->op1, &info->total_frame_bytes);
-									
-									Spill s = {
-										.assigned_register = tac->op1->assigned_register,
-										.frame_byte_offset = tac->op1->frame_byte_offset,
-										.push_index = k,
-										.block_index = j,
-										.direction = FRAME_TO_REG
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									Reload r = {
-										.assigned_register = tac->op1->assigned_register,
-										.frame_byte_offset = tac->op1->frame_byte_offset,
-										.pop_index = next_use_index,
-										.block_index = j,
-										.direction = REG_TO_FRAME
-									};
-									add_reload(ctx, block->reload_schedule, r);
-								}					
-							}
-						}
+						// op1 keeps its value when it is still live, see emit_binary_operation
 						break;
 					}
 
@@ -2132,56 +1821,6 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 									.direction = FRAME_TO_REG
 								};
 								add_reload(ctx, block->reload_schedule, r);
-							} else {
-								bool op1_still_live = contains_operand(block->instructions[call_index]->live_out, tac->op1);
-								if (op1_still_live) {
-									Spill s = {
-										.assigned_register = tac->op1->assigned_register,
-										.frame_byte_offset = -1,
-										.push_index = k,
-										.block_index = j,
-										.direction = PUSH_TO_STACK
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									int next_use_index = determine_operand_use(block, tac->op1, call_index + 1);
-									if (next_use_index != -1) {
-										Reload r = {
-											.assigned_register = tac->op1->assigned_register,
-											.frame_byte_offset = -1,
-											.pop_index = next_use_index,
-											.block_index = j,
-											.direction = POP_FROM_STACK
-										};
-										add_reload(ctx, block->reload_schedule, r);
-									}
-								}
-
-								bool op2_still_live = contains_operand(block->instructions[call_index]->live_out, tac->op2);
-								bool assigned_caller_saved_reg = is_caller_saved(tac->op2->assigned_register);
-
-								if (op2_still_live && assigned_caller_saved_reg) {
-									Spill s = {
-										.assigned_register = tac->op2->assigned_register,
-										.frame_byte_offset = -1,
-										.push_index = k,
-										.block_index = j,
-										.direction = PUSH_TO_STACK
-									};
-									add_spill(ctx, block->spill_schedule, s);
-
-									int next_use_index = determine_operand_use(block, tac->op2, call_index + 1);
-									if (next_use_index != -1) {
-										Reload r = {
-											.assigned_register = tac->op2->assigned_register,
-											.frame_byte_offset = -1,
-											.pop_index = next_use_index,
-											.block_index = j,
-											.direction = POP_FROM_STACK
-										};
-										add_reload(ctx, block->reload_schedule, r);
-									}
-								}
 							}
 						} else if (call_index == -1) {
 							int next_use_index = determine_operand_use(block, tac->op1, k + 1);
@@ -2219,37 +1858,36 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 
 						bool both_in_frame = tac->result->permanent_frame_position && tac->op1->permanent_frame_position;
 						if (both_in_frame) {
-							Operand* furthest_op = operand_with_furthest_use(tac->live_out);
-							if (furthest_op) {
-								Spill s1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.push_index = k,
-									.block_index = j,
-									.direction = PUSH_TO_STACK
-								};
-								add_spill(ctx, block->spill_schedule, s1);
+							int scratch = scratch_register(tac->live_out, -1, -1);
 
-								Spill s2 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = tac->op1->frame_byte_offset,
-									.push_index = k,
-									.block_index = j,
-									.direction = FRAME_TO_REG
-								};
-								add_spill(ctx, block->spill_schedule, s2);
+							Spill s1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.push_index = k,
+								.block_index = j,
+								.direction = PUSH_TO_STACK
+							};
+							add_spill(ctx, block->spill_schedule, s1);
+
+							Spill s2 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = tac->op1->frame_byte_offset,
+								.push_index = k,
+								.block_index = j,
+								.direction = FRAME_TO_REG
+							};
+							add_spill(ctx, block->spill_schedule, s2);
 
-								tac->op1->temp_register = furthest_op->assigned_register; 
+							tac->op1->temp_register = scratch;
 
-								Reload r1 = {
-									.assigned_register = furthest_op->assigned_register,
-									.frame_byte_offset = -1,
-									.pop_index = k + 1,
-									.block_index = j,
-									.direction = POP_FROM_STACK
-								};
-								add_reload(ctx, block->reload_schedule, r1);
-							}
+							Reload r1 = {
+								.assigned_register = scratch,
+								.frame_byte_offset = -1,
+								.pop_index = k + 1,
+								.block_index = j,
+								.direction = POP_FROM_STACK
+							};
+							add_reload(ctx, block->reload_schedule, r1);
 						}
 						break;
 					}
@@ -2264,11 +1902,14 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 							get_bytes_from_operand(ctx, symbols_set, tac->result, &info->total_frame_bytes);
 						}
 
+						// the result is set before the scratch register comes back
 						bool both_in_frame = tac->op1->permanent_frame_position && tac->op2->permanent_frame_position;
 						if (both_in_frame) {
-							Operand* furthest_op = operand_with_furthest_use(tac->live_out);
+							int result_register = tac->result->permanent_frame_position ? -1 : tac->result->assigned_register;
+							int scratch = scratch_register(tac->live_out, -1, result_register);
+
 							Spill s1 = {
-								.assigned_register = furthest_op->assigned_register,
+								.assigned_register = scratch,
 								.frame_byte_offset = -1,
 								.push_index = k,
 								.block_index = j,
@@ -2277,7 +1918,7 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 							add_spill(ctx, block->spill_schedule, s1);
 
 							Spill s2 = {
-								.assigned_register = furthest_op->assigned_register,
+								.assigned_register = scratch,
 								.frame_byte_offset = tac->op2->frame_byte_offset,
 								.push_index = k,
 								.block_index = j,
@@ -2285,10 +1926,10 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 							};
 							add_spill(ctx, block->spill_schedule, s2);
 
-							tac->op2->temp_register = furthest_op->assigned_register;
+							tac->op2->temp_register = scratch;
 
 							Reload r1 = {
-								.assigned_register = furthest_op->assigned_register,
+								.assigned_register = scratch,
 								.frame_byte_offset = -1,
 								.pop_index = k + 1,
 								.block_index = j,
@@ -2311,6 +1952,8 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 						get_bytes_from_operand(ctx, symbols_set, tac->result, &info->total_frame_bytes);
 						break;
 					}
+
+					case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 				}
 			}
 		}
@@ -2318,23 +1961,28 @@ void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_lis
 	}
 }
 
-char* get_filename(CompilerContext* ctx, char* file) {
-	char* output = NULL;
-
-	size_t filename_length = strlen(file);
-	for (size_t i = 0; i < filename_length; i++) {
-		if (file[i] == '.') {
-			int length = &file[i] - file;
-			output = arena_allocate(ctx->lexer_arena, length + 5);
-			if (!output) {
-				perror("Unable to allocate space for output string.\n");
-				return NULL;
-			}
-			strncpy(output, file, length);
-			output[length] = '\0';
-			strcat(output, ".asm");
-		}
+// the source path up to its extension, with room for a new one
+char* strip_extension(CompilerContext* ctx, char* file, int extra) {
+	char* dot = strrchr(file, '.');
+	char* slash = strrchr(file, '/');
+	if (!dot || (slash && dot < slash)) return NULL;
+
+	int length = dot - file;
+	char* output = arena_allocate(ctx->lexer_arena, length + extra + 1);
+	if (!output) {
+		perror("Unable to allocate space for output string.\n");
+		return NULL;
 	}
+	strncpy(output, file, length);
+	output[length] = '\0';
+	return output;
+}
+
+char* get_filename(CompilerContext* ctx, char* file) {
+	char* output = strip_extension(ctx, file, 4);
+	if (!output) return NULL;
+
+	strcat(output, ".asm");
 	return output;
 }
 
@@ -2348,68 +1996,32 @@ ASMWriter* create_asm_writer(CompilerContext* ctx, char* file) {
 		return NULL;
 	}
 
+	writer->code = create_machine_code(ctx, INIT_CODE_CAPACITY);
+	if (!writer->code) return NULL;
+
+	writer->listing = ctx->asm_listing;
+	if (!writer->listing) return writer;
+
 	writer->file = fopen(writer->filename, "w");
 	if (!writer->file) return NULL;
 
+	writer->arena = ctx->codegen_arena;
+	writer->length = 0;
+	writer->capacity = INIT_ASM_BUFFER_CAPACITY;
+	writer->buffer = arena_allocate(writer->arena, writer->capacity);
+	if (!writer->buffer) return NULL;
+
 	return writer;
 } 
 
-void generate_executable(CompilerContext* ctx, char* asm_file) {
-	int nest_level = 0;
-	int length = strlen(asm_file);
-	for (int i = 0; i < length; i++) {
-		if (asm_file[i] == '/') {
-			nest_level++;
-		}
-	}
-
-	char* exe_path = NULL;
+// the executable sits next to the source, named after it without the extension
+void generate_executable(CompilerContext* ctx, ASMWriter* writer, char* file) {
+	char* exe_path = strip_extension(ctx, file, 0);
+	assert(exe_path);
 
-	if (nest_level > 0) {
-		int new_nest_count = 0;
-		for (int i = 0; i < length; i++) {
-			if (asm_file[i] == '/') {
-				if (new_nest_count < nest_level) {
-					new_nest_count++;
-				}
-			}
-
-			if (new_nest_count == nest_level) {
-				for (int j = i; j < length; j++) {
-					if (asm_file[j] == '.') {
-						int distance = &asm_file[j] - asm_file;
-						exe_path = arena_allocate(ctx->codegen_arena, distance + 1);
-						assert(exe_path);
-					
-						strncpy(exe_path, asm_file, distance);
-						exe_path[distance] = '\0';
-					}
-				}
-				break;
-			}
-		}
-	} else {
-		for (int i = 0; i < length; i++) {
-			if (asm_file[i] == '.') {
-				int distance = &asm_file[i] - asm_file;
-				exe_path = arena_allocate(ctx->codegen_arena, distance + 1);
-				assert(exe_path);
-
-				strncpy(exe_path, asm_file, distance);
-				exe_path[distance] = '\0';
-				break;
-			}
-		}
-	}
-
-	char exe_cmd[256];
-	snprintf(exe_cmd, sizeof(exe_cmd), "fasm %s", asm_file);
-	int fasm_res = system(exe_cmd);
-	if (fasm_res != 0) {
-		printf("fasm failed, no executable created\n");
+	if (!write_elf_executable(writer->code, exe_path, "_start")) {
+		printf("no executable created\n");
 	}
-	snprintf(exe_cmd, sizeof(exe_cmd), "chmod +x %s", exe_path);
-	system(exe_cmd);
 }
 
 void ensure_main_function_exists(CompilerContext* ctx) {
@@ -2437,7 +2049,45 @@ void ensure_main_function_exists(CompilerContext* ctx) {
 	return true;
 }
 
-void codegen(CompilerContext* ctx, FunctionList* function_list, char* file) {
+// a writer for a single function's code and listing, appended to the
+// program's writer once every function is done
+ASMWriter* create_function_writer(CompilerContext* ctx) {
+	ASMWriter* writer = arena_allocate(ctx->codegen_arena, sizeof(ASMWriter));
+	if (!writer) return NULL;
+
+	writer->code = create_machine_code(ctx, INIT_FUNCTION_CODE_CAPACITY);
+	if (!writer->code) return NULL;
+
+	writer->listing = ctx->asm_listing;
+	if (!writer->listing) return writer;
+
+	writer->arena = ctx->codegen_arena;
+	writer->length = 0;
+	writer->capacity = INIT_FUNCTION_ASM_CAPACITY;
+	writer->buffer = arena_allocate(writer->arena, writer->capacity);
+	if (!writer->buffer) return NULL;
+
+	return writer;
+}
+
+void append_asm_writer(ASMWriter* writer, ASMWriter* other) {
+	append_machine_code(writer->code, other->code);
+	if (writer->listing) {
+		append_asm(writer, other->buffer, other->length);
+	}
+}
+
+ASMWriter* emit_function_asm(CompilerContext* ctx, FunctionList* function_list) {
+	ASMWriter* writer = create_function_writer(ctx);
+	assert(writer);
+
+	schedule_callee_register_spills(ctx, function_list);
+	get_bytes_for_stack_frames(ctx, function_list);
+	emit_asm_for_functions(ctx, writer, function_list);
+	return writer;
+}
+
+ASMWriter* emit_asm(CompilerContext* ctx, FunctionList* function_list, char* file) {
 	ASMWriter* writer = create_asm_writer(ctx, file);
 	assert(writer);
 
@@ -2446,6 +2096,17 @@ void codegen(CompilerContext* ctx, FunctionList* function_list, char* file) {
 	get_bytes_for_stack_frames(ctx, function_list);
 	generate_globals(ctx, writer);
 	emit_asm_for_functions(ctx, writer, function_list);
-	fclose(writer->file);
- 	generate_executable(ctx, writer->filename);
+
+	bool resolved = resolve_code_labels(writer->code);
+	assert(resolved);
+
+	if (writer->listing) {
+		flush_asm_writer(writer);
+	}
+	return writer;
+}
+
+void codegen(CompilerContext* ctx, FunctionList* function_list, char* file) {
+	ASMWriter* writer = emit_asm(ctx, function_list, file);
+ 	generate_executable(ctx, writer, file);
 }
\ No newline at end of file
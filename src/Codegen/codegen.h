@@ -4,12 +4,15 @@
 #include "compilercontext.h"
 #include "IR/cfg.h"
 #include "symbols.h"
+#include "encoder.h"
 #include <string.h>
 
 #define EIGHT_BYTE_ALIGNMENT 8
 #define SIXTEEN_BYTE_ALIGNMENT 16
 #define INIT_ARG_LIST_CAPACITY 20
 #define INIT_SPILL_SCHEDULE_CAPACITY 20
+#define INIT_ASM_BUFFER_CAPACITY (1 << 16)
+#define INIT_FUNCTION_ASM_CAPACITY (1 << 12)
 #define INIT_POP_SCHEDULE_CAPACITY 20
 
 typedef enum {
@@ -28,13 +31,26 @@ typedef struct {
 	CallInstruction* c_instructions;
 } CallInstructionList;
 
+// instructions are encoded into code as they are emitted; the .asm listing is
+// only formatted with --emit-asm, into one buffer written by flush_asm_writer
 typedef struct {
 	FILE* file;
 	char* filename;
+	bool listing;
+
+	MachineCode* code;
+
+	Arena* arena;
+	char* buffer;
+	size_t length;
+	size_t capacity;
 } ASMWriter;
 
+int operand_register(Operand* op);
+AsmOperand operand_location(Operand* op);
 void emit_reloads(ASMWriter* writer, ReloadBundle* bundle);
 void emit_spills(ASMWriter* writer, SpillBundle* bundle);
+void claim_temp_registers(TACInstruction* tac, SpillBundle* bundle);
 
 SpillBundle* create_spill_bundle(CompilerContext* ctx, int size);
 SpillBundle* gather_matching_spills(CompilerContext* ctx, SpillSchedule* spill_schedule, int push_index);
@@ -65,13 +81,30 @@ StructuredArgs* create_sargs(CompilerContext* ctx, CallInstructionList* c_instr_
 
 char* generate_jmp_label(CompilerContext* ctx, jmp_label_t type);
 
+void reserve_asm(ASMWriter* writer, size_t length);
+void append_asm(ASMWriter* writer, const char* text, size_t length);
+void append_asm_text(ASMWriter* writer, const char* text);
+void append_asm_register(ASMWriter* writer, int reg);
+void append_asm_immediate(ASMWriter* writer, long long value);
+void append_asm_frame_slot(ASMWriter* writer, size_t frame_byte_offset);
+void append_asm_operand(ASMWriter* writer, AsmOperand operand);
+void end_asm_line(ASMWriter* writer);
+void emit_instruction(ASMWriter* writer, x86_op_t op, AsmOperand dest, AsmOperand src);
+void emit_reg(ASMWriter* writer, x86_op_t op, int reg);
+void emit_reg_reg(ASMWriter* writer, x86_op_t op, int dest, int src);
+void emit_reg_frame(ASMWriter* writer, x86_op_t op, int dest, size_t frame_byte_offset);
+void emit_frame_reg(ASMWriter* writer, x86_op_t op, size_t frame_byte_offset, int src);
+void emit_reg_immediate(ASMWriter* writer, x86_op_t op, int dest, long long value);
+void emit_asm_jump(ASMWriter* writer, x86_op_t op, const char* label);
+void emit_asm_label(ASMWriter* writer, const char* label);
 void write_asm_to_file(ASMWriter* writer, char* text);
+void flush_asm_writer(ASMWriter* writer);
 
 bool is_caller_saved(int reg);
 bool is_callee_saved(int reg);
 
-char* operator_to_string(tac_t type);
-char* get_op_code(tac_t type);
+x86_op_t operator_to_op(tac_t type);
+x86_op_t get_op_code(tac_t type);
 
 // void add_site(CompilerContext* ctx, CallGraph* call_graph, CallSite site);
 // CallGraph* create_call_graph(CompilerContext* ctx);
@@ -79,11 +112,13 @@ char* get_op_code(tac_t type);
 
 void collect_args(CompilerContext* ctx, FunctionInfo* info);
 void generate_corresponding_jump(ASMWriter* writer, tac_t kind, char* jmp_label);
+int caller_saved_live_across(TACInstruction* call);
+bool live_after(CFG* cfg, BasicBlock* block, int index, Operand* op);
+void emit_binary_operation(ASMWriter* writer, CFG* cfg, BasicBlock* block, int index);
 void generate_function_body(CompilerContext* ctx, ASMWriter* writer, FunctionInfo* info);
 void schedule_callee_register_spills(CompilerContext* ctx, FunctionList* function_list);
 void generate_function_prologue(CompilerContext* ctx, ASMWriter* writer, FunctionInfo* info);
 
-char* create_function_label(CompilerContext* ctx, char* func_name);
 void emit_asm_for_functions(CompilerContext* ctx, ASMWriter* writer,FunctionList* function_list);
 char* get_full_text(CompilerContext* ctx, char* func_name);
 void generate_globals(CompilerContext* ctx, ASMWriter* writer);
@@ -91,6 +126,7 @@ void ensure_main_function_exists(CompilerContext* ctx);
 
 Operand* find_non_restricted_operand(OperandSet* op_set, Operand* arg_op);
 Operand* operand_with_furthest_use(OperandSet* op_set);
+int scratch_register(OperandSet* op_set, int read, int written);
 Operand* find_matching_register(OperandSet* op_set, int reg);
 void ensure_alignment(int* op_size, int alignment);
 bool contains_operand_symbol(OperandSet* op_set, Symbol* target_symbol);
@@ -102,9 +138,14 @@ int determine_operand_use_within_call_boundary(BasicBlock* block, Operand* op, i
 int find_call_instr_index(BasicBlock* block, int start);
 void get_bytes_for_stack_frames(CompilerContext* ctx, FunctionList* function_list);
 
+char* strip_extension(CompilerContext* ctx, char* file, int extra);
 char* get_filename(CompilerContext* ctx, char* file);
 ASMWriter* create_asm_writer(CompilerContext* ctx, char* file);
-void generate_executable(CompilerContext* ctx, char* asm_file);
+ASMWriter* create_function_writer(CompilerContext* ctx);
+void append_asm_writer(ASMWriter* writer, ASMWriter* other);
+ASMWriter* emit_function_asm(CompilerContext* ctx, FunctionList* function_list);
+void generate_executable(CompilerContext* ctx, ASMWriter* writer, char* file);
+ASMWriter* emit_asm(CompilerContext* ctx, FunctionList* function_list, char* file);
 void codegen(CompilerContext* ctx, FunctionList* function_list, char* file);
 
 #endif
\ No newline at end of file
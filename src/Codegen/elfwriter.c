@@ -0,0 +1,65 @@
+#include "elfwriter.h"
+#include <elf.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+bool write_elf_executable(MachineCode* code, const char* path, const char* entry_label) {
+	long entry = find_code_label(code, entry_label);
+	if (entry == -1) {
+		printf("no '%s' label to use as the entry point\n", entry_label);
+		return false;
+	}
+
+	size_t code_offset = sizeof(Elf64_Ehdr) + sizeof(Elf64_Phdr);
+	size_t file_size = code_offset + code->length;
+
+	Elf64_Ehdr header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.e_ident, ELFMAG, SELFMAG);
+	header.e_ident[EI_CLASS] = ELFCLASS64;
+	header.e_ident[EI_DATA] = ELFDATA2LSB;
+	header.e_ident[EI_VERSION] = EV_CURRENT;
+	header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+	header.e_type = ET_EXEC;
+	header.e_machine = EM_X86_64;
+	header.e_version = EV_CURRENT;
+	header.e_entry = ELF_BASE_ADDRESS + code_offset + entry;
+	header.e_phoff = sizeof(Elf64_Ehdr);
+	header.e_ehsize = sizeof(Elf64_Ehdr);
+	header.e_phentsize = sizeof(Elf64_Phdr);
+	header.e_phnum = 1;
+
+	Elf64_Phdr segment;
+	memset(&segment, 0, sizeof(segment));
+	segment.p_type = PT_LOAD;
+	segment.p_flags = PF_R | PF_X;
+	segment.p_offset = 0;
+	segment.p_vaddr = ELF_BASE_ADDRESS;
+	segment.p_paddr = ELF_BASE_ADDRESS;
+	segment.p_filesz = file_size;
+	segment.p_memsz = file_size;
+	segment.p_align = ELF_PAGE_SIZE;
+
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		perror("Unable to open executable for writing.\n");
+		return false;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(&segment, sizeof(segment), 1, file) == 1 &&
+		fwrite(code->bytes, 1, code->length, file) == code->length;
+	fclose(file);
+
+	if (!written) {
+		perror("Unable to write executable.\n");
+		return false;
+	}
+
+	if (chmod(path, 0755) != 0) {
+		perror("Unable to mark executable.\n");
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,13 @@
+#ifndef ELF_WRITER_H
+#define ELF_WRITER_H
+
+#include "encoder.h"
+
+// one PT_LOAD segment mapping the headers and code read+execute, the way
+// fasm lays out "format ELF64 executable" without data sections
+#define ELF_BASE_ADDRESS 0x400000
+#define ELF_PAGE_SIZE 0x1000
+
+bool write_elf_executable(MachineCode* code, const char* path, const char* entry_label);
+
+#endif
@@ -0,0 +1,414 @@
+#include "encoder.h"
+#include "interner.h"
+#include "assert.h"
+#include <stdio.h>
+#include <string.h>
+
+// hardware numbers of registers[], then rsp and rbp
+static const int hardware_registers[] = {
+	0, 3, 7, 6, 2, 1,
+	8, 9, 10, 11, 12, 13, 14, 15,
+	4, 5
+};
+
+static const char* mnemonics[] = {
+	[X86_MOV] = "mov", [X86_ADD] = "add", [X86_SUB] = "sub", [X86_IMUL] = "imul",
+	[X86_CMP] = "cmp", [X86_TEST] = "test", [X86_XOR] = "xor", [X86_NEG] = "neg",
+	[X86_DIV] = "div", [X86_PUSH] = "push", [X86_POP] = "pop", [X86_CALL] = "call",
+	[X86_JMP] = "jmp", [X86_JE] = "je", [X86_JNE] = "jne", [X86_JZ] = "jz",
+	[X86_JL] = "jl", [X86_JLE] = "jle", [X86_JG] = "jg", [X86_JGE] = "jge",
+	[X86_LEAVE] = "leave", [X86_RET] = "ret", [X86_SYSCALL] = "syscall"
+};
+
+AsmOperand asm_none() {
+	AsmOperand operand = {.kind = ASM_NONE};
+	return operand;
+}
+
+AsmOperand asm_register(int reg) {
+	AsmOperand operand = {.kind = ASM_REGISTER, .value.reg = reg};
+	return operand;
+}
+
+AsmOperand asm_immediate(long long value) {
+	AsmOperand operand = {.kind = ASM_IMMEDIATE, .value.immediate = value};
+	return operand;
+}
+
+AsmOperand asm_frame_slot(size_t frame_byte_offset) {
+	AsmOperand operand = {.kind = ASM_FRAME_SLOT, .value.frame_byte_offset = frame_byte_offset};
+	return operand;
+}
+
+AsmOperand asm_label(const char* label) {
+	AsmOperand operand = {.kind = ASM_LABEL, .value.label = label};
+	return operand;
+}
+
+const char* x86_mnemonic(x86_op_t op) {
+	return mnemonics[op];
+}
+
+MachineCode* create_machine_code(CompilerContext* ctx, size_t capacity) {
+	MachineCode* code = arena_allocate(ctx->codegen_arena, sizeof(MachineCode));
+	if (!code) return NULL;
+
+	code->ctx = ctx;
+	code->arena = ctx->codegen_arena;
+
+	code->length = 0;
+	code->capacity = capacity;
+	code->bytes = arena_allocate(code->arena, code->capacity);
+	if (!code->bytes) return NULL;
+
+	code->num_definitions = 0;
+	code->definition_capacity = INIT_DEFINITION_CAPACITY;
+	code->definitions = arena_allocate(code->arena, sizeof(LabelDefinition) * code->definition_capacity);
+	if (!code->definitions) return NULL;
+
+	code->label_offsets = NULL;
+	code->num_label_slots = 0;
+
+	code->num_fixups = 0;
+	code->fixup_capacity = INIT_FIXUP_CAPACITY;
+	code->fixups = arena_allocate(code->arena, sizeof(Fixup) * code->fixup_capacity);
+	if (!code->fixups) return NULL;
+
+	return code;
+}
+
+void emit_code_byte(MachineCode* code, uint8_t byte) {
+	if (code->length >= code->capacity) {
+		size_t new_capacity = code->capacity * 2;
+		uint8_t* new_bytes = arena_reallocate(code->arena, code->bytes, code->length, new_capacity);
+		assert(new_bytes);
+
+		code->bytes = new_bytes;
+		code->capacity = new_capacity;
+	}
+	code->bytes[code->length++] = byte;
+}
+
+void emit_code_int32(MachineCode* code, int32_t value) {
+	uint32_t bits = (uint32_t)value;
+	for (int i = 0; i < 4; i++) {
+		emit_code_byte(code, (bits >> (8 * i)) & 0xff);
+	}
+}
+
+int code_label_id(MachineCode* code, const char* label) {
+	assert(label && "jump or label without a name");
+	InternedString* entry = intern_string(code->ctx, (char*)label, strlen(label));
+	assert(entry);
+	return entry->id;
+}
+
+void define_code_label(MachineCode* code, const char* label) {
+	if (code->num_definitions >= code->definition_capacity) {
+		int prev_capacity = code->definition_capacity;
+		code->definition_capacity *= 2;
+
+		LabelDefinition* new_definitions = arena_reallocate(
+			code->arena,
+			code->definitions,
+			prev_capacity * sizeof(LabelDefinition),
+			code->definition_capacity * sizeof(LabelDefinition)
+		);
+		assert(new_definitions);
+		code->definitions = new_definitions;
+	}
+
+	LabelDefinition definition = {
+		.offset = code->length,
+		.label_id = code_label_id(code, label)
+	};
+	code->definitions[code->num_definitions++] = definition;
+}
+
+// only meaningful once resolve_code_labels has run
+long find_code_label(MachineCode* code, const char* label) {
+	int id = code_label_id(code, label);
+	if (id >= code->num_label_slots) return -1;
+	return code->label_offsets[id];
+}
+
+void add_fixup(MachineCode* code, const char* label) {
+	if (code->num_fixups >= code->fixup_capacity) {
+		int prev_capacity = code->fixup_capacity;
+		code->fixup_capacity *= 2;
+
+		Fixup* new_fixups = arena_reallocate(
+			code->arena,
+			code->fixups,
+			prev_capacity * sizeof(Fixup),
+			code->fixup_capacity * sizeof(Fixup)
+		);
+		assert(new_fixups);
+		code->fixups = new_fixups;
+	}
+
+	Fixup fixup = {
+		.offset = code->length,
+		.label_id = code_label_id(code, label)
+	};
+	code->fixups[code->num_fixups++] = fixup;
+	emit_code_int32(code, 0);
+}
+
+// other's bytes land after code's, so its label definitions and fixups move
+// along by code's length; fixups stay unpatched until resolve_code_labels
+void append_machine_code(MachineCode* code, MachineCode* other) {
+	size_t base = code->length;
+	if (code->length + other->length > code->capacity) {
+		size_t new_capacity = code->capacity * 2;
+		while (code->length + other->length > new_capacity) {
+			new_capacity *= 2;
+		}
+
+		uint8_t* new_bytes = arena_reallocate(code->arena, code->bytes, code->length, new_capacity);
+		assert(new_bytes);
+		code->bytes = new_bytes;
+		code->capacity = new_capacity;
+	}
+	memcpy(code->bytes + code->length, other->bytes, other->length);
+	code->length += other->length;
+
+	for (int i = 0; i < other->num_definitions; i++) {
+		LabelDefinition* definition = &other->definitions[i];
+		if (code->num_definitions >= code->definition_capacity) {
+			int prev_capacity = code->definition_capacity;
+			code->definition_capacity *= 2;
+
+			LabelDefinition* new_definitions = arena_reallocate(
+				code->arena,
+				code->definitions,
+				prev_capacity * sizeof(LabelDefinition),
+				code->definition_capacity * sizeof(LabelDefinition)
+			);
+			assert(new_definitions);
+			code->definitions = new_definitions;
+		}
+
+		LabelDefinition moved = {
+			.offset = base + definition->offset,
+			.label_id = definition->label_id
+		};
+		code->definitions[code->num_definitions++] = moved;
+	}
+
+	for (int i = 0; i < other->num_fixups; i++) {
+		Fixup* fixup = &other->fixups[i];
+		if (code->num_fixups >= code->fixup_capacity) {
+			int prev_capacity = code->fixup_capacity;
+			code->fixup_capacity *= 2;
+
+			Fixup* new_fixups = arena_reallocate(
+				code->arena,
+				code->fixups,
+				prev_capacity * sizeof(Fixup),
+				code->fixup_capacity * sizeof(Fixup)
+			);
+			assert(new_fixups);
+			code->fixups = new_fixups;
+		}
+
+		Fixup moved = {
+			.offset = base + fixup->offset,
+			.label_id = fixup->label_id
+		};
+		code->fixups[code->num_fixups++] = moved;
+	}
+}
+
+int hardware_register(AsmOperand operand) {
+	assert(operand.kind == ASM_REGISTER);
+	return hardware_registers[operand.value.reg];
+}
+
+// REX.W, with R and B set when reg_field or a register rm is r8-r15
+void encode_rex(MachineCode* code, int reg_field, AsmOperand rm) {
+	uint8_t rex = 0x48;
+	if (reg_field >= 8) rex |= 0x04;
+	if (rm.kind == ASM_REGISTER && hardware_register(rm) >= 8) rex |= 0x01;
+	emit_code_byte(code, rex);
+}
+
+// frame slots are [rbp - n]: mod 01 with a disp8 when it fits, otherwise
+// mod 10 with a disp32; rbp as base never needs a SIB byte
+void encode_modrm(MachineCode* code, int reg_field, AsmOperand rm) {
+	int reg_bits = (reg_field & 7) << 3;
+	switch (rm.kind) {
+		case ASM_REGISTER: {
+			emit_code_byte(code, 0xc0 | reg_bits | (hardware_register(rm) & 7));
+			break;
+		}
+
+		case ASM_FRAME_SLOT: {
+			long displacement = -(long)rm.value.frame_byte_offset;
+			if (displacement >= -128) {
+				emit_code_byte(code, 0x45 | reg_bits);
+				emit_code_byte(code, (uint8_t)(int8_t)displacement);
+			} else {
+				emit_code_byte(code, 0x85 | reg_bits);
+				emit_code_int32(code, (int32_t)displacement);
+			}
+			break;
+		}
+
+		default:
+			assert(false && "operand cannot be encoded as r/m");
+	}
+}
+
+void encode_rm_instruction(MachineCode* code, uint8_t opcode, int reg_field, AsmOperand rm) {
+	encode_rex(code, reg_field, rm);
+	emit_code_byte(code, opcode);
+	encode_modrm(code, reg_field, rm);
+}
+
+// mov and the two-operand alu instructions share one shape:
+// rm_reg is "op r/m, r", reg_rm is "op r, r/m" and extension is the /digit of
+// the immediate form
+void encode_binary(MachineCode* code, uint8_t rm_reg, uint8_t reg_rm, int extension, AsmOperand dest, AsmOperand src) {
+	if (src.kind == ASM_REGISTER) {
+		encode_rm_instruction(code, rm_reg, hardware_register(src), dest);
+		return;
+	}
+
+	if (src.kind == ASM_FRAME_SLOT) {
+		assert(dest.kind == ASM_REGISTER);
+		encode_rm_instruction(code, reg_rm, hardware_register(dest), src);
+		return;
+	}
+
+	assert(src.kind == ASM_IMMEDIATE);
+	long long value = src.value.immediate;
+	if (rm_reg == 0x89) {
+		if (dest.kind == ASM_REGISTER && (value < INT32_MIN || value > INT32_MAX)) {
+			int reg = hardware_register(dest);
+			emit_code_byte(code, reg >= 8 ? 0x49 : 0x48);
+			emit_code_byte(code, 0xb8 + (reg & 7));
+			for (int i = 0; i < 8; i++) {
+				emit_code_byte(code, ((unsigned long long)value >> (8 * i)) & 0xff);
+			}
+			return;
+		}
+		assert(value >= INT32_MIN && value <= INT32_MAX);
+		encode_rm_instruction(code, 0xc7, 0, dest);
+		emit_code_int32(code, (int32_t)value);
+		return;
+	}
+
+	if (value >= -128 && value <= 127) {
+		encode_rm_instruction(code, 0x83, extension, dest);
+		emit_code_byte(code, (uint8_t)(int8_t)value);
+	} else {
+		assert(value >= INT32_MIN && value <= INT32_MAX);
+		encode_rm_instruction(code, 0x81, extension, dest);
+		emit_code_int32(code, (int32_t)value);
+	}
+}
+
+void encode_stack_instruction(MachineCode* code, uint8_t base, AsmOperand operand) {
+	int reg = hardware_register(operand);
+	if (reg >= 8) emit_code_byte(code, 0x41);
+	emit_code_byte(code, base + (reg & 7));
+}
+
+void encode_branch(MachineCode* code, x86_op_t op, AsmOperand target) {
+	assert(target.kind == ASM_LABEL);
+	switch (op) {
+		case X86_CALL: emit_code_byte(code, 0xe8); break;
+		case X86_JMP: emit_code_byte(code, 0xe9); break;
+		default: {
+			uint8_t condition = 0;
+			switch (op) {
+				case X86_JE:
+				case X86_JZ: condition = 0x84; break;
+				case X86_JNE: condition = 0x85; break;
+				case X86_JL: condition = 0x8c; break;
+				case X86_JGE: condition = 0x8d; break;
+				case X86_JLE: condition = 0x8e; break;
+				case X86_JG: condition = 0x8f; break;
+				default: assert(false && "not a branch");
+			}
+			emit_code_byte(code, 0x0f);
+			emit_code_byte(code, condition);
+			break;
+		}
+	}
+	add_fixup(code, target.value.label);
+}
+
+// every operation is 64-bit; branches always take a rel32
+void encode_instruction(MachineCode* code, x86_op_t op, AsmOperand dest, AsmOperand src) {
+	switch (op) {
+		case X86_MOV: encode_binary(code, 0x89, 0x8b, 0, dest, src); break;
+		case X86_ADD: encode_binary(code, 0x01, 0x03, 0, dest, src); break;
+		case X86_SUB: encode_binary(code, 0x29, 0x2b, 5, dest, src); break;
+		case X86_XOR: encode_binary(code, 0x31, 0x33, 6, dest, src); break;
+		case X86_CMP: encode_binary(code, 0x39, 0x3b, 7, dest, src); break;
+
+		case X86_IMUL: {
+			int reg = hardware_register(dest);
+			encode_rex(code, reg, src);
+			emit_code_byte(code, 0x0f);
+			emit_code_byte(code, 0xaf);
+			encode_modrm(code, reg, src);
+			break;
+		}
+
+		case X86_TEST: encode_rm_instruction(code, 0x85, hardware_register(src), dest); break;
+		case X86_NEG: encode_rm_instruction(code, 0xf7, 3, dest); break;
+		case X86_DIV: encode_rm_instruction(code, 0xf7, 6, dest); break;
+
+		case X86_PUSH: encode_stack_instruction(code, 0x50, dest); break;
+		case X86_POP: encode_stack_instruction(code, 0x58, dest); break;
+
+		case X86_CALL:
+		case X86_JMP:
+		case X86_JE:
+		case X86_JNE:
+		case X86_JZ:
+		case X86_JL:
+		case X86_JLE:
+		case X86_JG:
+		case X86_JGE: encode_branch(code, op, dest); break;
+
+		case X86_LEAVE: emit_code_byte(code, 0xc9); break;
+		case X86_RET: emit_code_byte(code, 0xc3); break;
+		case X86_SYSCALL: {
+			emit_code_byte(code, 0x0f);
+			emit_code_byte(code, 0x05);
+			break;
+		}
+	}
+}
+
+bool resolve_code_labels(MachineCode* code) {
+	code->num_label_slots = code->ctx->interner->size;
+	code->label_offsets = arena_allocate(code->arena, sizeof(long) * code->num_label_slots);
+	assert(code->label_offsets);
+
+	for (int i = 0; i < code->num_label_slots; i++) {
+		code->label_offsets[i] = -1;
+	}
+
+	for (int i = 0; i < code->num_definitions; i++) {
+		LabelDefinition* definition = &code->definitions[i];
+		code->label_offsets[definition->label_id] = definition->offset;
+	}
+
+	for (int i = 0; i < code->num_fixups; i++) {
+		Fixup* fixup = &code->fixups[i];
+		long target = code->label_offsets[fixup->label_id];
+		if (target == -1) {
+			fprintf(stderr, "undefined label '%s'\n", code->ctx->interner->entries[fixup->label_id]->str);
+			return false;
+		}
+
+		int32_t displacement = (int32_t)(target - (long)(fixup->offset + 4));
+		memcpy(code->bytes + fixup->offset, &displacement, sizeof(displacement));
+	}
+	return true;
+}
@@ -0,0 +1,122 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "compilercontext.h"
+
+#define INIT_CODE_CAPACITY (1 << 16)
+#define INIT_FUNCTION_CODE_CAPACITY (1 << 10)
+#define INIT_FIXUP_CAPACITY 256
+#define INIT_DEFINITION_CAPACITY 64
+
+// indices into registers[] past the allocatable ones
+#define REG_RSP 14
+#define REG_RBP 15
+
+typedef enum {
+	X86_MOV,
+	X86_ADD,
+	X86_SUB,
+	X86_IMUL,
+	X86_CMP,
+	X86_TEST,
+	X86_XOR,
+	X86_NEG,
+	X86_DIV,
+	X86_PUSH,
+	X86_POP,
+	X86_CALL,
+	X86_JMP,
+	X86_JE,
+	X86_JNE,
+	X86_JZ,
+	X86_JL,
+	X86_JLE,
+	X86_JG,
+	X86_JGE,
+	X86_LEAVE,
+	X86_RET,
+	X86_SYSCALL
+} x86_op_t;
+
+typedef enum {
+	ASM_NONE,
+	ASM_REGISTER,
+	ASM_IMMEDIATE,
+	ASM_FRAME_SLOT, // qword [rbp - frame_byte_offset]
+	ASM_LABEL
+} asm_operand_t;
+
+typedef struct {
+	asm_operand_t kind;
+	union {
+		int reg;
+		long long immediate;
+		size_t frame_byte_offset;
+		const char* label;
+	} value;
+} AsmOperand;
+
+// a rel32 that is patched once every label has an offset
+typedef struct {
+	size_t offset;
+	int label_id;
+} Fixup;
+
+// where a label was defined
+typedef struct {
+	size_t offset;
+	int label_id;
+} LabelDefinition;
+
+// machine code for one function or the whole program; labels are keyed by
+// their interned id, and stay a list of definitions until resolve_code_labels
+// so that one function's code can be appended to another's
+typedef struct {
+	CompilerContext* ctx;
+	Arena* arena;
+
+	uint8_t* bytes;
+	size_t length;
+	size_t capacity;
+
+	LabelDefinition* definitions;
+	int num_definitions;
+	int definition_capacity;
+
+	long* label_offsets; // -1 for undefined labels, once resolved
+	int num_label_slots;
+
+	Fixup* fixups;
+	int num_fixups;
+	int fixup_capacity;
+} MachineCode;
+
+AsmOperand asm_none();
+AsmOperand asm_register(int reg);
+AsmOperand asm_immediate(long long value);
+AsmOperand asm_frame_slot(size_t frame_byte_offset);
+AsmOperand asm_label(const char* label);
+const char* x86_mnemonic(x86_op_t op);
+
+MachineCode* create_machine_code(CompilerContext* ctx, size_t capacity);
+void emit_code_byte(MachineCode* code, uint8_t byte);
+void emit_code_int32(MachineCode* code, int32_t value);
+int code_label_id(MachineCode* code, const char* label);
+void define_code_label(MachineCode* code, const char* label);
+long find_code_label(MachineCode* code, const char* label);
+void add_fixup(MachineCode* code, const char* label);
+void append_machine_code(MachineCode* code, MachineCode* other);
+int hardware_register(AsmOperand operand);
+void encode_rex(MachineCode* code, int reg_field, AsmOperand rm);
+void encode_modrm(MachineCode* code, int reg_field, AsmOperand rm);
+void encode_rm_instruction(MachineCode* code, uint8_t opcode, int reg_field, AsmOperand rm);
+void encode_binary(MachineCode* code, uint8_t rm_reg, uint8_t reg_rm, int extension, AsmOperand dest, AsmOperand src);
+void encode_stack_instruction(MachineCode* code, uint8_t base, AsmOperand operand);
+void encode_branch(MachineCode* code, x86_op_t op, AsmOperand target);
+void encode_instruction(MachineCode* code, x86_op_t op, AsmOperand dest, AsmOperand src);
+bool resolve_code_labels(MachineCode* code);
+
+#endif
@@ -1,9 +1,11 @@
 #include "cfg.h"
+#include "dce.h"
+#include "ssa.h"
+#include "dominance.h"
+#include "loops.h"
+#include "licm.h"
 #include "assert.h"
-
-FunctionList* function_list = NULL;
-TACLeaders leaders_list;
-static int block_id = 0;
+#include "backend.h"
 
 FunctionList* create_function_list(CompilerContext* ctx) {
 	FunctionList* list = arena_allocate(ctx->ir_arena, sizeof(FunctionList));
@@ -31,6 +33,7 @@ FunctionInfo* create_function_info(CompilerContext* ctx, TACInstruction* instruc
 bool add_function_info_to_list(CompilerContext* ctx, FunctionInfo* info) {
 	if (!info) return false;
 
+	FunctionList* function_list = ctx->function->function_list;
 	if (function_list->size >= function_list->capacity) {
 		int prev_capacity = function_list->capacity;
 		
@@ -74,23 +77,24 @@ TACLeaders create_tac_leaders(CompilerContext* ctx) {
 bool add_leader_to_leader_list(CompilerContext* ctx, int index) {
 	if (index < 0) return false;
 
-	if (leaders_list.size >= leaders_list.capacity) {
-		int prev_capacity = leaders_list.capacity;
+	TACLeaders* leaders_list = &ctx->function->leaders_list;
+	if (leaders_list->size >= leaders_list->capacity) {
+		int prev_capacity = leaders_list->capacity;
 
-		leaders_list.capacity *= 2;
-		int new_capacity = leaders_list.capacity;
+		leaders_list->capacity *= 2;
+		int new_capacity = leaders_list->capacity;
 		void* new_leaders = arena_reallocate(
 			ctx->ir_arena, 
-			leaders_list.leaders, 
+			leaders_list->leaders, 
 			prev_capacity * sizeof(int), 
 			new_capacity * sizeof(int)
 		);
 		
 		if (!new_leaders) return false;
 
-		leaders_list.leaders = new_leaders;
+		leaders_list->leaders = new_leaders;
 	}
-	leaders_list.leaders[leaders_list.size++] = index;
+	leaders_list->leaders[leaders_list->size++] = index;
 	return true;
 }
 
@@ -136,6 +140,14 @@ bool add_block_to_cfg(CompilerContext* ctx, CFG* cfg, BasicBlock* block) {
 	return true; 
 }
 
+bool insert_block_into_cfg(CompilerContext* ctx, CFG* cfg, int index, BasicBlock* block) {
+	if (!add_block_to_cfg(ctx, cfg, block)) return false;
+
+	memmove(&cfg->all_blocks[index + 1], &cfg->all_blocks[index], sizeof(BasicBlock*) * (cfg->num_blocks - 1 - index));
+	cfg->all_blocks[index] = block;
+	return true;
+}
+
 BasicBlock* create_basic_block(CompilerContext* ctx) {
 	BasicBlock* basic_block = arena_allocate(ctx->ir_arena, sizeof(BasicBlock));
 	if (!basic_block) {
@@ -143,8 +155,11 @@ BasicBlock* create_basic_block(CompilerContext* ctx) {
 		return NULL;
 	}
 
-	basic_block->id = block_id++;
+	basic_block->id = ctx->function->block_id++;
 	basic_block->visited = false;
+	basic_block->on_worklist = false;
+	basic_block->rpo_index = -1;
+	basic_block->loop_depth = 0;
 	basic_block->num_instructions = 0;
 	basic_block->num_successors = 0;
 	basic_block->num_predecessors = 0;
@@ -204,6 +219,14 @@ bool add_instruction_to_block(CompilerContext* ctx, BasicBlock* block, TACInstru
 	return true;
 }
 
+bool insert_instruction_into_block(CompilerContext* ctx, BasicBlock* block, int index, TACInstruction* instruction) {
+	if (!add_instruction_to_block(ctx, block, instruction)) return false;
+
+	memmove(&block->instructions[index + 1], &block->instructions[index], sizeof(TACInstruction*) * (block->num_instructions - 1 - index));
+	block->instructions[index] = instruction;
+	return true;
+}
+
 void mark_function_boundaries(CompilerContext* ctx, TACTable* instructions) {
 	int tac_start_index = 0;
 	int tac_end_index = 0;
@@ -238,6 +261,7 @@ bool found_label(TACInstruction* instruction) {
 	switch (instruction->kind) {
 		case TAC_LABEL:
 		case TAC_GOTO: return true;
+		case TAC_PHI: return false;
 	}
 	return false;
 }
@@ -249,7 +273,7 @@ int find_label_index(TACTable* instructions, char* target_name, int current_inde
 		if (!instructions->tacs[i]->result) continue;
 		if (instructions->tacs[i]->result->kind != OP_LABEL) continue;
 		if (!instructions->tacs[i]->result->value.label_name) continue;
-		if (strcmp(target_name, instructions->tacs[i]->result->value.label_name) == 0) {
+		if (instructions->tacs[i]->result->value.label_name == target_name) {
 			// printf("\033[31mFound label index: %d\033[0m\n", i);
 			return i;
 		}
@@ -259,14 +283,17 @@ int find_label_index(TACTable* instructions, char* target_name, int current_inde
 }
 
 void find_leaders(CompilerContext* ctx, TACTable* instructions) {
+	FunctionList* function_list = ctx->function->function_list;
 	int i = 0;
 
 	while (function_list->infos[i] && i < function_list->size) {
 		int start = function_list->infos[i]->tac_start_index; // function name index 
 		int end = function_list->infos[i]->tac_end_index;
 
+		// folding can leave a goto as the first instruction after the
+		// name, so the scan starts there too
 		add_leader_to_leader_list(ctx, start + 1);
-		int current_index = start + 2;
+		int current_index = start + 1;
 		while (instructions->tacs[current_index] && ( current_index <= end )) {
 			if (!instructions->tacs[current_index]) {
 				current_index++;
@@ -287,11 +314,16 @@ void find_leaders(CompilerContext* ctx, TACTable* instructions) {
 					break;
 				}
 
+				// constant folding turns IF_FALSEs into GOTOs, which need not
+				// be followed by a label
 				case TAC_GOTO: {
 					int label_start = find_label_index(instructions, instructions->tacs[current_index]->result->value.label_name, current_index + 1);
 					if (label_start != -1) {
 						add_leader_to_leader_list(ctx, label_start);
 					}
+					if (current_index + 1 <= end) {
+						add_leader_to_leader_list(ctx, current_index + 1);
+					}
 					break;
 				}
 
@@ -333,16 +365,18 @@ void find_leaders(CompilerContext* ctx, TACTable* instructions) {
 	}
 }
 
-bool index_is_leader(int index) {
-	for (int i = 0; i < leaders_list.size; i++) {
-		if (index == leaders_list.leaders[i]) return true;
+bool index_is_leader(CompilerContext* ctx, int index) {
+	TACLeaders* leaders_list = &ctx->function->leaders_list;
+	for (int i = 0; i < leaders_list->size; i++) {
+		if (index == leaders_list->leaders[i]) return true;
 	}
 	return false;
 }
 
 bool make_function_cfgs(CompilerContext* ctx, TACTable* instructions) {
+	FunctionList* function_list = ctx->function->function_list;
 	for (int i = 0; i < function_list->size; i++) {
-		block_id = 0;
+		ctx->function->block_id = 0;
 		FunctionInfo* info = function_list->infos[i];
 		info->cfg = create_cfg(ctx);
 		assert(info->cfg);
@@ -360,7 +394,7 @@ bool make_function_cfgs(CompilerContext* ctx, TACTable* instructions) {
 		add_instruction_to_block(ctx, block, instructions->tacs[leader_offset]);
 
 		while (instructions->tacs[remaining_instructions_offset] && remaining_instructions_offset <= end) {			
-			bool is_leader = index_is_leader(remaining_instructions_offset);
+			bool is_leader = index_is_leader(ctx, remaining_instructions_offset);
 			if (!is_leader) {
 				add_instruction_to_block(ctx, block, instructions->tacs[remaining_instructions_offset]);
 			} else {
@@ -394,7 +428,7 @@ BasicBlock* find_matching_label_block(CFG* cfg,  char* target_name) {
 			if (first->kind == TAC_LABEL &&
 				first->result &&
 				first->result->value.label_name &&
-				strcmp(first->result->value.label_name, target_name) == 0) {
+				first->result->value.label_name == target_name) {
 				return current_block;
 			}
 		}
@@ -445,6 +479,7 @@ void add_edges(CompilerContext* ctx, CFG* cfg, int index, BasicBlock* block) {
 }
 
 void link_function_cfgs(CompilerContext* ctx) {
+	FunctionList* function_list = ctx->function->function_list;
 	for (int i = 0; i < function_list->size; i++) {
 		FunctionInfo* info = function_list->infos[i];
 		CFG* cfg = info->cfg;
@@ -491,6 +526,27 @@ void link_function_cfgs(CompilerContext* ctx) {
 	}
 }
 
+// unreachable blocks go before ssa, which only renames what the entry
+// reaches; the cfg is back out of ssa form before liveness
+void optimize_function_cfgs(CompilerContext* ctx) {
+	FunctionList* function_list = ctx->function->function_list;
+	for (int i = 0; i < function_list->size; i++) {
+		FunctionInfo* info = function_list->infos[i];
+		CFG* cfg = info->cfg;
+		if (!cfg) continue;
+
+		if (!ctx->no_dce) {
+			cfg->unreachable_blocks = remove_unreachable_blocks(ctx, cfg);
+		}
+
+		if (!ctx->no_ssa) {
+			SSABuilder* ssa = construct_ssa(ctx, info);
+			if (!ctx->no_licm) hoist_loop_invariants(ctx, info, ssa);
+			destruct_ssa(ctx, info, ssa);
+		}
+	}
+}
+
 /////////////////////////////////////////////////////
 // live analysis functions 
 LivenessTable* create_liveness_table(CompilerContext* ctx) {
@@ -640,30 +696,216 @@ bool add_liveinfo_to_liveness_table(CompilerContext* ctx, LivenessTable* table,
 	return true;
 }
 
-OperandSet* copy_set(CompilerContext* ctx, OperandSet* original_set) {
-	if (!original_set) return NULL;
+BitSet* create_bitset(CompilerContext* ctx, int num_bits) {
+	BitSet* set = arena_allocate(ctx->ir_arena, sizeof(BitSet));
+	if (!set) return NULL;
+
+	set->num_words = (num_bits + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+	if (set->num_words == 0) set->num_words = 1;
+
+	set->words = arena_allocate(ctx->ir_arena, sizeof(uint64_t) * set->num_words);
+	if (!set->words) return NULL;
+	return set;
+}
+
+void bitset_add(BitSet* set, int index) {
+	if (index < 0) return;
+	set->words[index / BITSET_WORD_BITS] |= (uint64_t)1 << (index % BITSET_WORD_BITS);
+}
+
+void bitset_remove(BitSet* set, int index) {
+	if (index < 0) return;
+	set->words[index / BITSET_WORD_BITS] &= ~((uint64_t)1 << (index % BITSET_WORD_BITS));
+}
+
+bool bitset_contains(BitSet* set, int index) {
+	if (index < 0) return false;
+	return (set->words[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1;
+}
+
+void bitset_clear(BitSet* set) {
+	memset(set->words, 0, sizeof(uint64_t) * set->num_words);
+}
+
+void bitset_copy(BitSet* dest, BitSet* src) {
+	memcpy(dest->words, src->words, sizeof(uint64_t) * dest->num_words);
+}
+
+void bitset_union(BitSet* dest, BitSet* src) {
+	for (int i = 0; i < dest->num_words; i++) {
+		dest->words[i] |= src->words[i];
+	}
+}
+
+bool bitset_equal(BitSet* set1, BitSet* set2) {
+	return memcmp(set1->words, set2->words, sizeof(uint64_t) * set1->num_words) == 0;
+}
+
+// bits are distinct operands already, so elements are appended without
+// the membership scan 'add_to_operand_set' would do
+OperandSet* bitset_to_operand_set(CompilerContext* ctx, OperandNumbering* numbering, BitSet* set) {
+	int count = 0;
+	for (int i = 0; i < set->num_words; i++) {
+		count += __builtin_popcountll(set->words[i]);
+	}
+
+	OperandSet* op_set = arena_allocate(ctx->ir_arena, sizeof(OperandSet));
+	if (!op_set) return NULL;
+
+	op_set->size = 0;
+	op_set->capacity = count > 0 ? count : 1;
+	op_set->elements = arena_allocate(ctx->ir_arena, sizeof(Operand*) * op_set->capacity);
+	if (!op_set->elements) return NULL;
+
+	for (int i = 0; i < set->num_words; i++) {
+		uint64_t word = set->words[i];
+		while (word) {
+			int index = i * BITSET_WORD_BITS + __builtin_ctzll(word);
+			word &= word - 1;
+			op_set->elements[op_set->size++] = numbering->operands[index];
+		}
+	}
+	return op_set;
+}
+
+OperandNumbering* create_operand_numbering(CompilerContext* ctx) {
+	OperandNumbering* numbering = arena_allocate(ctx->ir_arena, sizeof(OperandNumbering));
+	if (!numbering) {
+		perror("In 'create_operand_numbering', unable to allocate space for operand numbering\n");
+		return NULL;
+	}
+
+	numbering->count = 0;
+	numbering->capacity = INIT_OPERAND_NUMBERING_CAPACITY;
+	numbering->operands_capacity = INIT_OPERAND_NUMBERING_CAPACITY;
+	numbering->keys = arena_allocate(ctx->ir_arena, sizeof(void*) * numbering->capacity);
+	numbering->kinds = arena_allocate(ctx->ir_arena, sizeof(operand_t) * numbering->capacity);
+	numbering->indices = arena_allocate(ctx->ir_arena, sizeof(int) * numbering->capacity);
+	numbering->operands = arena_allocate(ctx->ir_arena, sizeof(Operand*) * numbering->operands_capacity);
+	if (!numbering->keys || !numbering->kinds || !numbering->indices || !numbering->operands) {
+		perror("In 'create_operand_numbering', unable to allocate space for numbering slots\n");
+		return NULL;
+	}
+	return numbering;
+}
+
+// symbols are shared operands and labels are interned, so a variable is
+// identified by its symbol or label pointer together with its kind
+void* operand_key(Operand* operand) {
+	if (!is_operand_label_or_symbol(operand)) return NULL;
+	if (operand->kind == OP_SYMBOL) return operand->value.sym;
+	return operand->value.label_name;
+}
+
+unsigned int hash_operand_key(void* key, operand_t kind, int capacity) {
+	uintptr_t h = (uintptr_t)key >> 3;
+	h ^= (uintptr_t)kind * 0x9e3779b9u;
+	h *= 0x9e3779b97f4a7c15ull;
+	return (unsigned int)(h >> 32) & (capacity - 1);
+}
+
+int find_operand_number(OperandNumbering* numbering, Operand* operand) {
+	void* key = operand ? operand_key(operand) : NULL;
+	if (!key) return -1;
+
+	unsigned int slot = hash_operand_key(key, operand->kind, numbering->capacity);
+	while (numbering->keys[slot]) {
+		if (numbering->keys[slot] == key && numbering->kinds[slot] == operand->kind) {
+			return numbering->indices[slot];
+		}
+		slot = (slot + 1) & (numbering->capacity - 1);
+	}
+	return -1;
+}
+
+bool grow_operand_numbering(CompilerContext* ctx, OperandNumbering* numbering) {
+	int prev_capacity = numbering->capacity;
+	void** prev_keys = numbering->keys;
+	operand_t* prev_kinds = numbering->kinds;
+	int* prev_indices = numbering->indices;
+
+	numbering->capacity *= 2;
+	numbering->keys = arena_allocate(ctx->ir_arena, sizeof(void*) * numbering->capacity);
+	numbering->kinds = arena_allocate(ctx->ir_arena, sizeof(operand_t) * numbering->capacity);
+	numbering->indices = arena_allocate(ctx->ir_arena, sizeof(int) * numbering->capacity);
+	if (!numbering->keys || !numbering->kinds || !numbering->indices) return false;
+
+	for (int i = 0; i < prev_capacity; i++) {
+		if (!prev_keys[i]) continue;
+
+		unsigned int slot = hash_operand_key(prev_keys[i], prev_kinds[i], numbering->capacity);
+		while (numbering->keys[slot]) {
+			slot = (slot + 1) & (numbering->capacity - 1);
+		}
+		numbering->keys[slot] = prev_keys[i];
+		numbering->kinds[slot] = prev_kinds[i];
+		numbering->indices[slot] = prev_indices[i];
+	}
+	return true;
+}
+
+int number_operand(CompilerContext* ctx, OperandNumbering* numbering, Operand* operand) {
+	void* key = operand ? operand_key(operand) : NULL;
+	if (!key) return -1;
 
-	OperandSet* duplicate_set = arena_allocate(ctx->ir_arena, sizeof(OperandSet));
-	if (!duplicate_set) return NULL;
+	int index = find_operand_number(numbering, operand);
+	if (index != -1) return index;
 
-	duplicate_set->size = original_set->size;
-	duplicate_set->capacity = original_set->capacity;
-	duplicate_set->elements = arena_allocate(ctx->ir_arena, sizeof(Operand*) * duplicate_set->capacity);
-	if (!duplicate_set->elements) return NULL;
+	if (2 * (numbering->count + 1) > numbering->capacity) {
+		if (!grow_operand_numbering(ctx, numbering)) return -1;
+	}
+
+	if (numbering->count >= numbering->operands_capacity) {
+		int prev_capacity = numbering->operands_capacity;
+		numbering->operands_capacity *= 2;
+		void* new_operands = arena_reallocate(
+			ctx->ir_arena,
+			numbering->operands,
+			prev_capacity * sizeof(Operand*),
+			numbering->operands_capacity * sizeof(Operand*)
+		);
+		if (!new_operands) return -1;
+		numbering->operands = new_operands;
+	}
 
-	for (int i = 0; i < duplicate_set->size; i++) {
-		duplicate_set->elements[i] = original_set->elements[i];
+	unsigned int slot = hash_operand_key(key, operand->kind, numbering->capacity);
+	while (numbering->keys[slot]) {
+		slot = (slot + 1) & (numbering->capacity - 1);
 	}
-	return duplicate_set;
+
+	index = numbering->count++;
+	numbering->keys[slot] = key;
+	numbering->kinds[slot] = operand->kind;
+	numbering->indices[slot] = index;
+	numbering->operands[index] = operand;
+	return index;
 }
 
-bool init_block_sets(CompilerContext* ctx, BasicBlock* block) {
+void number_function_operands(CompilerContext* ctx, CFG* cfg) {
+	cfg->numbering = create_operand_numbering(ctx);
+	assert(cfg->numbering);
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		for (int j = 0; j < block->num_instructions; j++) {
+			TACInstruction* tac = block->instructions[j];
+			if (!tac) continue;
+
+			number_operand(ctx, cfg->numbering, tac->result);
+			number_operand(ctx, cfg->numbering, tac->op1);
+			number_operand(ctx, cfg->numbering, tac->op2);
+		}
+	}
+}
+
+bool init_block_sets(CompilerContext* ctx, CFG* cfg, BasicBlock* block) {
 	if (!block) return false;
 
-	block->use_set = create_operand_set(ctx);
-	block->def_set = create_operand_set(ctx);
-	block->in_set = create_operand_set(ctx);
-	block->out_set = create_operand_set(ctx);
+	int num_bits = cfg->numbering->count;
+	block->use_set = create_bitset(ctx, num_bits);
+	block->def_set = create_bitset(ctx, num_bits);
+	block->in_set = create_bitset(ctx, num_bits);
+	block->out_set = create_bitset(ctx, num_bits);
 
 	if (!block->use_set || !block->def_set ||
 		!block->in_set || !block->out_set) {
@@ -680,9 +922,7 @@ bool operands_equal(Operand* op1, Operand* op2) {
 	switch (op1->kind) {
 		case OP_SYMBOL: {
 			return (op1->value.sym && op2->value.sym) && 
-				   (op1->value.sym == op2->value.sym) &&
-				    op1->value.sym->scope_level == op2->value.sym->scope_level &&
-				    strcmp(op1->value.sym->name, op2->value.sym->name) == 0;
+				   (op1->value.sym == op2->value.sym);
 		}
 
 		case OP_STORE:
@@ -702,8 +942,8 @@ bool operands_equal(Operand* op1, Operand* op2) {
 		case OP_NOT_EQUAL:
 		case OP_LOGICAL_AND:
 		case OP_LOGICAL_OR: {
-			return (op1->value.label_name && op2->value.label_name) && 
-				   (strcmp(op1->value.label_name, op2->value.label_name) == 0);
+			// label names are interned, so equal names share a pointer
+			return op1->value.label_name && op1->value.label_name == op2->value.label_name;
 		}
 		
 		default: 
@@ -747,10 +987,25 @@ void remove_from_operand_set(OperandSet* op_set, Operand* operand) {
 	}
 }
 
-void populate_use_and_def_sets(CompilerContext* ctx, BasicBlock* block) {
+void mark_block_use(CFG* cfg, BasicBlock* block, BitSet* ops_defined, Operand* operand) {
+	int index = find_operand_number(cfg->numbering, operand);
+	if (index != -1 && !bitset_contains(ops_defined, index)) {
+		bitset_add(block->use_set, index);
+	}
+}
+
+void mark_block_def(CFG* cfg, BasicBlock* block, BitSet* ops_defined, Operand* operand) {
+	int index = find_operand_number(cfg->numbering, operand);
+	bitset_add(ops_defined, index);
+	bitset_add(block->def_set, index);
+}
+
+void populate_use_and_def_sets(CompilerContext* ctx, CFG* cfg, BasicBlock* block) {
 	if (!block) return;
 
-	OperandSet* ops_defined = create_operand_set(ctx);
+	BitSet* ops_defined = create_bitset(ctx, cfg->numbering->count);
+	assert(ops_defined);
+
 	for (int i = 0; i < block->num_instructions; i++) {
 		TACInstruction* tac = block->instructions[i];
 		if (!tac) continue;
@@ -769,163 +1024,151 @@ void populate_use_and_def_sets(CompilerContext* ctx, BasicBlock* block) {
 			case TAC_NOT_EQUAL:
 			case TAC_LOGICAL_OR:
 			case TAC_LOGICAL_AND: {
-				if (tac->op1->kind != OP_RETURN) {
-					bool op1_already_def = contains_operand(ops_defined, tac->op1);
-					if (!op1_already_def) {
-						add_to_operand_set(ctx, block->use_set, tac->op1);
-					}					
-				}
-
-				if (tac->op2->kind != OP_RETURN) {
-					bool op2_already_def = contains_operand(ops_defined, tac->op2);
-					if (!op2_already_def) {
-						add_to_operand_set(ctx, block->use_set, tac->op2);
-					}
-
-				}
-
-				bool result_already_def = contains_operand(ops_defined, tac->result);
-				if (!result_already_def) {
-					add_to_operand_set(ctx, ops_defined, tac->result);
-				}
-				add_to_operand_set(ctx, block->def_set, tac->result);
-				break;
-			}
-
-			case TAC_IF_FALSE: {
-				if (tac->op1) {
-					bool op1_already_def = contains_operand(ops_defined, tac->op1);
-					if (!op1_already_def) {
-						add_to_operand_set(ctx, block->use_set, tac->op1);
-					}
-				}
+				mark_block_use(cfg, block, ops_defined, tac->op1);
+				mark_block_use(cfg, block, ops_defined, tac->op2);
+				mark_block_def(cfg, block, ops_defined, tac->result);
 				break;
 			}
 
-			case TAC_RETURN: {
-				if (tac->op1) {
-					bool op1_already_def = contains_operand(ops_defined, tac->op1);
-					if (!op1_already_def) {
-						add_to_operand_set(ctx, block->use_set, tac->op1);
-					}
-				}
+			case TAC_IF_FALSE:
+			case TAC_RETURN:
+			case TAC_ARG: {
+				mark_block_use(cfg, block, ops_defined, tac->op1);
 				break;
 			}
 
 			case TAC_CHAR:
 			case TAC_BOOL:
 			case TAC_INTEGER: {
-				add_to_operand_set(ctx, ops_defined, tac->result);
-				add_to_operand_set(ctx, block->def_set, tac->result);
+				mark_block_def(cfg, block, ops_defined, tac->result);
 				break;
 			}
 
 			case TAC_PARAM: break;
 
-			case TAC_ARG: {
-				bool op1_already_def = contains_operand(ops_defined, tac->op1);
-				if (!op1_already_def) {
-					add_to_operand_set(ctx, block->use_set, tac->op1);
-				}
-				break;
-			}
-
 			case TAC_STORE:
 			case TAC_DEREFERENCE_AND_ASSIGN:
 			case TAC_DEREFERENCE: 
 			case TAC_UNARY_ADD:
 			case TAC_UNARY_SUB:
 			case TAC_NOT: {
-				if (tac->op1) {
-					bool op1_already_def = contains_operand(ops_defined, tac->op1);
-					if (!op1_already_def) {
-						add_to_operand_set(ctx, block->use_set, tac->op1);
-					}
-				}
-
-				add_to_operand_set(ctx, ops_defined, tac->result);
-				add_to_operand_set(ctx, block->def_set, tac->result);
+				mark_block_use(cfg, block, ops_defined, tac->op1);
+				mark_block_def(cfg, block, ops_defined, tac->result);
 				break;
 			}
 
 			case TAC_ASSIGNMENT: {
-				if (tac->op2 && tac->op2->kind == OP_RETURN) {
-					add_to_operand_set(ctx, block->def_set, tac->result);
-				} else {
-					bool op2_already_def = contains_operand(ops_defined, tac->op2);
-					if (!op2_already_def) {
-						add_to_operand_set(ctx, block->use_set, tac->op2);
-					}
-					add_to_operand_set(ctx, block->def_set, tac->result);
+				// '_RET' is not a variable, so 't = _RET' only defines t
+				if (tac->op2 && tac->op2->kind != OP_RETURN) {
+					mark_block_use(cfg, block, ops_defined, tac->op2);
 				}
-				add_to_operand_set(ctx, ops_defined, tac->result);
+				mark_block_def(cfg, block, ops_defined, tac->result);
 				break;
 			}
-		}
-	}
-}
 
-void union_sets(CompilerContext* ctx, OperandSet* dest, OperandSet* src) {
-	for (int i = 0; i < src->size; i++) {
-		if (!contains_operand(dest, src->elements[i])) {
-			add_to_operand_set(ctx, dest, src->elements[i]);
+			case TAC_PHI: assert(false && "liveness runs outside of ssa"); break;
 		}
 	}
 }
 
-bool sets_equal(OperandSet* set1, OperandSet* set2) {
-	if (set1->size != set2->size) return false;
+void compute_reverse_postorder(CompilerContext* ctx, CFG* cfg) {
+	cfg->rpo = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	BasicBlock** stack = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	int* next_successor = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	assert(cfg->rpo && stack && next_successor);
 
-	for (int i = 0; i < set1->size; i++) {
-		if (!contains_operand(set2, set1->elements[i])) {
-			return false;
-		}
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		cfg->all_blocks[i]->visited = false;
 	}
-	return true;
-}
 
-OperandSet* difference_sets(CompilerContext* ctx, OperandSet* set1, OperandSet* set2) {
-	if (!set1 || !set2) return NULL;
+	// iterative dfs from the entry; blocks are written back to front as
+	// they finish, which leaves them in reverse postorder
+	int position = cfg->num_blocks;
+	int top = 0;
+	BasicBlock* entry = cfg->all_blocks[0];
+	entry->visited = true;
+	next_successor[top] = 0;
+	stack[top++] = entry;
+
+	int reachable = 0;
+	while (top > 0) {
+		BasicBlock* block = stack[top - 1];
+		if (next_successor[top - 1] < block->num_successors) {
+			BasicBlock* successor = block->successors[next_successor[top - 1]++];
+			if (!successor->visited) {
+				successor->visited = true;
+				next_successor[top] = 0;
+				stack[top++] = successor;
+			}
+		} else {
+			cfg->rpo[--position] = block;
+			reachable++;
+			top--;
+		}
+	}
 
-	OperandSet* diff_set = create_operand_set(ctx);
-	for (int i = 0; i < set1->size; i++) {
-		if (!contains_operand(set2, set1->elements[i])) {
-			add_to_operand_set(ctx, diff_set, set1->elements[i]);
+	// shift the reachable blocks to the front and append the rest
+	memmove(cfg->rpo, &cfg->rpo[position], sizeof(BasicBlock*) * reachable);
+	int count = reachable;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		if (!cfg->all_blocks[i]->visited) {
+			cfg->rpo[count++] = cfg->all_blocks[i];
 		}
 	}
 
-	return diff_set;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		cfg->rpo[i]->rpo_index = i;
+	}
 }
 
+// liveness flows backwards, so each pass walks the reverse postorder from
+// its end and only visits blocks whose successors changed; another pass is
+// needed only when a changed block feeds a block already behind the sweep,
+// i.e. along a loop's back edge
 void fixed_point_iteration(CompilerContext* ctx, CFG* cfg) {
+	cfg->liveness_passes = 0;
+	cfg->liveness_visits = 0;
+	if (cfg->num_blocks == 0) return;
+
+	BitSet* new_in = create_bitset(ctx, cfg->numbering->count);
+	assert(new_in);
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		cfg->all_blocks[i]->on_worklist = true;
+	}
+
 	bool changed = true;
 	while (changed) {
 		changed = false;
+		cfg->liveness_passes++;
 
 		for (int i = cfg->num_blocks - 1; i >= 0; i--) {
-			BasicBlock* block = cfg->all_blocks[i];
+			BasicBlock* block = cfg->rpo[i];
+			if (!block->on_worklist) continue;
 
-			OperandSet* old_out = copy_set(ctx, block->out_set);
-			OperandSet* old_in = copy_set(ctx, block->in_set);
+			block->on_worklist = false;
+			cfg->liveness_visits++;
 
-			OperandSet* new_out = create_operand_set(ctx);
-			for (int j = 0; j < block->num_successors; j++) {			
-				BasicBlock* successor = block->successors[j];
-				union_sets(ctx, new_out, successor->in_set);
+			bitset_clear(block->out_set);
+			for (int j = 0; j < block->num_successors; j++) {
+				bitset_union(block->out_set, block->successors[j]->in_set);
 			}
 
-			OperandSet* out_minus_def = difference_sets(ctx, new_out, block->def_set);
-			OperandSet* new_in = create_operand_set(ctx);
-			union_sets(ctx, new_in, block->use_set);
-			union_sets(ctx, new_in, out_minus_def);
-
-			if (!sets_equal(old_in, new_in) || !sets_equal(old_out, new_out)) {
-				changed = true;
+			for (int w = 0; w < new_in->num_words; w++) {
+				new_in->words[w] = block->use_set->words[w] | (block->out_set->words[w] & ~block->def_set->words[w]);
 			}
 
-			block->out_set = new_out;
-			block->in_set = new_in;
-		}		
+			if (bitset_equal(new_in, block->in_set)) continue;
+			bitset_copy(block->in_set, new_in);
+
+			for (int j = 0; j < block->num_predecessors; j++) {
+				BasicBlock* predecessor = block->predecessors[j];
+				predecessor->on_worklist = true;
+				if (predecessor->rpo_index >= i) {
+					changed = true;
+				}
+			}
+		}
 	}
 }
 
@@ -960,7 +1203,7 @@ LivenessInfo* retrieve_livenessinfo(LivenessTable* table, int hash_key, char* ta
 				info_name = current->var.label_name;
 			}
 
-			if (info_name && strcmp(target_name, info_name) == 0) {
+			if (info_name == target_name) {
 				return current;
 			}
 
@@ -1111,9 +1354,10 @@ void determine_next_use(CompilerContext* ctx, CFG* cfg) {
 		BasicBlock* current_block = cfg->all_blocks[i];
 
 		LivenessTable* live_variables = create_liveness_table(ctx);
+		OperandSet* live_at_exit = bitset_to_operand_set(ctx, cfg->numbering, current_block->out_set);
 
-		for (int j = 0; j < current_block->out_set->size; j++) {
-			Operand* op = current_block->out_set->elements[j];
+		for (int j = 0; j < live_at_exit->size; j++) {
+			Operand* op = live_at_exit->elements[j];
 			int hash_key = 0;
 			switch (op->kind) {
 				case OP_SYMBOL: {
@@ -1172,6 +1416,10 @@ void determine_next_use(CompilerContext* ctx, CFG* cfg) {
 }
 
 void compute_instruction_live_out(CompilerContext* ctx, CFG* cfg) {
+	OperandNumbering* numbering = cfg->numbering;
+	BitSet* current_live = create_bitset(ctx, numbering->count);
+	assert(current_live);
+
 	// printf("==================================\n");
 	// printf("Displaying Out sets for each block\n\n");
 	for (int i = 0; i < cfg->num_blocks; i++) {
@@ -1265,7 +1513,7 @@ void compute_instruction_live_out(CompilerContext* ctx, CFG* cfg) {
 		// }
 		// printf("}\n\n");
 
-		OperandSet* current_live = copy_set(ctx, block->out_set);
+		bitset_copy(current_live, block->out_set);
 
 		for (int j = block->num_instructions - 1; j >= 0; j--) {
 			TACInstruction* instruction = block->instructions[j];
@@ -1278,41 +1526,30 @@ void compute_instruction_live_out(CompilerContext* ctx, CFG* cfg) {
 					}
 
 					case TAC_ASSIGNMENT: {
-						if (instruction->op2) {
-							if (instruction->op2->kind != OP_RETURN) {
-								add_to_operand_set(ctx, current_live, instruction->op2);
-							}
+						if (instruction->op2 && instruction->op2->kind != OP_RETURN) {
+							int source = find_operand_number(numbering, instruction->op2);
+							instruction->source_dies = source != -1 && !bitset_contains(current_live, source);
+							bitset_add(current_live, source);
 						}
-						remove_from_operand_set(current_live, instruction->result);
-						
+						bitset_remove(current_live, find_operand_number(numbering, instruction->result));
 						break;
 					}
 
 					case TAC_CHAR:
 					case TAC_BOOL:
 					case TAC_INTEGER: {
-						if (instruction->result) {
-							remove_from_operand_set(current_live, instruction->result);
-						}
+						bitset_remove(current_live, find_operand_number(numbering, instruction->result));
 						break;
 					}
 
 					default: {
-						if (instruction->result) {
-							remove_from_operand_set(current_live, instruction->result);
-						}
-
-						if (instruction->op1) {
-							add_to_operand_set(ctx, current_live, instruction->op1);
-						}
-
-						if (instruction->op2) {
-							add_to_operand_set(ctx, current_live, instruction->op2);
-						}
+						bitset_remove(current_live, find_operand_number(numbering, instruction->result));
+						bitset_add(current_live, find_operand_number(numbering, instruction->op1));
+						bitset_add(current_live, find_operand_number(numbering, instruction->op2));
 						break;
 					}
 				}
-				instruction->live_out = copy_set(ctx, current_live);
+				instruction->live_out = bitset_to_operand_set(ctx, numbering, current_live);
 
 				// if (instruction->result) {
 				// 	switch (instruction->result->kind) {
@@ -1359,76 +1596,58 @@ void compute_instruction_live_out(CompilerContext* ctx, CFG* cfg) {
 	// printf("==================================\n");
 }
 
+// numbers the operands, finds the loops and solves block liveness from scratch
+void solve_liveness(CompilerContext* ctx, CFG* cfg) {
+	number_function_operands(ctx, cfg);
+	compute_reverse_postorder(ctx, cfg);
+	compute_dominators(ctx, cfg);
+	find_natural_loops(ctx, cfg);
+
+	for (int j = 0; j < cfg->num_blocks; j++) {
+		BasicBlock* block = cfg->all_blocks[j];
+
+		bool has_block_sets = init_block_sets(ctx, cfg, block);
+		assert(has_block_sets);
+
+		populate_use_and_def_sets(ctx, cfg, block);
+	}
+
+	fixed_point_iteration(ctx, cfg);
+}
+
+// solves again over the same blocks and numbering after instructions were
+// removed; operands nothing refers to anymore keep their numbers
+void update_liveness(CompilerContext* ctx, CFG* cfg) {
+	for (int j = 0; j < cfg->num_blocks; j++) {
+		BasicBlock* block = cfg->all_blocks[j];
+		bitset_clear(block->use_set);
+		bitset_clear(block->def_set);
+		bitset_clear(block->in_set);
+		bitset_clear(block->out_set);
+
+		populate_use_and_def_sets(ctx, cfg, block);
+	}
+
+	fixed_point_iteration(ctx, cfg);
+}
+
 void live_analysis(CompilerContext* ctx) {
+	FunctionList* function_list = ctx->function->function_list;
 	for (int i = 0; i < function_list->size; i++) {
 		FunctionInfo* info = function_list->infos[i];
 		CFG* cfg = info->cfg;
 
-		for (int j = 0; j < cfg->num_blocks; j++) {
-			BasicBlock* block = cfg->all_blocks[j];
-			
-			bool has_block_sets = init_block_sets(ctx, block);
-			assert(has_block_sets);
-
-			populate_use_and_def_sets(ctx, block);
-			// printf("\nBlock \033[32m%d\033[0m\n", j);
-			// printf("Def: {");
-			// for (int k = 0; k < block->def_set->size; k++) {
-			// 	Operand* def_op = block->def_set->elements[k];
-			// 	bool last_op = (k == block->def_set->size - 1);
-			// 	if (def_op) {
-			// 		switch (def_op->kind) {
-			// 			case OP_SYMBOL: {
-			// 				if (last_op) {
-			// 					printf("%s", def_op->value.sym->name);
-			// 				} else {
-			// 					printf("%s, ", def_op->value.sym->name);
-			// 				}
-			// 				break;
-			// 			}
-			// 			default: {
-			// 				if (last_op) {
-			// 					printf("%s", def_op->value.label_name);
-			// 				} else {
-			// 					printf("%s, ", def_op->value.label_name);
-			// 				}
-			// 				break;
-			// 			}
-			// 		}
-			// 	}
-			// }
-			// printf("}\n");
-
-			// printf("Use: {");
-			// for (int u = 0; u < block->use_set->size; u++) {
-			// 	Operand* use_op = block->use_set->elements[u];
-			// 	bool last_op = (u == block->use_set->size - 1);
-			// 	if (use_op) {
-			// 		switch (use_op->kind) {
-			// 			case OP_SYMBOL: {
-			// 				if (last_op) {
-			// 					printf("%s", use_op->value.sym->name);
-			// 				} else {
-			// 					printf("%s, ", use_op->value.sym->name);
-			// 				}
-			// 				break;
-			// 			}
-
-			// 			default: {
-			// 				if (last_op) {
-			// 					printf("%s", use_op->value.label_name);
-			// 				} else {
-			// 					printf("%s, ", use_op->value.label_name);
-			// 				}
-			// 				break;
-			// 			}
-			// 		}
-			// 	}
-			// }
-			// printf("}\n\n");
+		if (ctx->no_dce) {
+			solve_liveness(ctx, cfg);
+		} else {
+			eliminate_dead_code(ctx, info);
+		}
+
+		if (ctx->verbose) {
+			fprintf(ctx->function->report, "liveness: %s: %d blocks, %d passes, %d block visits\n",
+				info->symbol->name, cfg->num_blocks, cfg->liveness_passes, cfg->liveness_visits);
 		}
 
-		fixed_point_iteration(ctx, cfg);
 		compute_instruction_live_out(ctx, cfg);
 		determine_next_use(ctx, cfg);
 	}
@@ -1459,19 +1678,16 @@ void add_bundle_to_interference_graph(CompilerContext* ctx, InterferenceGraph* g
 	graph->bundles[graph->size++] = bundle;
 }
 
-InterferenceBundle* create_inteference_bundle(CompilerContext* ctx, Operand* operand, BasicBlock* associated_block) {
+InterferenceBundle* create_interference_bundle(CompilerContext* ctx, Operand* operand, BasicBlock* associated_block) {
 	InterferenceBundle* bundle = arena_allocate(ctx->ir_arena, sizeof(InterferenceBundle));
 	if (!bundle) return NULL;
 
 	bundle->operand = operand;
 	bundle->associated_block = associated_block;
-	bundle->interferes_with = create_operand_set(ctx);
-	if (!bundle->interferes_with) return NULL;
-
 	return bundle;
 }
 
-InterferenceGraph* create_inteference_graph(CompilerContext* ctx) {
+InterferenceGraph* create_interference_graph(CompilerContext* ctx, OperandNumbering* numbering) {
 	InterferenceGraph* graph = arena_allocate(ctx->ir_arena, sizeof(InterferenceGraph));
 	if (!graph) return NULL;
 
@@ -1480,9 +1696,69 @@ InterferenceGraph* create_inteference_graph(CompilerContext* ctx) {
 	graph->bundles = arena_allocate(ctx->ir_arena, sizeof(InterferenceBundle*) * graph->capacity);
 	if (!graph->bundles) return NULL;
 
+	int n = numbering->count;
+	size_t matrix_bits = (size_t)n * (n - 1) / 2;
+	size_t matrix_words = matrix_bits / BITSET_WORD_BITS + 1;
+
+	graph->numbering = numbering;
+	graph->num_nodes = n;
+	graph->num_edges = 0;
+	graph->matrix = arena_allocate(ctx->ir_arena, sizeof(uint64_t) * matrix_words);
+	graph->degrees = arena_allocate(ctx->ir_arena, sizeof(int) * (n + 1));
+	graph->adjacency_capacity = arena_allocate(ctx->ir_arena, sizeof(int) * (n + 1));
+	graph->adjacency = arena_allocate(ctx->ir_arena, sizeof(int*) * (n + 1));
+	if (!graph->matrix || !graph->degrees || !graph->adjacency_capacity || !graph->adjacency) return NULL;
+
 	return graph;
 }
 
+size_t matrix_bit(int node1, int node2) {
+	int high = node1 > node2 ? node1 : node2;
+	int low = node1 > node2 ? node2 : node1;
+	return (size_t)high * (high - 1) / 2 + low;
+}
+
+bool interferes(InterferenceGraph* graph, int node1, int node2) {
+	if (node1 < 0 || node2 < 0 || node1 == node2) return false;
+
+	size_t bit = matrix_bit(node1, node2);
+	return (graph->matrix[bit / BITSET_WORD_BITS] >> (bit % BITSET_WORD_BITS)) & 1;
+}
+
+bool add_neighbour(CompilerContext* ctx, InterferenceGraph* graph, int node, int neighbour) {
+	if (graph->degrees[node] >= graph->adjacency_capacity[node]) {
+		int prev_capacity = graph->adjacency_capacity[node];
+		int new_capacity = prev_capacity ? prev_capacity * 2 : 8;
+
+		int* new_adjacency = prev_capacity ?
+			arena_reallocate(ctx->ir_arena, graph->adjacency[node], prev_capacity * sizeof(int), new_capacity * sizeof(int)) :
+			arena_allocate(ctx->ir_arena, new_capacity * sizeof(int));
+		if (!new_adjacency) return false;
+
+		graph->adjacency[node] = new_adjacency;
+		graph->adjacency_capacity[node] = new_capacity;
+	}
+
+	graph->adjacency[node][graph->degrees[node]++] = neighbour;
+	return true;
+}
+
+void add_interference(CompilerContext* ctx, InterferenceGraph* graph, int node1, int node2) {
+	if (node1 < 0 || node2 < 0 || node1 == node2) return;
+	if (interferes(graph, node1, node2)) return;
+
+	size_t bit = matrix_bit(node1, node2);
+	graph->matrix[bit / BITSET_WORD_BITS] |= (uint64_t)1 << (bit % BITSET_WORD_BITS);
+	graph->num_edges++;
+
+	bool added = add_neighbour(ctx, graph, node1, node2) && add_neighbour(ctx, graph, node2, node1);
+	assert(added);
+}
+
+int interference_node(InterferenceGraph* graph, Operand* operand) {
+	return find_operand_number(graph->numbering, operand);
+}
+
 void populate_interference_graph(CompilerContext* ctx, CFG* cfg, InterferenceGraph* graph) {
 	for (int i = 0; i < cfg->num_blocks; i++) {
 		BasicBlock* block = cfg->all_blocks[i];
@@ -1591,12 +1867,14 @@ void populate_interference_graph(CompilerContext* ctx, CFG* cfg, InterferenceGra
 
 							if ((next_instruction && next_instruction->op1) && 
 								next_instruction->kind == TAC_IF_FALSE &&
-								strcmp(next_instruction->op1->value.label_name, instruction->result->value.label_name) == 0) {
+								next_instruction->op1->value.label_name == instruction->result->value.label_name) {
 								instruction->result->precedes_conditional = true;
 							}
 						}
 						break;
 					}
+
+					case TAC_PHI: assert(false && "phis do not outlive ssa"); break;
 				}
 			}
 			
@@ -1608,14 +1886,14 @@ void populate_interference_graph(CompilerContext* ctx, CFG* cfg, InterferenceGra
 				case TAC_RETURN:
 				case TAC_ARG: {
 					if (instruction->op1) {
-						bundle = create_inteference_bundle(ctx, instruction->op1, block);
+						bundle = create_interference_bundle(ctx, instruction->op1, block);
 						instruction->op1->interference_bundle = bundle;
 					}
 					break;
 				}
 
 				default: {
-					bundle = create_inteference_bundle(ctx, instruction->result, block);
+					bundle = create_interference_bundle(ctx, instruction->result, block);
 					instruction->result->interference_bundle = bundle;
 					
 					break;	
@@ -1623,61 +1901,20 @@ void populate_interference_graph(CompilerContext* ctx, CFG* cfg, InterferenceGra
 			}
 			assert(bundle);
 
-			if (instruction->kind == TAC_ASSIGNMENT && instruction->op2 != OP_RETURN) {
-				bool ops_equal = operands_equal(instruction->result, instruction->op2);
-				if (!ops_equal) {
-					// switch (instruction->op2->kind) {
-					// 	case OP_SYMBOL: {
-					// 		printf("\033[31mWARNING\033[0m: '%s' interferes with assignment of ", instruction->op2->value.sym->name);
-					// 		break;
-					// 	}
-
-					// 	default: {
-					// 		printf("\033[31mWARNING\033[0m: '%s' interferes with assignment of ", instruction->op2->value.label_name);
-					// 		break;
-					// 	}
-					// }
-
-					// switch (instruction->result->kind) {
-					// 	case OP_SYMBOL: {
-					// 		printf("'%s'\n", instruction->result->value.sym->name);
-					// 		break;
-					// 	}
-
-					// 	default: {
-					// 		printf("'%s'\n", instruction->result->value.label_name);
-					// 		break;
-					// 	}
-					// }
-					add_to_operand_set(ctx, bundle->interferes_with, instruction->op2);
-					InterferenceBundle* prev_bundle = instruction->op2->interference_bundle;
-					if (prev_bundle) {
-						add_to_operand_set(ctx, prev_bundle->interferes_with, instruction->result);
-					}
-				}
-			}
+			// linear scan only needs the register constraints and bundles
+			if (!graph) continue;
+			int node = interference_node(graph, bundle->operand);
 
 			for (int k = 0; k < instruction->live_out->size; k++) {
-				bool last_op = (k == instruction->live_out->size - 1); 
+				Operand* live_op = instruction->live_out->elements[k];
+				if (live_op->precedes_conditional) continue;
 
-				if (instruction->live_out->elements[k]->precedes_conditional) continue;
-				switch (instruction->kind) {
-					case TAC_ARG: {
-						bool ops_equal = operands_equal(instruction->op1, instruction->live_out->elements[k]);
-						if (!ops_equal) {
-							add_to_operand_set(ctx, bundle->interferes_with, instruction->live_out->elements[k]);
-						}
-						break;
-					}
+				// a copy whose source dies here leaves both in one register,
+				// which is what lets the allocator coalesce them
+				if (instruction->kind == TAC_ASSIGNMENT && instruction->source_dies &&
+					interference_node(graph, live_op) == interference_node(graph, instruction->op2)) continue;
 
-					default: {
-						bool ops_equal = operands_equal(instruction->result, instruction->live_out->elements[k]);
-						if (!ops_equal) {
-							add_to_operand_set(ctx, bundle->interferes_with, instruction->live_out->elements[k]); 
-						} 
-						break;
-					}
-				}
+				add_interference(ctx, graph, node, interference_node(graph, live_op));
 			}					
 			add_bundle_to_interference_graph(ctx, graph, bundle);	 
 		}
@@ -1685,11 +1922,14 @@ void populate_interference_graph(CompilerContext* ctx, CFG* cfg, InterferenceGra
 }
 
 void populate_interference_graphs(CompilerContext* ctx) {
+	FunctionList* function_list = ctx->function->function_list;
 	for (int i = 0; i < function_list->size; i++) {
 		FunctionInfo* info = function_list->infos[i];
 		// printf("\nBundles for function \033[32m%s\033[0m\n", info->symbol->name);
-		info->graph = create_inteference_graph(ctx);
-		assert(info->graph);
+		if (!ctx->linear_scan) {
+			info->graph = create_interference_graph(ctx, info->cfg->numbering);
+			assert(info->graph);
+		}
 		populate_interference_graph(ctx, info->cfg, info->graph);	
 	}
 }
@@ -1726,30 +1966,34 @@ bool is_operand_label_or_symbol(Operand* op) {
 FunctionList* build_cfg(CompilerContext* ctx, TACTable* instructions) {
 	if (!instructions) return NULL;
 
-	function_list = create_function_list(ctx);
-	leaders_list = create_tac_leaders(ctx);
-	assert(function_list && leaders_list.leaders);
+	ctx->function->function_list = create_function_list(ctx);
+	ctx->function->leaders_list = create_tac_leaders(ctx);
+	assert(ctx->function->function_list && ctx->function->leaders_list.leaders);
 	
 	mark_function_boundaries(ctx, instructions);
 	find_leaders(ctx, instructions);
 	make_function_cfgs(ctx, instructions);
 	link_function_cfgs(ctx);
+	optimize_function_cfgs(ctx);
  
 	live_analysis(ctx);
+	if (ctx->dump_cfg) dump_function_cfgs(ctx);
 	populate_interference_graphs(ctx);
 
-	// emit_leaders();
-	// emit_blocks();
-	return function_list;
+	// emit_leaders(ctx);
+	// emit_blocks(ctx);
+	return ctx->function->function_list;
 }
 
-void emit_leaders() {
-	for (int i = 0; i < leaders_list.size; i++) {
-		printf("Leader index: \033[32m%d\033[0m\n", leaders_list.leaders[i]);
+void emit_leaders(CompilerContext* ctx) {
+	TACLeaders* leaders_list = &ctx->function->leaders_list;
+	for (int i = 0; i < leaders_list->size; i++) {
+		printf("Leader index: \033[32m%d\033[0m\n", leaders_list->leaders[i]);
 	}
 }
 
-void emit_blocks() {
+void emit_blocks(CompilerContext* ctx) {
+	FunctionList* function_list = ctx->function->function_list;
 	for (int i = 0; i < function_list->size; i++) {
 		printf("\nFunction: \033[32m%s\033[0m\n", function_list->infos[i]->symbol->name);
 		if (function_list->infos[i]->cfg) {
@@ -12,6 +12,8 @@
 #define INIT_LEADERS_CAPACITY 100
 #define INIT_LIVENESS_TABLE_CAPACITY 50
 #define INIT_INTERFERENCE_BUNDLE_CAPACITY 50
+#define INIT_OPERAND_NUMBERING_CAPACITY 64
+#define BITSET_WORD_BITS 64
 
 typedef struct {
 	int size;
@@ -38,6 +40,24 @@ typedef struct {
 	int capacity;
 } LivenessTable;
 
+// word-packed set over a function's dense operand numbering
+typedef struct {
+	int num_words;
+	uint64_t* words;
+} BitSet;
+
+// maps each variable of a function (symbol or interned label) to a dense
+// index, and each index back to the operand that stands for it
+typedef struct {
+	int count;
+	int capacity;
+	void** keys;
+	operand_t* kinds;
+	int* indices;
+	Operand** operands;
+	int operands_capacity;
+} OperandNumbering;
+
 typedef enum {
 	REG,
 	STACK
@@ -112,6 +132,8 @@ typedef struct {
 	Reload* reloads;
 } ReloadSchedule;
 
+typedef struct Loop Loop;
+
 typedef struct BasicBlock {
 	int id;
 	int num_instructions;
@@ -123,15 +145,29 @@ typedef struct BasicBlock {
 	int num_successors_capacity;
 	
 	bool visited;
+	bool on_worklist;
+	int rpo_index;
+	int loop_depth; // number of loops around the block, 0 outside any
+	Loop* loop; // the innermost of them
+
+	// dominator tree; idom is NULL for the entry and unreachable blocks.
+	// a dominates b exactly when b's preorder number falls in a's range
+	struct BasicBlock* idom;
+	struct BasicBlock** dom_children;
+	int num_dom_children;
+	int dom_preorder;
+	int dom_last_descendant;
+	struct BasicBlock** frontier;
+	int num_frontier;
 	
 	TACInstruction** instructions;
 	struct BasicBlock** predecessors;
 	struct BasicBlock** successors;
 
-	OperandSet* use_set;
-	OperandSet* def_set;
-	OperandSet* in_set;
-	OperandSet* out_set;
+	BitSet* use_set;
+	BitSet* def_set;
+	BitSet* in_set;
+	BitSet* out_set;
 
 	StructuredArgs* sargs;
 	SpillSchedule* spill_schedule; // for standard emission of push instructions
@@ -139,25 +175,54 @@ typedef struct BasicBlock {
 	ReloadBundle* reload_bundle; // for emission of pop instructions for callee regs in correct order
 } BasicBlock;
 
+// a natural loop: the header and every block that reaches one of its back
+// edges without passing through it. back edges into the same header make
+// one loop
+struct Loop {
+	BasicBlock* header;
+	BasicBlock** blocks; // header first
+	int num_blocks;
+	Loop* parent;
+	int depth;
+};
+
 typedef struct {
 	BasicBlock* head;
 	int num_blocks;
 	int blocks_capacity;
 	BasicBlock** all_blocks;
+	BasicBlock** rpo; // reachable blocks in reverse postorder, then unreachable ones
 	LivenessTable* table;
+	OperandNumbering* numbering;
+	int liveness_passes;
+	int liveness_visits;
+	int unreachable_blocks; // removed by dead code elimination
+	int dead_instructions;
+	Loop** loops; // enclosing loops before the loops they contain
+	int num_loops;
 	ArgumentList* args
 } CFG;
 
 typedef struct {
 	Operand* operand;
-	OperandSet* interferes_with;
 	BasicBlock* associated_block;
 } InterferenceBundle;
 
+// nodes are the function's numbered operands; edges live both in a lower
+// triangular bit matrix, for constant time queries, and in per-node
+// adjacency arrays, for walking neighbours
 typedef struct {
 	int size;
 	int capacity;
 	InterferenceBundle** bundles;
+
+	OperandNumbering* numbering;
+	int num_nodes;
+	int num_edges;
+	uint64_t* matrix;
+	int* degrees;
+	int* adjacency_capacity;
+	int** adjacency;
 } InterferenceGraph;
 
 typedef struct {
@@ -194,7 +259,10 @@ void compute_instruction_live_out(CompilerContext* ctx, CFG* cfg);
 
 void add_bundle_to_interference_graph(CompilerContext* ctx, InterferenceGraph* graph, InterferenceBundle* bundle);
 InterferenceBundle* create_interference_bundle(CompilerContext* ctx, Operand* operand, BasicBlock* associated_block);
-InterferenceGraph* create_interference_graph(CompilerContext* ctx);
+InterferenceGraph* create_interference_graph(CompilerContext* ctx, OperandNumbering* numbering);
+bool interferes(InterferenceGraph* graph, int node1, int node2);
+void add_interference(CompilerContext* ctx, InterferenceGraph* graph, int node1, int node2);
+int interference_node(InterferenceGraph* graph, Operand* operand);
 
 void build_interference_graph(CompilerContext* ctx);
 
@@ -207,22 +275,38 @@ bool add_liveinfo_to_liveness_table(CompilerContext* ctx, LivenessTable* table,
 int get_operand_index(OperandSet* op_set, Operand* operand);
 bool operands_equal(Operand* op1, Operand* op2);
 bool contains_operand(OperandSet* op_set, Operand* operand);
-OperandSet* copy_set(CompilerContext* ctx, OperandSet* original_set);
-void union_sets(CompilerContext* ctx, OperandSet* dest, OperandSet* src);
-bool sets_equal(OperandSet* set1, OperandSet* set2);
-OperandSet* difference_sets(CompilerContext* ctx, OperandSet* set1, OperandSet* set2);
-void populate_and_use_defs(CompilerContext* ctx, BasicBlock* block);
-bool init_block_sets(CompilerContext* ctx, BasicBlock* block);
+
+BitSet* create_bitset(CompilerContext* ctx, int num_bits);
+void bitset_add(BitSet* set, int index);
+void bitset_remove(BitSet* set, int index);
+bool bitset_contains(BitSet* set, int index);
+void bitset_clear(BitSet* set);
+void bitset_copy(BitSet* dest, BitSet* src);
+void bitset_union(BitSet* dest, BitSet* src);
+bool bitset_equal(BitSet* set1, BitSet* set2);
+OperandSet* bitset_to_operand_set(CompilerContext* ctx, OperandNumbering* numbering, BitSet* set);
+
+OperandNumbering* create_operand_numbering(CompilerContext* ctx);
+void* operand_key(Operand* operand);
+unsigned int hash_operand_key(void* key, operand_t kind, int capacity);
+int find_operand_number(OperandNumbering* numbering, Operand* operand);
+int number_operand(CompilerContext* ctx, OperandNumbering* numbering, Operand* operand);
+void number_function_operands(CompilerContext* ctx, CFG* cfg);
+
+void populate_use_and_def_sets(CompilerContext* ctx, CFG* cfg, BasicBlock* block);
+bool init_block_sets(CompilerContext* ctx, CFG* cfg, BasicBlock* block);
+void compute_reverse_postorder(CompilerContext* ctx, CFG* cfg);
+void fixed_point_iteration(CompilerContext* ctx, CFG* cfg);
+void solve_liveness(CompilerContext* ctx, CFG* cfg);
+void update_liveness(CompilerContext* ctx, CFG* cfg);
 
 
 void add_to_operand_set(CompilerContext* ctx, OperandSet* op_set, Operand* operand);
-void populate_and_use_defs(CompilerContext* ctx, BasicBlock* block);
-bool init_block_sets(CompilerContext* ctx, BasicBlock* block);
 bool is_operand_label_or_symbol(Operand* op);
 void emit_liveness_info(TACInstruction* instruction);
 
-void emit_blocks();
-void emit_leaders();
+void emit_blocks(CompilerContext* ctx);
+void emit_leaders(CompilerContext* ctx);
 
 BasicBlock* find_matching_label_block(CFG* cfg, char* target_name);
 int find_label_index(TACTable* instructions, char* target_name, int current_index);
@@ -247,6 +331,7 @@ bool found_leader(TACInstruction* instruction);
 void add_edges(CompilerContext* ctx, CFG* cfg, int index, BasicBlock* block);
 bool make_function_cfgs(CompilerContext* ctx, TACTable* instructions);
 void link_function_cfgs(CompilerContext* ctx);
+void optimize_function_cfgs(CompilerContext* ctx);
 TACLeaders crete_tac_leaders(CompilerContext* ctx);
 
 void build_function_cfg(CompilerContext* ctx, TACTable* instructions, FunctionInfo* info);
@@ -258,6 +343,9 @@ bool add_function_info_to_list(CompilerContext* ctx, FunctionInfo* info);
 FunctionList* create_function_list(CompilerContext* ctx);
 
 bool add_block_to_cfg(CompilerContext* ctx, CFG* cfg, BasicBlock* block);
+bool insert_block_into_cfg(CompilerContext* ctx, CFG* cfg, int index, BasicBlock* block);
+bool add_instruction_to_block(CompilerContext* ctx, BasicBlock* block, TACInstruction* instruction);
+bool insert_instruction_into_block(CompilerContext* ctx, BasicBlock* block, int index, TACInstruction* instruction);
 BasicBlock* create_basic_block(CompilerContext* ctx);
 CFG* create_cfg(CompilerContext* ctx);
 FunctionList* build_cfg(CompilerContext* ctx, TACTable* instructions);
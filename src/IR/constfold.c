@@ -0,0 +1,457 @@
+#include "constfold.h"
+#include "assert.h"
+#include "backend.h"
+#include <limits.h>
+
+// sparse conditional constant propagation over one function's TAC, before
+// it is cut into blocks. temporaries are defined once, so their values are
+// exact; symbols are tracked on entry to every label and merged over all
+// the jumps into it, and an IF_FALSE on a known condition only lets flow
+// along the edge it takes, so code behind a decided branch adds nothing to
+// the merge
+
+ConstantFolder* create_constant_folder(CompilerContext* ctx, TACTable* table) {
+	ConstantFolder* folder = arena_allocate(ctx->ir_arena, sizeof(ConstantFolder));
+	if (!folder) {
+		perror("In 'create_constant_folder', unable to allocate space for constant folder\n");
+		return NULL;
+	}
+
+	folder->table = table;
+	folder->numbering = create_operand_numbering(ctx);
+	if (!folder->numbering) return NULL;
+
+	folder->operand_numbers = arena_allocate(ctx->ir_arena, sizeof(int) * 3 * table->size);
+	if (!folder->operand_numbers) return NULL;
+
+	int num_labels = 0;
+	for (int i = 0; i < table->size; i++) {
+		TACInstruction* tac = table->tacs[i];
+		folder->operand_numbers[3 * i] = number_operand(ctx, folder->numbering, tac->result);
+		folder->operand_numbers[3 * i + 1] = number_operand(ctx, folder->numbering, tac->op1);
+		folder->operand_numbers[3 * i + 2] = number_operand(ctx, folder->numbering, tac->op2);
+		if (tac->kind == TAC_LABEL) num_labels++;
+	}
+
+	int count = folder->numbering->count;
+	folder->values = arena_allocate(ctx->ir_arena, sizeof(LatticeValue) * (count + 1));
+	folder->defined_in = arena_allocate(ctx->ir_arena, sizeof(int) * (count + 1));
+	folder->is_symbol = arena_allocate(ctx->ir_arena, sizeof(bool) * (count + 1));
+	folder->symbols = arena_allocate(ctx->ir_arena, sizeof(int) * (count + 1));
+	if (!folder->values || !folder->defined_in || !folder->is_symbol || !folder->symbols) return NULL;
+
+	// symbols that are not tracked stay varying, and nothing overwrites them
+	folder->num_symbols = 0;
+	for (int i = 0; i < count; i++) {
+		Operand* op = folder->numbering->operands[i];
+		folder->defined_in[i] = -1;
+		folder->is_symbol[i] = op->kind == OP_SYMBOL;
+
+		if (is_local_symbol(op)) {
+			folder->symbols[folder->num_symbols++] = i;
+		} else if (op->kind == OP_SYMBOL) {
+			folder->values[i].state = LATTICE_VARYING;
+		}
+	}
+
+	folder->label_capacity = 2;
+	while (folder->label_capacity < 2 * (num_labels + 1)) folder->label_capacity *= 2;
+	folder->label_keys = arena_allocate(ctx->ir_arena, sizeof(char*) * folder->label_capacity);
+	folder->label_regions = arena_allocate(ctx->ir_arena, sizeof(int) * folder->label_capacity);
+	folder->regions = arena_allocate(ctx->ir_arena, sizeof(FoldRegion) * (num_labels + 1));
+	if (!folder->label_keys || !folder->label_regions || !folder->regions) return NULL;
+
+	folder->num_regions = 1;
+	folder->regions[0].start = found_function(table->tacs[0]) ? 1 : 0;
+	for (int i = 0; i < table->size; i++) {
+		TACInstruction* tac = table->tacs[i];
+		if (tac->kind != TAC_LABEL) continue;
+
+		folder->regions[folder->num_regions].start = i;
+		add_label_region(folder, tac->result->value.label_name, folder->num_regions++);
+	}
+
+	// the entry region always gets its symbols, so parameters start out varying
+	folder->track_symbols = (long)folder->num_regions * folder->num_symbols <= MAX_FOLD_REGION_ENTRIES;
+	int tracked = folder->track_symbols ? folder->num_regions : 1;
+	LatticeValue* entries = arena_allocate(ctx->ir_arena, sizeof(LatticeValue) * ((long)tracked * folder->num_symbols + 1));
+	if (!entries) return NULL;
+
+	for (int i = 0; i < tracked; i++) {
+		folder->regions[i].symbols = entries + (long)i * folder->num_symbols;
+	}
+
+	for (int k = 0; k < folder->num_symbols; k++) {
+		Operand* op = folder->numbering->operands[folder->symbols[k]];
+		if (op->value.sym->kind == SYMBOL_PARAM) {
+			folder->regions[0].symbols[k].state = LATTICE_VARYING;
+		}
+	}
+
+	folder->folded = 0;
+	folder->branches = 0;
+	folder->removed = 0;
+	return folder;
+}
+
+void add_label_region(ConstantFolder* folder, char* label, int region) {
+	unsigned int slot = hash_operand_key(label, OP_LABEL, folder->label_capacity);
+	while (folder->label_keys[slot]) {
+		slot = (slot + 1) & (folder->label_capacity - 1);
+	}
+	folder->label_keys[slot] = label;
+	folder->label_regions[slot] = region;
+}
+
+int find_label_region(ConstantFolder* folder, char* label) {
+	unsigned int slot = hash_operand_key(label, OP_LABEL, folder->label_capacity);
+	while (folder->label_keys[slot]) {
+		if (folder->label_keys[slot] == label) return folder->label_regions[slot];
+		slot = (slot + 1) & (folder->label_capacity - 1);
+	}
+	return -1;
+}
+
+// globals may change under any call and arrays are only reached through
+// their elements, so neither is tracked
+bool is_local_symbol(Operand* op) {
+	if (!op || op->kind != OP_SYMBOL || !op->value.sym || !op->value.sym->type) return false;
+
+	Symbol* sym = op->value.sym;
+	if (sym->kind == SYMBOL_GLOBAL) return false;
+
+	switch (sym->type->kind) {
+		case TYPE_INTEGER:
+		case TYPE_BOOL:
+		case TYPE_CHAR: return true;
+		default: return false;
+	}
+}
+
+bool is_foldable(tac_t kind) {
+	switch (kind) {
+		case TAC_ADD:
+		case TAC_SUB:
+		case TAC_MUL:
+		case TAC_DIV:
+		case TAC_MODULO:
+		case TAC_LESS:
+		case TAC_GREATER:
+		case TAC_LESS_EQUAL:
+		case TAC_GREATER_EQUAL:
+		case TAC_EQUAL:
+		case TAC_NOT_EQUAL:
+		case TAC_NOT:
+		case TAC_LOGICAL_AND:
+		case TAC_LOGICAL_OR:
+		case TAC_UNARY_ADD:
+		case TAC_UNARY_SUB: return true;
+		default: return false;
+	}
+}
+
+// computes what the code codegen emits for kind would: registers are 64 bits
+// wide and wrap, div and modulo are unsigned, comparisons are signed, not
+// flips the low bit and tests the rest, and || compares each side with 1
+bool fold_operation(tac_t kind, long a, long b, long* result) {
+	unsigned long x = a, y = b;
+	switch (kind) {
+		case TAC_ADD: *result = (long)(x + y); break;
+		case TAC_SUB: *result = (long)(x - y); break;
+		case TAC_MUL: *result = (long)(x * y); break;
+		case TAC_DIV: {
+			if (y == 0) return false;
+			*result = (long)(x / y);
+			break;
+		}
+		case TAC_MODULO: {
+			if (y == 0) return false;
+			*result = (long)(x % y);
+			break;
+		}
+		case TAC_LESS: *result = a < b; break;
+		case TAC_GREATER: *result = a > b; break;
+		case TAC_LESS_EQUAL: *result = a <= b; break;
+		case TAC_GREATER_EQUAL: *result = a >= b; break;
+		case TAC_EQUAL: *result = a == b; break;
+		case TAC_NOT_EQUAL: *result = a != b; break;
+		case TAC_NOT: *result = (x ^ 1) != 0; break;
+		case TAC_LOGICAL_AND: *result = a != 0 && b != 0; break;
+		case TAC_LOGICAL_OR: *result = a == 1 || b == 1; break;
+		case TAC_UNARY_ADD: *result = a; break;
+		case TAC_UNARY_SUB: *result = (long)(0 - x); break;
+		default: return false;
+	}
+	return true;
+}
+
+LatticeValue meet_values(LatticeValue a, LatticeValue b) {
+	if (a.state == LATTICE_UNDEFINED) return b;
+	if (b.state == LATTICE_UNDEFINED) return a;
+	if (a.state == LATTICE_CONSTANT && b.state == LATTICE_CONSTANT && a.value == b.value) return a;
+
+	LatticeValue varying = {.state = LATTICE_VARYING};
+	return varying;
+}
+
+// number is op's from operand_numbers. a temporary is read in the stretch of
+// code that defines it; a read from anywhere else is not trusted
+LatticeValue operand_value(ConstantFolder* folder, Operand* op, int number, int region) {
+	LatticeValue value = {.state = LATTICE_VARYING};
+	if (op && op->kind == OP_INT_LITERAL) {
+		value.state = LATTICE_CONSTANT;
+		value.value = op->value.int_val;
+		return value;
+	}
+
+	if (number == -1) return value;
+	if (folder->is_symbol[number] || folder->defined_in[number] == region) return folder->values[number];
+	return value;
+}
+
+void set_operand_value(ConstantFolder* folder, int number, LatticeValue value, int region) {
+	if (number == -1) return;
+	if (folder->is_symbol[number] && !is_local_symbol(folder->numbering->operands[number])) return;
+
+	folder->values[number] = value;
+	folder->defined_in[number] = region;
+}
+
+LatticeValue evaluate_instruction(ConstantFolder* folder, TACInstruction* tac, int* numbers, int region) {
+	LatticeValue a = operand_value(folder, tac->op1, numbers[1], region);
+	LatticeValue b = {.state = LATTICE_CONSTANT, .value = 0};
+	if (tac->op2) {
+		b = operand_value(folder, tac->op2, numbers[2], region);
+	}
+
+	LatticeValue result = {.state = LATTICE_VARYING};
+	if (a.state == LATTICE_VARYING || b.state == LATTICE_VARYING) return result;
+	if (a.state == LATTICE_UNDEFINED || b.state == LATTICE_UNDEFINED) {
+		result.state = LATTICE_UNDEFINED;
+		return result;
+	}
+
+	if (fold_operation(tac->kind, a.value, b.value, &result.value)) {
+		result.state = LATTICE_CONSTANT;
+	}
+	return result;
+}
+
+// merges the symbols' values where the walk is into the region's entry and
+// queues the region if that lowered any of them
+void flow_to_region(ConstantFolder* folder, int region) {
+	if (region == -1) return;
+
+	FoldRegion* target = &folder->regions[region];
+	bool changed = !target->reached;
+	target->reached = true;
+
+	if (folder->track_symbols) {
+		for (int k = 0; k < folder->num_symbols; k++) {
+			LatticeValue* entry = &target->symbols[k];
+			if (entry->state == LATTICE_VARYING) continue;
+
+			LatticeValue merged = meet_values(*entry, folder->values[folder->symbols[k]]);
+			if (merged.state != entry->state || merged.value != entry->value) {
+				*entry = merged;
+				changed = true;
+			}
+		}
+	}
+
+	if (changed) target->queued = true;
+}
+
+void rewrite_as_constant(CompilerContext* ctx, TACInstruction* tac, long value) {
+	OperandValue literal = {.int_val = (int)value};
+	tac->op1 = create_operand(ctx, OP_INT_LITERAL, literal, TYPE_INTEGER);
+	assert(tac->op1);
+
+	tac->op2 = NULL;
+	tac->kind = tac->result->type == TYPE_BOOL ? TAC_BOOL : TAC_INTEGER;
+}
+
+// runs from the region's first instruction to the next label or jump. the
+// rewriting walk comes once the entries have settled and turns what it
+// finds constant into constant loads; a literal is a sign extended 32 bit
+// immediate, so a value outside that range is left to be computed
+void walk_region(CompilerContext* ctx, ConstantFolder* folder, int region, bool rewrite) {
+	FoldRegion* current = &folder->regions[region];
+	TACTable* table = folder->table;
+
+	for (int k = 0; k < folder->num_symbols; k++) {
+		LatticeValue varying = {.state = LATTICE_VARYING};
+		folder->values[folder->symbols[k]] = current->symbols ? current->symbols[k] : varying;
+	}
+
+	int i = region == 0 ? current->start : current->start + 1;
+	for (; i < table->size; i++) {
+		TACInstruction* tac = table->tacs[i];
+		if (!tac) continue;
+
+		int* numbers = &folder->operand_numbers[3 * i];
+		switch (tac->kind) {
+			case TAC_LABEL: {
+				if (!rewrite) flow_to_region(folder, find_label_region(folder, tac->result->value.label_name));
+				return;
+			}
+
+			case TAC_GOTO: {
+				if (!rewrite) flow_to_region(folder, find_label_region(folder, tac->result->value.label_name));
+				return;
+			}
+
+			case TAC_RETURN: return;
+
+			case TAC_IF_FALSE: {
+				LatticeValue condition = operand_value(folder, tac->op1, numbers[1], region);
+				int target = find_label_region(folder, tac->op2->value.label_name);
+
+				if (condition.state != LATTICE_CONSTANT) {
+					if (!rewrite) flow_to_region(folder, target);
+					break;
+				}
+
+				if (condition.value != 0) {
+					if (rewrite) {
+						table->tacs[i] = NULL;
+						folder->branches++;
+					}
+					break;
+				}
+
+				if (rewrite) {
+					tac->kind = TAC_GOTO;
+					tac->result = tac->op2;
+					tac->op1 = NULL;
+					tac->op2 = NULL;
+					folder->branches++;
+				} else {
+					flow_to_region(folder, target);
+				}
+				return;
+			}
+
+			case TAC_CHAR:
+			case TAC_BOOL:
+			case TAC_INTEGER: {
+				LatticeValue value = {.state = LATTICE_CONSTANT, .value = tac->op1->value.int_val};
+				set_operand_value(folder, numbers[0], value, region);
+				break;
+			}
+
+			case TAC_ASSIGNMENT: {
+				LatticeValue value = {.state = LATTICE_VARYING};
+				if (tac->op2 && tac->op2->kind != OP_RETURN) {
+					value = operand_value(folder, tac->op2, numbers[2], region);
+				}
+				set_operand_value(folder, numbers[0], value, region);
+				break;
+			}
+
+			case TAC_PARAM: {
+				LatticeValue varying = {.state = LATTICE_VARYING};
+				set_operand_value(folder, numbers[1], varying, region);
+				break;
+			}
+
+			default: {
+				LatticeValue value = {.state = LATTICE_VARYING};
+				if (is_foldable(tac->kind)) {
+					value = evaluate_instruction(folder, tac, numbers, region);
+				}
+				set_operand_value(folder, numbers[0], value, region);
+
+				if (rewrite && value.state == LATTICE_CONSTANT && value.value >= INT_MIN && value.value <= INT_MAX) {
+					rewrite_as_constant(ctx, tac, value.value);
+					folder->folded++;
+				}
+				break;
+			}
+		}
+	}
+}
+
+// drops the IF_FALSEs the rewrite took out and the constant loads nothing
+// reads any more, which folding leaves behind for every operand it used
+void remove_dead_constants(ConstantFolder* folder) {
+	TACTable* table = folder->table;
+	int* uses = folder->defined_in;
+	for (int i = 0; i < folder->numbering->count; i++) {
+		uses[i] = 0;
+	}
+
+	for (int i = 0; i < table->size; i++) {
+		TACInstruction* tac = table->tacs[i];
+		if (!tac) continue;
+
+		int op1 = find_operand_number(folder->numbering, tac->op1);
+		int op2 = find_operand_number(folder->numbering, tac->op2);
+		if (op1 != -1) uses[op1]++;
+		if (op2 != -1) uses[op2]++;
+
+		// these store through the address in result
+		if (tac->kind == TAC_STORE || tac->kind == TAC_DEREFERENCE_AND_ASSIGN) {
+			int result = find_operand_number(folder->numbering, tac->result);
+			if (result != -1) uses[result]++;
+		}
+	}
+
+	int kept = 0;
+	for (int i = 0; i < table->size; i++) {
+		TACInstruction* tac = table->tacs[i];
+		if (tac && (tac->kind == TAC_INTEGER || tac->kind == TAC_BOOL || tac->kind == TAC_CHAR) && tac->result->kind != OP_SYMBOL) {
+			int result = find_operand_number(folder->numbering, tac->result);
+			if (result != -1 && uses[result] == 0) tac = NULL;
+		}
+
+		if (tac) {
+			table->tacs[kept++] = tac;
+		} else {
+			folder->removed++;
+		}
+	}
+
+	// build_cfg reads up to the entry one past the last
+	for (int i = kept; i < table->size; i++) {
+		table->tacs[i] = NULL;
+	}
+	table->size = kept;
+}
+
+// table holds the one function build_function_tacs lowered; returns how
+// many instructions it removed
+int fold_constants(CompilerContext* ctx, TACTable* table) {
+	if (!table || table->size == 0) return 0;
+
+	ConstantFolder* folder = create_constant_folder(ctx, table);
+	assert(folder);
+
+	folder->regions[0].reached = true;
+	folder->regions[0].queued = true;
+
+	bool walked = true;
+	while (walked) {
+		walked = false;
+		for (int i = 0; i < folder->num_regions; i++) {
+			if (!folder->regions[i].queued) continue;
+
+			folder->regions[i].queued = false;
+			walk_region(ctx, folder, i, false);
+			walked = true;
+		}
+	}
+
+	for (int i = 0; i < folder->num_regions; i++) {
+		if (folder->regions[i].reached) {
+			walk_region(ctx, folder, i, true);
+		}
+	}
+	remove_dead_constants(folder);
+
+	if (ctx->verbose && found_function(table->tacs[0])) {
+		fprintf(ctx->function->report, "fold: %s: %d folded, %d branches decided, %d instructions removed\n",
+			table->tacs[0]->result->value.sym->name, folder->folded, folder->branches, folder->removed);
+	}
+	return folder->removed;
+}
@@ -0,0 +1,71 @@
+#ifndef CONSTFOLD_H
+#define CONSTFOLD_H
+
+#include "compilercontext.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+
+// regions beyond this many symbol entries in total keep no state across
+// labels, so a function with thousands of both stays linear
+#define MAX_FOLD_REGION_ENTRIES (1 << 22)
+
+typedef enum {
+	LATTICE_UNDEFINED, // no definition has reached it yet
+	LATTICE_CONSTANT,
+	LATTICE_VARYING
+} lattice_t;
+
+typedef struct {
+	lattice_t state;
+	long value;
+} LatticeValue;
+
+// a stretch of code starting at the function's first instruction or at a
+// label, with the values the symbols have on every path into it so far
+typedef struct {
+	int start;
+	bool reached;
+	bool queued;
+	LatticeValue* symbols; // by position in ConstantFolder.symbols
+} FoldRegion;
+
+typedef struct {
+	TACTable* table;
+	OperandNumbering* numbering;
+	int* operand_numbers; // result, op1 and op2's numbers for each instruction
+	LatticeValue* values; // by operand number; a symbol's is its value where the walk is
+	int* defined_in; // region a temporary was last defined in, by operand number
+	bool* is_symbol;
+
+	int* symbols; // operand numbers of the local symbols
+	int num_symbols;
+	bool track_symbols; // false when the regions would hold too many entries
+
+	FoldRegion* regions;
+	int num_regions;
+	char** label_keys; // label name to region, open addressing
+	int* label_regions;
+	int label_capacity;
+
+	int folded; // instructions turned into constant loads
+	int branches; // IF_FALSEs turned into a GOTO or dropped
+	int removed;
+} ConstantFolder;
+
+ConstantFolder* create_constant_folder(CompilerContext* ctx, TACTable* table);
+void add_label_region(ConstantFolder* folder, char* label, int region);
+int find_label_region(ConstantFolder* folder, char* label);
+bool is_local_symbol(Operand* op);
+bool is_foldable(tac_t kind);
+bool fold_operation(tac_t kind, long a, long b, long* result);
+LatticeValue meet_values(LatticeValue a, LatticeValue b);
+LatticeValue operand_value(ConstantFolder* folder, Operand* op, int number, int region);
+void set_operand_value(ConstantFolder* folder, int number, LatticeValue value, int region);
+LatticeValue evaluate_instruction(ConstantFolder* folder, TACInstruction* tac, int* numbers, int region);
+void flow_to_region(ConstantFolder* folder, int region);
+void rewrite_as_constant(CompilerContext* ctx, TACInstruction* tac, long value);
+void walk_region(CompilerContext* ctx, ConstantFolder* folder, int region, bool rewrite);
+void remove_dead_constants(ConstantFolder* folder);
+int fold_constants(CompilerContext* ctx, TACTable* table);
+
+#endif
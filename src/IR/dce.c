@@ -0,0 +1,255 @@
+#include "dce.h"
+#include "constfold.h"
+#include "assert.h"
+#include "backend.h"
+
+// dead code elimination on a function's linked CFG, before its liveness is
+// handed to the register allocator. blocks the entry cannot reach go first,
+// ahead of ssa in 'optimize_function_cfgs'. instructions without side
+// effects whose result is dead on the way out of them go here, using the
+// same liveness the allocator sees. removing one can leave the values it
+// read dead in blocks above it: the sweep catches those outside loops
+// itself, and liveness is solved again for the rest until a sweep finds
+// nothing
+
+void remove_edges_from(BasicBlock* block) {
+	for (int i = 0; i < block->num_successors; i++) {
+		BasicBlock* successor = block->successors[i];
+
+		int kept = 0;
+		for (int j = 0; j < successor->num_predecessors; j++) {
+			if (successor->predecessors[j] != block) {
+				successor->predecessors[kept++] = successor->predecessors[j];
+			}
+		}
+		successor->num_predecessors = kept;
+	}
+	block->num_successors = 0;
+}
+
+// 'return' followed by the 'goto' out of an if/else stays in one block, and
+// that goto adds an edge the return never takes
+void truncate_after_return(BasicBlock* block) {
+	for (int i = 0; i < block->num_instructions - 1; i++) {
+		TACInstruction* tac = block->instructions[i];
+		if (tac && tac->kind == TAC_RETURN) {
+			block->num_instructions = i + 1;
+			remove_edges_from(block);
+			return;
+		}
+	}
+}
+
+// the edges come from each block's last instruction, so check the
+// instructions themselves: every jump in a reachable block, and its fall
+// through, has to land on a block that stays
+bool lands_on_reachable_block(CFG* cfg, int index) {
+	BasicBlock* block = cfg->all_blocks[index];
+	for (int i = 0; i < block->num_instructions; i++) {
+		TACInstruction* tac = block->instructions[i];
+		if (!tac) continue;
+
+		char* target = NULL;
+		if (tac->kind == TAC_GOTO) target = tac->result->value.label_name;
+		if (tac->kind == TAC_IF_FALSE) target = tac->op2->value.label_name;
+		if (!target) continue;
+
+		BasicBlock* target_block = find_matching_label_block(cfg, target);
+		if (target_block && !target_block->visited) return false;
+	}
+
+	if (block->num_instructions == 0 || index + 1 >= cfg->num_blocks) return true;
+
+	TACInstruction* last = block->instructions[block->num_instructions - 1];
+	if (last && (last->kind == TAC_GOTO || last->kind == TAC_RETURN)) return true;
+	return cfg->all_blocks[index + 1]->visited;
+}
+
+int remove_unreachable_blocks(CompilerContext* ctx, CFG* cfg) {
+	if (cfg->num_blocks == 0) return 0;
+
+	BasicBlock** stack = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	assert(stack);
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		truncate_after_return(cfg->all_blocks[i]);
+		cfg->all_blocks[i]->visited = false;
+	}
+
+	int top = 0;
+	cfg->all_blocks[0]->visited = true;
+	stack[top++] = cfg->all_blocks[0];
+	while (top > 0) {
+		BasicBlock* block = stack[--top];
+		for (int i = 0; i < block->num_successors; i++) {
+			BasicBlock* successor = block->successors[i];
+			if (!successor->visited) {
+				successor->visited = true;
+				stack[top++] = successor;
+			}
+		}
+	}
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		if (!cfg->all_blocks[i]->visited) continue;
+		assert(lands_on_reachable_block(cfg, i) && "removing a block a reachable one still jumps to");
+	}
+
+	int kept = 0;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		if (block->visited) {
+			cfg->all_blocks[kept++] = block;
+		} else {
+			remove_edges_from(block);
+		}
+	}
+
+	int removed = cfg->num_blocks - kept;
+	cfg->num_blocks = kept;
+	return removed;
+}
+
+// div and mod stay, since a zero divisor traps, and so does 't = _RET',
+// which belongs to its call
+bool is_removable(TACInstruction* tac) {
+	if (!tac->result) return false;
+	if (tac->result->kind == OP_SYMBOL && !is_local_symbol(tac->result)) return false;
+
+	switch (tac->kind) {
+		case TAC_INTEGER:
+		case TAC_BOOL:
+		case TAC_CHAR:
+		case TAC_ADD:
+		case TAC_SUB:
+		case TAC_MUL:
+		case TAC_LESS:
+		case TAC_GREATER:
+		case TAC_LESS_EQUAL:
+		case TAC_GREATER_EQUAL:
+		case TAC_EQUAL:
+		case TAC_NOT_EQUAL:
+		case TAC_LOGICAL_OR:
+		case TAC_LOGICAL_AND:
+		case TAC_NOT:
+		case TAC_UNARY_ADD:
+		case TAC_UNARY_SUB: return true;
+
+		case TAC_ASSIGNMENT: return tac->op2 && tac->op2->kind != OP_RETURN;
+		default: return false;
+	}
+}
+
+// the reads 'populate_use_and_def_sets' counts, plus the address a store
+// writes through, which it treats as a definition
+void mark_instruction_uses(OperandNumbering* numbering, TACInstruction* tac, BitSet* live) {
+	switch (tac->kind) {
+		case TAC_ADD:
+		case TAC_SUB:
+		case TAC_MUL:
+		case TAC_DIV:
+		case TAC_MODULO:
+		case TAC_LESS:
+		case TAC_GREATER:
+		case TAC_LESS_EQUAL:
+		case TAC_GREATER_EQUAL:
+		case TAC_EQUAL:
+		case TAC_NOT_EQUAL:
+		case TAC_LOGICAL_OR:
+		case TAC_LOGICAL_AND: {
+			bitset_add(live, find_operand_number(numbering, tac->op1));
+			bitset_add(live, find_operand_number(numbering, tac->op2));
+			break;
+		}
+
+		case TAC_STORE:
+		case TAC_DEREFERENCE_AND_ASSIGN: {
+			bitset_add(live, find_operand_number(numbering, tac->result));
+			bitset_add(live, find_operand_number(numbering, tac->op1));
+			break;
+		}
+
+		case TAC_IF_FALSE:
+		case TAC_RETURN:
+		case TAC_ARG:
+		case TAC_DEREFERENCE:
+		case TAC_UNARY_ADD:
+		case TAC_UNARY_SUB:
+		case TAC_NOT: {
+			bitset_add(live, find_operand_number(numbering, tac->op1));
+			break;
+		}
+
+		case TAC_ASSIGNMENT: {
+			if (tac->op2 && tac->op2->kind != OP_RETURN) {
+				bitset_add(live, find_operand_number(numbering, tac->op2));
+			}
+			break;
+		}
+
+		default: break;
+	}
+}
+
+// walks the blocks in postorder and refreshes their sets on the way, so a
+// block sees what its successors still read after their own sweep. along
+// a back edge it sees the old sets, which can only hold more
+int remove_dead_instructions(CompilerContext* ctx, CFG* cfg) {
+	OperandNumbering* numbering = cfg->numbering;
+	BitSet* live = create_bitset(ctx, numbering->count);
+	assert(live);
+
+	int removed = 0;
+	for (int i = cfg->num_blocks - 1; i >= 0; i--) {
+		BasicBlock* block = cfg->rpo[i];
+		bitset_clear(block->out_set);
+		for (int j = 0; j < block->num_successors; j++) {
+			bitset_union(block->out_set, block->successors[j]->in_set);
+		}
+		bitset_copy(live, block->out_set);
+
+		int kept = block->num_instructions;
+		for (int j = block->num_instructions - 1; j >= 0; j--) {
+			TACInstruction* tac = block->instructions[j];
+			if (!tac) continue;
+
+			int result = find_operand_number(numbering, tac->result);
+			if (is_removable(tac) && !bitset_contains(live, result)) {
+				removed++;
+				continue;
+			}
+
+			if (tac->kind != TAC_STORE && tac->kind != TAC_DEREFERENCE_AND_ASSIGN) {
+				bitset_remove(live, result);
+			}
+			mark_instruction_uses(numbering, tac, live);
+			block->instructions[--kept] = tac;
+		}
+
+		// the survivors were packed against the end on the way up
+		int count = block->num_instructions - kept;
+		memmove(block->instructions, &block->instructions[kept], sizeof(TACInstruction*) * count);
+		block->num_instructions = count;
+		bitset_copy(block->in_set, live);
+	}
+	return removed;
+}
+
+void eliminate_dead_code(CompilerContext* ctx, FunctionInfo* info) {
+	CFG* cfg = info->cfg;
+	cfg->dead_instructions = 0;
+	solve_liveness(ctx, cfg);
+
+	int rounds = 1;
+	int removed;
+	while ((removed = remove_dead_instructions(ctx, cfg)) > 0) {
+		cfg->dead_instructions += removed;
+		update_liveness(ctx, cfg);
+		rounds++;
+	}
+
+	if (ctx->verbose) {
+		fprintf(ctx->function->report, "dce: %s: %d unreachable blocks, %d dead instructions, %d rounds\n",
+			info->symbol->name, cfg->unreachable_blocks, cfg->dead_instructions, rounds);
+	}
+}
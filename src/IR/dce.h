@@ -0,0 +1,17 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "compilercontext.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+
+void remove_edges_from(BasicBlock* block);
+void truncate_after_return(BasicBlock* block);
+bool lands_on_reachable_block(CFG* cfg, int index);
+int remove_unreachable_blocks(CompilerContext* ctx, CFG* cfg);
+bool is_removable(TACInstruction* tac);
+void mark_instruction_uses(OperandNumbering* numbering, TACInstruction* tac, BitSet* live);
+int remove_dead_instructions(CompilerContext* ctx, CFG* cfg);
+void eliminate_dead_code(CompilerContext* ctx, FunctionInfo* info);
+
+#endif
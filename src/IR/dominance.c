@@ -0,0 +1,140 @@
+#include "dominance.h"
+#include "assert.h"
+
+// dominators by Cooper, Harvey and Kennedy's iterative algorithm over the
+// reverse postorder, which 'compute_reverse_postorder' must have set up.
+// blocks the entry cannot reach keep a NULL idom and dominate nothing
+
+// walks both fingers up the tree until they meet; a block's idom always
+// comes earlier in reverse postorder
+BasicBlock* intersect_dominators(BasicBlock* a, BasicBlock* b) {
+	while (a != b) {
+		while (a->rpo_index > b->rpo_index) a = a->idom;
+		while (b->rpo_index > a->rpo_index) b = b->idom;
+	}
+	return a;
+}
+
+void compute_dominators(CompilerContext* ctx, CFG* cfg) {
+	if (cfg->num_blocks == 0) return;
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		cfg->rpo[i]->idom = NULL;
+		cfg->rpo[i]->num_dom_children = 0;
+	}
+
+	BasicBlock* entry = cfg->rpo[0];
+	entry->idom = entry;
+
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (int i = 1; i < cfg->num_blocks; i++) {
+			BasicBlock* block = cfg->rpo[i];
+			if (!block->visited) break;
+
+			BasicBlock* idom = NULL;
+			for (int j = 0; j < block->num_predecessors; j++) {
+				BasicBlock* predecessor = block->predecessors[j];
+				if (!predecessor->idom) continue;
+				idom = idom ? intersect_dominators(predecessor, idom) : predecessor;
+			}
+
+			if (idom != block->idom) {
+				block->idom = idom;
+				changed = true;
+			}
+		}
+	}
+	entry->idom = NULL;
+
+	for (int i = 1; i < cfg->num_blocks; i++) {
+		if (cfg->rpo[i]->idom) cfg->rpo[i]->idom->num_dom_children++;
+	}
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->rpo[i];
+		block->dom_children = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * (block->num_dom_children + 1));
+		assert(block->dom_children);
+		block->num_dom_children = 0;
+	}
+	for (int i = 1; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->rpo[i];
+		if (block->idom) block->idom->dom_children[block->idom->num_dom_children++] = block;
+	}
+
+	number_dominator_tree(ctx, cfg);
+}
+
+// preorder numbers, with each block's last descendant, from an iterative
+// walk of the tree; unreachable blocks get an empty range
+void number_dominator_tree(CompilerContext* ctx, CFG* cfg) {
+	BasicBlock** stack = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	int* next_child = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	assert(stack && next_child);
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		cfg->rpo[i]->dom_preorder = -1;
+		cfg->rpo[i]->dom_last_descendant = -2;
+	}
+
+	int counter = 0;
+	int top = 0;
+	cfg->rpo[0]->dom_preorder = counter++;
+	next_child[top] = 0;
+	stack[top++] = cfg->rpo[0];
+
+	while (top > 0) {
+		BasicBlock* block = stack[top - 1];
+		if (next_child[top - 1] < block->num_dom_children) {
+			BasicBlock* child = block->dom_children[next_child[top - 1]++];
+			child->dom_preorder = counter++;
+			next_child[top] = 0;
+			stack[top++] = child;
+		} else {
+			block->dom_last_descendant = counter - 1;
+			top--;
+		}
+	}
+}
+
+bool dominates(BasicBlock* a, BasicBlock* b) {
+	return b->dom_preorder >= a->dom_preorder && b->dom_preorder <= a->dom_last_descendant;
+}
+
+// a join point is in the frontier of every block on the way up from each of
+// its predecessors to its idom
+void compute_dominance_frontiers(CompilerContext* ctx, CFG* cfg) {
+	int* last_added = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	assert(last_added);
+
+	// counted in one pass and filled in the next, so each frontier is
+	// allocated once
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < cfg->num_blocks; i++) {
+			BasicBlock* block = cfg->rpo[i];
+			last_added[i] = -1;
+			if (pass == 1) {
+				block->frontier = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * (block->num_frontier + 1));
+				assert(block->frontier);
+			}
+			block->num_frontier = 0;
+		}
+
+		for (int i = 0; i < cfg->num_blocks; i++) {
+			BasicBlock* block = cfg->rpo[i];
+			if (!block->visited || block->num_predecessors < 2) continue;
+
+			for (int j = 0; j < block->num_predecessors; j++) {
+				BasicBlock* runner = block->predecessors[j];
+				if (!runner->visited) continue;
+
+				while (runner != block->idom && last_added[runner->rpo_index] != i) {
+					last_added[runner->rpo_index] = i;
+					if (pass == 1) runner->frontier[runner->num_frontier] = block;
+					runner->num_frontier++;
+					runner = runner->idom;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,13 @@
+#ifndef DOMINANCE_H
+#define DOMINANCE_H
+
+#include "compilercontext.h"
+#include "IR/cfg.h"
+
+BasicBlock* intersect_dominators(BasicBlock* a, BasicBlock* b);
+void compute_dominators(CompilerContext* ctx, CFG* cfg);
+void number_dominator_tree(CompilerContext* ctx, CFG* cfg);
+bool dominates(BasicBlock* a, BasicBlock* b);
+void compute_dominance_frontiers(CompilerContext* ctx, CFG* cfg);
+
+#endif
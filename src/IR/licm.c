@@ -0,0 +1,279 @@
+#include "licm.h"
+#include "dominance.h"
+#include "loops.h"
+#include "constfold.h"
+#include "dce.h"
+#include "RegAlloc/regalloc.h"
+#include "assert.h"
+#include "backend.h"
+
+// loop invariant code motion, run while the cfg is in ssa form so every
+// variable has one definition. an instruction moves to the loop's preheader
+// when it computes something without side effects or traps, and everything
+// it reads is defined outside the loop. running it before the loop is
+// entered at all is harmless for the same reasons. constants and copies
+// cost less inside the loop than a register held across it, so they only
+// leave with an instruction that reads them. a hoisted value holds a
+// register for the whole loop, loops inside it included, so a loop only
+// takes as many as the allocator has left over at the busiest block of any
+// of them
+
+LoopMotion* create_loop_motion(CompilerContext* ctx, CFG* cfg) {
+	LoopMotion* motion = arena_allocate(ctx->ir_arena, sizeof(LoopMotion));
+	if (!motion) {
+		perror("In 'create_loop_motion', unable to allocate space for loop motion\n");
+		return NULL;
+	}
+
+	motion->cfg = cfg;
+	motion->definitions = create_operand_numbering(ctx);
+	if (!motion->definitions) return NULL;
+	return motion;
+}
+
+// the one block that enters the loop, if it has no other successor to
+// keep hoisted code away from
+BasicBlock* find_preheader(Loop* loop) {
+	BasicBlock* header = loop->header;
+	BasicBlock* preheader = NULL;
+	for (int i = 0; i < header->num_predecessors; i++) {
+		BasicBlock* predecessor = header->predecessors[i];
+		if (!predecessor->visited || dominates(header, predecessor)) continue;
+		if (preheader) return NULL;
+		preheader = predecessor;
+	}
+
+	if (!preheader || preheader->num_successors != 1) return NULL;
+	if (preheader->num_instructions > 0 && preheader->instructions[preheader->num_instructions - 1]->kind == TAC_IF_FALSE) return NULL;
+	return preheader;
+}
+
+// a loop entered from a branch gets an empty block on that edge. the edge
+// keeps its place among the header's predecessors, so the phis stay as they
+// are. loops entered from more than one block are left alone
+int add_preheaders(CompilerContext* ctx, SSABuilder* ssa) {
+	CFG* cfg = ssa->cfg;
+	int added = 0;
+	for (int i = 0; i < cfg->num_loops; i++) {
+		BasicBlock* header = cfg->loops[i]->header;
+
+		int entering = -1;
+		int count = 0;
+		for (int j = 0; j < header->num_predecessors; j++) {
+			BasicBlock* predecessor = header->predecessors[j];
+			if (!predecessor->visited || dominates(header, predecessor)) continue;
+			entering = j;
+			count++;
+		}
+		if (count != 1) continue;
+
+		BasicBlock* predecessor = header->predecessors[entering];
+		TACInstruction* last = predecessor->num_instructions > 0 ? predecessor->instructions[predecessor->num_instructions - 1] : NULL;
+		if (predecessor->num_successors > 1 || (last && last->kind == TAC_IF_FALSE)) {
+			split_edge(ctx, ssa, predecessor, entering, header);
+			added++;
+		}
+	}
+
+	// the new blocks belong to the loops around them
+	if (added > 0) {
+		compute_reverse_postorder(ctx, cfg);
+		compute_dominators(ctx, cfg);
+		find_natural_loops(ctx, cfg);
+	}
+	return added;
+}
+
+// stores write through the address in their result, so it is not theirs
+bool number_definitions(CompilerContext* ctx, LoopMotion* motion) {
+	CFG* cfg = motion->cfg;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < cfg->num_blocks; i++) {
+			BasicBlock* block = cfg->all_blocks[i];
+			for (int j = 0; j < block->num_instructions; j++) {
+				TACInstruction* tac = block->instructions[j];
+				if (!tac->result || tac->kind == TAC_STORE || tac->kind == TAC_DEREFERENCE_AND_ASSIGN) continue;
+
+				if (pass == 0) {
+					number_operand(ctx, motion->definitions, tac->result);
+					continue;
+				}
+
+				int n = find_operand_number(motion->definitions, tac->result);
+				if (n == -1) continue;
+				motion->def_blocks[n] = block;
+				motion->def_instructions[n] = tac;
+				motion->def_counts[n]++;
+			}
+		}
+
+		if (pass == 0) {
+			int count = motion->definitions->count;
+			motion->def_blocks = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * (count + 1));
+			motion->def_instructions = arena_allocate(ctx->ir_arena, sizeof(TACInstruction*) * (count + 1));
+			motion->def_counts = arena_allocate(ctx->ir_arena, sizeof(int) * (count + 1));
+			if (!motion->def_blocks || !motion->def_instructions || !motion->def_counts) return false;
+		}
+	}
+
+	motion->in_loop = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	if (!motion->in_loop) return false;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		motion->in_loop[i] = -1;
+	}
+	return true;
+}
+
+// pressure comes from the liveness 'construct_ssa' solved before renaming;
+// blocks added since have no sets and are skipped. the count undershoots
+// what the allocator ends up needing, hence the spare registers
+bool compute_budgets(CompilerContext* ctx, LoopMotion* motion) {
+	CFG* cfg = motion->cfg;
+	motion->budgets = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_loops);
+	motion->header_loops = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	if (!motion->budgets || !motion->header_loops) return false;
+
+	for (int i = 0; i < cfg->num_loops; i++) {
+		Loop* loop = cfg->loops[i];
+		motion->header_loops[loop->header->rpo_index] = i;
+		int pressure = 0;
+		for (int j = 0; j < loop->num_blocks; j++) {
+			BitSet* live = loop->blocks[j]->in_set;
+			if (!live) continue;
+
+			int count = 0;
+			for (int w = 0; w < live->num_words; w++) {
+				count += __builtin_popcountll(live->words[w]);
+			}
+			if (count > pressure) pressure = count;
+		}
+		motion->budgets[i] = NUM_REGISTERS - LICM_SPARE_REGISTERS - pressure;
+	}
+	return true;
+}
+
+bool is_constant_instruction(TACInstruction* tac) {
+	return tac->kind == TAC_INTEGER || tac->kind == TAC_BOOL || tac->kind == TAC_CHAR;
+}
+
+// literals are invariant, and so are parameters nothing assigns and
+// constants, which can follow whatever reads them out. globals are not,
+// since any call in the loop may change them
+bool is_loop_invariant(LoopMotion* motion, Operand* op, int loop_index) {
+	if (!op) return true;
+	if (op->kind == OP_RETURN) return false;
+	if (op->kind == OP_SYMBOL && !is_local_symbol(op)) return false;
+	if (!is_operand_label_or_symbol(op)) return true;
+
+	int n = find_operand_number(motion->definitions, op);
+	if (n == -1) return true;
+	if (motion->def_counts[n] > 1) return false;
+	if (motion->in_loop[motion->def_blocks[n]->rpo_index] != loop_index) return true;
+	return is_constant_instruction(motion->def_instructions[n]);
+}
+
+// the compare in front of a branch is fused with it, so it stays
+bool is_hoistable(BasicBlock* block, int index) {
+	TACInstruction* tac = block->instructions[index];
+	if (!is_removable(tac) || is_constant_instruction(tac)) return false;
+	if (tac->kind == TAC_ASSIGNMENT) return false;
+	if (index + 1 < block->num_instructions && block->instructions[index + 1]->kind == TAC_IF_FALSE) return false;
+	return true;
+}
+
+int find_instruction(BasicBlock* block, TACInstruction* tac) {
+	for (int i = 0; i < block->num_instructions; i++) {
+		if (block->instructions[i] == tac) return i;
+	}
+	return -1;
+}
+
+// constants the instruction reads from inside the loop go first. hoisted
+// instructions keep their order, in front of the preheader's jump
+void hoist_instruction(CompilerContext* ctx, LoopMotion* motion, TACInstruction* tac, int loop_index, BasicBlock* preheader) {
+	Operand* operands[2] = {tac->op1, tac->op2};
+	for (int k = 0; k < 2; k++) {
+		int n = find_operand_number(motion->definitions, operands[k]);
+		if (n == -1 || motion->in_loop[motion->def_blocks[n]->rpo_index] != loop_index) continue;
+		hoist_instruction(ctx, motion, motion->def_instructions[n], loop_index, preheader);
+	}
+
+	int n = find_operand_number(motion->definitions, tac->result);
+	assert(n != -1);
+	BasicBlock* block = motion->def_blocks[n];
+	int index = find_instruction(block, tac);
+	assert(index != -1);
+
+	memmove(&block->instructions[index], &block->instructions[index + 1], sizeof(TACInstruction*) * (block->num_instructions - index - 1));
+	block->num_instructions--;
+
+	int position = preheader->num_instructions;
+	if (position > 0 && preheader->instructions[position - 1]->kind == TAC_GOTO) position--;
+	bool inserted = insert_instruction_into_block(ctx, preheader, position, tac);
+	assert(inserted);
+
+	motion->def_blocks[n] = preheader;
+	motion->budgets[loop_index]--;
+	motion->hoisted++;
+}
+
+// blocks of inner loops were done with their own loop, and whatever they
+// had that is invariant here too now sits in their preheaders, which are
+// blocks of this loop. reverse postorder puts each definition in front of
+// its uses outside of phis, so one pass is enough
+void hoist_loop(CompilerContext* ctx, LoopMotion* motion, int loop_index) {
+	Loop* loop = motion->cfg->loops[loop_index];
+	BasicBlock* preheader = find_preheader(loop);
+	if (!preheader) return;
+
+	for (int i = 0; i < loop->num_blocks; i++) {
+		motion->in_loop[loop->blocks[i]->rpo_index] = loop_index;
+	}
+
+	for (int i = 0; i < loop->num_blocks; i++) {
+		BasicBlock* block = loop->blocks[i];
+		if (block->loop != loop) continue;
+
+		int j = 0;
+		while (j < block->num_instructions && motion->budgets[loop_index] > 0) {
+			TACInstruction* tac = block->instructions[j];
+			if (!is_hoistable(block, j) || !is_loop_invariant(motion, tac->op1, loop_index) || !is_loop_invariant(motion, tac->op2, loop_index)) {
+				j++;
+				continue;
+			}
+
+			// constants in front of it may leave this block too
+			TACInstruction* next = j + 1 < block->num_instructions ? block->instructions[j + 1] : NULL;
+			hoist_instruction(ctx, motion, tac, loop_index, preheader);
+			j = next ? find_instruction(block, next) : block->num_instructions;
+		}
+	}
+}
+
+void hoist_loop_invariants(CompilerContext* ctx, FunctionInfo* info, SSABuilder* ssa) {
+	CFG* cfg = info->cfg;
+	LoopMotion* motion = create_loop_motion(ctx, cfg);
+	assert(motion);
+
+	if (cfg->num_loops > 0) {
+		motion->preheaders = add_preheaders(ctx, ssa);
+		bool numbered = number_definitions(ctx, motion) && compute_budgets(ctx, motion);
+		assert(numbered);
+
+		// inner loops come later in the list; doing them first lets what
+		// they hoist move on out of the loops around them
+		for (int i = cfg->num_loops - 1; i >= 0; i--) {
+			hoist_loop(ctx, motion, i);
+
+			Loop* parent = cfg->loops[i]->parent;
+			if (!parent) continue;
+			int p = motion->header_loops[parent->header->rpo_index];
+			if (motion->budgets[i] < motion->budgets[p]) motion->budgets[p] = motion->budgets[i];
+		}
+	}
+
+	if (ctx->verbose) {
+		fprintf(ctx->function->report, "licm: %s: %d loops, %d preheaders, %d hoisted\n",
+			info->symbol->name, cfg->num_loops, motion->preheaders, motion->hoisted);
+	}
+}
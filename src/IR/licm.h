@@ -0,0 +1,40 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "compilercontext.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+#include "IR/ssa.h"
+
+// registers a loop keeps free of hoisted values, for the copies out of ssa
+// and the registers calls and division take over
+#define LICM_SPARE_REGISTERS 3
+
+typedef struct {
+	CFG* cfg;
+	OperandNumbering* definitions; // everything an instruction of the function defines
+	BasicBlock** def_blocks; // by definition: the block defining it
+	TACInstruction** def_instructions; // by definition: the instruction defining it
+	int* def_counts; // by definition: how many instructions define it
+	int* in_loop; // by rpo index: the loop being hoisted out of, if the block is in it
+	int* budgets; // by loop: registers left for values hoisted out of it, or of any loop inside it
+	int* header_loops; // by rpo index: the loop the block heads
+
+	int preheaders;
+	int hoisted;
+} LoopMotion;
+
+LoopMotion* create_loop_motion(CompilerContext* ctx, CFG* cfg);
+BasicBlock* find_preheader(Loop* loop);
+int add_preheaders(CompilerContext* ctx, SSABuilder* ssa);
+bool number_definitions(CompilerContext* ctx, LoopMotion* motion);
+bool compute_budgets(CompilerContext* ctx, LoopMotion* motion);
+bool is_constant_instruction(TACInstruction* tac);
+bool is_loop_invariant(LoopMotion* motion, Operand* op, int loop_index);
+bool is_hoistable(BasicBlock* block, int index);
+int find_instruction(BasicBlock* block, TACInstruction* tac);
+void hoist_instruction(CompilerContext* ctx, LoopMotion* motion, TACInstruction* tac, int loop_index, BasicBlock* preheader);
+void hoist_loop(CompilerContext* ctx, LoopMotion* motion, int loop_index);
+void hoist_loop_invariants(CompilerContext* ctx, FunctionInfo* info, SSABuilder* ssa);
+
+#endif
@@ -0,0 +1,147 @@
+#include "loops.h"
+#include "dominance.h"
+#include "assert.h"
+#include "backend.h"
+
+// natural loops over the dominator tree 'compute_dominators' built: an edge
+// whose target dominates its source is a back edge. the language only has
+// structured loops, so every edge that goes back in reverse postorder is
+// one of them and the loops nest
+
+Loop* create_loop(CompilerContext* ctx, BasicBlock* header, int num_blocks) {
+	Loop* loop = arena_allocate(ctx->ir_arena, sizeof(Loop));
+	if (!loop) {
+		perror("In 'create_loop', unable to allocate space for loop\n");
+		return NULL;
+	}
+
+	loop->header = header;
+	loop->blocks = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * num_blocks);
+	if (!loop->blocks) return NULL;
+
+	loop->num_blocks = 0;
+	loop->parent = header->loop;
+	loop->depth = loop->parent ? loop->parent->depth + 1 : 1;
+	return loop;
+}
+
+// headers are visited in reverse postorder, so a loop is found after every
+// loop around it and its blocks end up pointing at the innermost one
+void find_natural_loops(CompilerContext* ctx, CFG* cfg) {
+	cfg->num_loops = 0;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		cfg->all_blocks[i]->loop_depth = 0;
+		cfg->all_blocks[i]->loop = NULL;
+	}
+	if (cfg->num_blocks == 0) return;
+
+	int* in_body = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	BasicBlock** stack = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	cfg->loops = arena_allocate(ctx->ir_arena, sizeof(Loop*) * cfg->num_blocks);
+	assert(in_body && stack && cfg->loops);
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		in_body[i] = -1;
+	}
+
+	for (int h = 0; h < cfg->num_blocks; h++) {
+		BasicBlock* header = cfg->rpo[h];
+		if (!header->visited) break;
+
+		int top = 0;
+		int num_blocks = 1;
+		bool is_header = false;
+		in_body[h] = h;
+		for (int j = 0; j < header->num_predecessors; j++) {
+			BasicBlock* latch = header->predecessors[j];
+			if (!latch->visited || !dominates(header, latch)) continue;
+
+			is_header = true;
+			if (in_body[latch->rpo_index] != h) {
+				in_body[latch->rpo_index] = h;
+				stack[top++] = latch;
+				num_blocks++;
+			}
+		}
+		if (!is_header) continue;
+
+		while (top > 0) {
+			BasicBlock* block = stack[--top];
+			for (int j = 0; j < block->num_predecessors; j++) {
+				BasicBlock* predecessor = block->predecessors[j];
+				if (predecessor->visited && in_body[predecessor->rpo_index] != h) {
+					in_body[predecessor->rpo_index] = h;
+					stack[top++] = predecessor;
+					num_blocks++;
+				}
+			}
+		}
+
+		Loop* loop = create_loop(ctx, header, num_blocks);
+		assert(loop);
+
+		// the header dominates the body, so the body follows it in reverse
+		// postorder
+		for (int i = h; loop->num_blocks < num_blocks; i++) {
+			if (in_body[i] != h) continue;
+
+			loop->blocks[loop->num_blocks++] = cfg->rpo[i];
+			cfg->rpo[i]->loop = loop;
+		}
+		cfg->loops[cfg->num_loops++] = loop;
+	}
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		block->loop_depth = block->loop ? block->loop->depth : 0;
+	}
+}
+
+// blocks in emission order with their dominator and loop depth, then each
+// loop by its header's id
+void dump_cfg(CompilerContext* ctx, FunctionInfo* info) {
+	CFG* cfg = info->cfg;
+	FILE* out = ctx->function->report;
+
+	fprintf(out, "cfg: %s: %d blocks, %d loops\n", info->symbol->name, cfg->num_blocks, cfg->num_loops);
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		fprintf(out, "\tblock %d: %d instructions, ", block->id, block->num_instructions);
+		if (block->idom) {
+			fprintf(out, "idom %d", block->idom->id);
+		} else {
+			fprintf(out, "idom -");
+		}
+		fprintf(out, ", loop depth %d, preds", block->loop_depth);
+		for (int j = 0; j < block->num_predecessors; j++) {
+			fprintf(out, " %d", block->predecessors[j]->id);
+		}
+		fprintf(out, ", succs");
+		for (int j = 0; j < block->num_successors; j++) {
+			fprintf(out, " %d", block->successors[j]->id);
+		}
+		fprintf(out, "\n");
+	}
+
+	for (int i = 0; i < cfg->num_loops; i++) {
+		Loop* loop = cfg->loops[i];
+		fprintf(out, "\tloop %d: depth %d, ", loop->header->id, loop->depth);
+		if (loop->parent) {
+			fprintf(out, "parent %d", loop->parent->header->id);
+		} else {
+			fprintf(out, "parent -");
+		}
+		fprintf(out, ", blocks");
+		for (int j = 0; j < loop->num_blocks; j++) {
+			fprintf(out, " %d", loop->blocks[j]->id);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+void dump_function_cfgs(CompilerContext* ctx) {
+	FunctionList* function_list = ctx->function->function_list;
+	for (int i = 0; i < function_list->size; i++) {
+		if (function_list->infos[i]->cfg) dump_cfg(ctx, function_list->infos[i]);
+	}
+}
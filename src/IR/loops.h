@@ -0,0 +1,12 @@
+#ifndef LOOPS_H
+#define LOOPS_H
+
+#include "compilercontext.h"
+#include "IR/cfg.h"
+
+Loop* create_loop(CompilerContext* ctx, BasicBlock* header, int num_blocks);
+void find_natural_loops(CompilerContext* ctx, CFG* cfg);
+void dump_cfg(CompilerContext* ctx, FunctionInfo* info);
+void dump_function_cfgs(CompilerContext* ctx);
+
+#endif
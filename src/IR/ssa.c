@@ -0,0 +1,438 @@
+#include "ssa.h"
+#include "dominance.h"
+#include "constfold.h"
+#include "interner.h"
+#include "assert.h"
+#include "backend.h"
+
+// pruned ssa over a function's linked CFG. the local scalars assigned in the
+// function get a phi wherever their definitions meet and they are still
+// live, and every definition a version of its own. temporaries are defined
+// once already and stay as they are. destruct_ssa turns the phis back into
+// copies at the end of the predecessors, so everything after it keeps
+// working on plain TAC
+
+SSABuilder* create_ssa_builder(CompilerContext* ctx, CFG* cfg) {
+	SSABuilder* ssa = arena_allocate(ctx->ir_arena, sizeof(SSABuilder));
+	if (!ssa) {
+		perror("In 'create_ssa_builder', unable to allocate space for ssa builder\n");
+		return NULL;
+	}
+
+	ssa->cfg = cfg;
+	ssa->variables = create_operand_numbering(ctx);
+	if (!ssa->variables) return NULL;
+	return ssa;
+}
+
+// phis go right after a block's label, so jumps to the label still land on it
+int phi_position(BasicBlock* block) {
+	if (block->num_instructions > 0 && block->instructions[0]->kind == TAC_LABEL) return 1;
+	return 0;
+}
+
+int count_phis(BasicBlock* block) {
+	int count = 0;
+	for (int i = phi_position(block); i < block->num_instructions; i++) {
+		if (block->instructions[i]->kind != TAC_PHI) break;
+		count++;
+	}
+	return count;
+}
+
+// a function that starts with a loop has its header as the entry; renaming
+// needs an entry nothing jumps back to, so an empty block goes in front
+bool add_entry_block(CompilerContext* ctx, CFG* cfg) {
+	BasicBlock* entry = create_basic_block(ctx);
+	if (!entry) return false;
+
+	BasicBlock* header = cfg->all_blocks[0];
+	if (!insert_block_into_cfg(ctx, cfg, 0, entry)) return false;
+	add_edges(ctx, cfg, 0, header);
+	cfg->head = entry;
+	return true;
+}
+
+bool is_ssa_variable(Operand* op) {
+	return is_local_symbol(op);
+}
+
+bool collect_ssa_variables(CompilerContext* ctx, SSABuilder* ssa) {
+	CFG* cfg = ssa->cfg;
+	int definitions = 0;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		if (!block->visited) continue;
+
+		for (int j = 0; j < block->num_instructions; j++) {
+			TACInstruction* tac = block->instructions[j];
+			if (tac->kind == TAC_ASSIGNMENT && is_ssa_variable(tac->result)) {
+				number_operand(ctx, ssa->variables, tac->result);
+				definitions++;
+			}
+		}
+	}
+
+	int count = ssa->variables->count;
+	if (count == 0) return false;
+
+	ssa->live_numbers = arena_allocate(ctx->ir_arena, sizeof(int) * count);
+	ssa->current = arena_allocate(ctx->ir_arena, sizeof(Operand*) * count);
+	ssa->versions = arena_allocate(ctx->ir_arena, sizeof(int) * count);
+	assert(ssa->live_numbers && ssa->current && ssa->versions);
+
+	for (int v = 0; v < count; v++) {
+		ssa->live_numbers[v] = find_operand_number(cfg->numbering, ssa->variables->operands[v]);
+		ssa->current[v] = ssa->variables->operands[v];
+	}
+
+	// every definition and every phi logs one entry while renaming
+	ssa->undo_capacity = definitions;
+	return true;
+}
+
+// the iterated dominance frontier of each variable's definitions, keeping
+// only the phis whose variable is live into the block
+void place_phis(CompilerContext* ctx, SSABuilder* ssa) {
+	CFG* cfg = ssa->cfg;
+	int count = ssa->variables->count;
+
+	int* def_start = arena_allocate(ctx->ir_arena, sizeof(int) * (count + 1));
+	int* fill = arena_allocate(ctx->ir_arena, sizeof(int) * count);
+	int* last_block = arena_allocate(ctx->ir_arena, sizeof(int) * count);
+	int* has_phi = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	int* queued = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	BasicBlock** worklist = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	assert(def_start && fill && last_block && has_phi && queued && worklist);
+
+	// the blocks defining each variable, counted in one pass and filled in
+	// the next
+	int* def_blocks = NULL;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int v = 0; v < count; v++) last_block[v] = -1;
+
+		for (int i = 0; i < cfg->num_blocks; i++) {
+			BasicBlock* block = cfg->rpo[i];
+			if (!block->visited) break;
+
+			for (int j = 0; j < block->num_instructions; j++) {
+				TACInstruction* tac = block->instructions[j];
+				if (tac->kind != TAC_ASSIGNMENT) continue;
+
+				int v = find_operand_number(ssa->variables, tac->result);
+				if (v == -1 || last_block[v] == i) continue;
+
+				last_block[v] = i;
+				if (pass == 0) def_start[v + 1]++;
+				else def_blocks[fill[v]++] = i;
+			}
+		}
+
+		if (pass == 0) {
+			for (int v = 0; v < count; v++) {
+				def_start[v + 1] += def_start[v];
+				fill[v] = def_start[v];
+			}
+			def_blocks = arena_allocate(ctx->ir_arena, sizeof(int) * (def_start[count] + 1));
+			assert(def_blocks);
+		}
+	}
+
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		has_phi[i] = -1;
+		queued[i] = -1;
+	}
+
+	for (int v = 0; v < count; v++) {
+		Operand* variable = ssa->variables->operands[v];
+
+		int top = 0;
+		for (int d = def_start[v]; d < def_start[v + 1]; d++) {
+			queued[def_blocks[d]] = v;
+			worklist[top++] = cfg->rpo[def_blocks[d]];
+		}
+
+		while (top > 0) {
+			BasicBlock* block = worklist[--top];
+			for (int f = 0; f < block->num_frontier; f++) {
+				BasicBlock* join = block->frontier[f];
+				if (has_phi[join->rpo_index] == v) continue;
+				has_phi[join->rpo_index] = v;
+
+				// a dead variable needs no phi, but its definitions still
+				// reach past the join
+				if (bitset_contains(join->in_set, ssa->live_numbers[v])) {
+					TACInstruction* phi = create_tac(ctx, TAC_PHI, variable, variable, NULL);
+					assert(phi);
+					phi->phi_args = arena_allocate(ctx->ir_arena, sizeof(Operand*) * (join->num_predecessors + 1));
+					assert(phi->phi_args);
+
+					insert_instruction_into_block(ctx, join, phi_position(join), phi);
+					ssa->num_phis++;
+					ssa->undo_capacity++;
+				}
+
+				if (queued[join->rpo_index] != v) {
+					queued[join->rpo_index] = v;
+					worklist[top++] = join;
+				}
+			}
+		}
+	}
+}
+
+// versions are locals of their own with distinct interned names, since the
+// liveness tables further on tell symbols apart by name
+Operand* create_version(CompilerContext* ctx, SSABuilder* ssa, int variable) {
+	Operand* original = ssa->variables->operands[variable];
+
+	Symbol* symbol = arena_allocate(ctx->ir_arena, sizeof(Symbol));
+	assert(symbol);
+	*symbol = *original->value.sym;
+	symbol->kind = SYMBOL_LOCAL;
+
+	char name[256];
+	snprintf(name, sizeof(name), "%s.%d", original->value.sym->name, ++ssa->versions[variable]);
+	symbol->name = intern(ctx, name);
+
+	OperandValue value = {.sym = symbol};
+	Operand* version = create_operand(ctx, OP_SYMBOL, value, original->type);
+	assert(version);
+	return version;
+}
+
+Operand* current_version(SSABuilder* ssa, Operand* op) {
+	int v = find_operand_number(ssa->variables, op);
+	return v == -1 ? op : ssa->current[v];
+}
+
+void define_version(CompilerContext* ctx, SSABuilder* ssa, int variable, Operand** slot) {
+	assert(ssa->undo_size < ssa->undo_capacity);
+	ssa->undo_variables[ssa->undo_size] = variable;
+	ssa->undo_operands[ssa->undo_size] = ssa->current[variable];
+	ssa->undo_size++;
+
+	ssa->current[variable] = create_version(ctx, ssa, variable);
+	*slot = ssa->current[variable];
+}
+
+void rename_block(CompilerContext* ctx, SSABuilder* ssa, BasicBlock* block) {
+	for (int i = 0; i < block->num_instructions; i++) {
+		TACInstruction* tac = block->instructions[i];
+
+		if (tac->kind == TAC_PHI) {
+			define_version(ctx, ssa, find_operand_number(ssa->variables, tac->op1), &tac->result);
+			continue;
+		}
+
+		// a parameter is defined by the caller, under its own symbol
+		if (tac->kind == TAC_PARAM) continue;
+
+		tac->op1 = current_version(ssa, tac->op1);
+		tac->op2 = current_version(ssa, tac->op2);
+
+		if (tac->kind == TAC_ASSIGNMENT) {
+			int v = find_operand_number(ssa->variables, tac->result);
+			if (v != -1) define_version(ctx, ssa, v, &tac->result);
+		}
+	}
+
+	// a block can reach the same successor along both of its edges, and
+	// each edge has its own slot
+	for (int i = 0; i < block->num_successors; i++) {
+		BasicBlock* successor = block->successors[i];
+		int start = phi_position(successor);
+		int phis = count_phis(successor);
+
+		for (int p = 0; p < successor->num_predecessors; p++) {
+			if (successor->predecessors[p] != block) continue;
+
+			for (int k = start; k < start + phis; k++) {
+				TACInstruction* phi = successor->instructions[k];
+				phi->phi_args[p] = current_version(ssa, phi->op1);
+			}
+		}
+	}
+}
+
+// a preorder walk of the dominator tree; leaving a block restores the
+// versions that were current when it was entered
+void rename_variables(CompilerContext* ctx, SSABuilder* ssa) {
+	CFG* cfg = ssa->cfg;
+
+	ssa->undo_variables = arena_allocate(ctx->ir_arena, sizeof(int) * (ssa->undo_capacity + 1));
+	ssa->undo_operands = arena_allocate(ctx->ir_arena, sizeof(Operand*) * (ssa->undo_capacity + 1));
+	BasicBlock** stack = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * cfg->num_blocks);
+	int* next_child = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	int* marks = arena_allocate(ctx->ir_arena, sizeof(int) * cfg->num_blocks);
+	assert(ssa->undo_variables && ssa->undo_operands && stack && next_child && marks);
+
+	int top = 0;
+	marks[top] = ssa->undo_size;
+	next_child[top] = 0;
+	stack[top++] = cfg->rpo[0];
+	rename_block(ctx, ssa, cfg->rpo[0]);
+
+	while (top > 0) {
+		BasicBlock* block = stack[top - 1];
+		if (next_child[top - 1] < block->num_dom_children) {
+			BasicBlock* child = block->dom_children[next_child[top - 1]++];
+			marks[top] = ssa->undo_size;
+			next_child[top] = 0;
+			stack[top++] = child;
+			rename_block(ctx, ssa, child);
+		} else {
+			top--;
+			while (ssa->undo_size > marks[top]) {
+				ssa->undo_size--;
+				ssa->current[ssa->undo_variables[ssa->undo_size]] = ssa->undo_operands[ssa->undo_size];
+			}
+		}
+	}
+}
+
+SSABuilder* construct_ssa(CompilerContext* ctx, FunctionInfo* info) {
+	CFG* cfg = info->cfg;
+	SSABuilder* ssa = create_ssa_builder(ctx, cfg);
+	assert(ssa);
+	if (cfg->num_blocks == 0) return ssa;
+
+	if (cfg->all_blocks[0]->num_predecessors > 0) {
+		bool added = add_entry_block(ctx, cfg);
+		assert(added);
+	}
+
+	// liveness prunes the phis, and brings the dominator tree along
+	solve_liveness(ctx, cfg);
+	if (!collect_ssa_variables(ctx, ssa)) return ssa;
+
+	compute_dominance_frontiers(ctx, cfg);
+	place_phis(ctx, ssa);
+	rename_variables(ctx, ssa);
+	return ssa;
+}
+
+// a block that falls through and branches has no room for copies meant for
+// only one of its edges; they go in a block of their own on that edge.
+// nothing can come between the compare and the branch it is fused with, so
+// the new block is always on the edge and never in front of the branch
+BasicBlock* split_edge(CompilerContext* ctx, SSABuilder* ssa, BasicBlock* from, int predecessor_index, BasicBlock* to) {
+	CFG* cfg = ssa->cfg;
+
+	// the edge is the k-th one from 'from' into 'to' on both sides
+	int occurrence = 0;
+	for (int p = 0; p < predecessor_index; p++) {
+		if (to->predecessors[p] == from) occurrence++;
+	}
+
+	int slot = -1;
+	for (int s = 0; s < from->num_successors; s++) {
+		if (from->successors[s] == to && occurrence-- == 0) {
+			slot = s;
+			break;
+		}
+	}
+	assert(slot != -1);
+
+	int index = 0;
+	while (cfg->all_blocks[index] != from) index++;
+
+	BasicBlock* block = create_basic_block(ctx);
+	assert(block);
+
+	// 'link_function_cfgs' adds the fall through edge first
+	if (slot == 0 && index + 1 < cfg->num_blocks && cfg->all_blocks[index + 1] == to) {
+		insert_block_into_cfg(ctx, cfg, index + 1, block);
+	} else {
+		TACInstruction* target = to->instructions[0];
+		assert(target->kind == TAC_LABEL);
+
+		OperandValue label = {.label_name = generate_label(ctx, REG_LABEL)};
+		OperandValue target_label = {.label_name = target->result->value.label_name};
+		add_instruction_to_block(ctx, block, create_tac(ctx, TAC_LABEL, create_operand(ctx, OP_LABEL, label, TYPE_UNKNOWN), NULL, NULL));
+		add_instruction_to_block(ctx, block, create_tac(ctx, TAC_GOTO, create_operand(ctx, OP_LABEL, target_label, TYPE_UNKNOWN), NULL, NULL));
+
+		TACInstruction* branch = from->instructions[from->num_instructions - 1];
+		assert(branch->kind == TAC_IF_FALSE);
+		branch->op2 = create_operand(ctx, OP_LABEL, label, TYPE_UNKNOWN);
+
+		// nothing may fall into it, so it goes after a block that jumps or
+		// returns, furthest down
+		int position = cfg->num_blocks;
+		while (position > 0) {
+			BasicBlock* previous = cfg->all_blocks[position - 1];
+			if (previous->num_instructions > 0) {
+				tac_t kind = previous->instructions[previous->num_instructions - 1]->kind;
+				if (kind == TAC_GOTO || kind == TAC_RETURN) break;
+			}
+			position--;
+		}
+		if (position == 0) position = cfg->num_blocks;
+		insert_block_into_cfg(ctx, cfg, position, block);
+	}
+
+	block->predecessors[block->num_predecessors++] = from;
+	block->successors[block->num_successors++] = to;
+	from->successors[slot] = block;
+	to->predecessors[predecessor_index] = block;
+	ssa->split_edges++;
+	return block;
+}
+
+// copies go in front of the jump that ends the block, if there is one
+void insert_copy(CompilerContext* ctx, BasicBlock* block, Operand* dest, Operand* src) {
+	TACInstruction* copy = create_tac(ctx, TAC_ASSIGNMENT, dest, NULL, src);
+	assert(copy);
+
+	int position = block->num_instructions;
+	if (position > 0 && block->instructions[position - 1]->kind == TAC_GOTO) position--;
+	insert_instruction_into_block(ctx, block, position, copy);
+}
+
+// versions are never live at the same time as another version of their
+// variable they are copied to or from, so the copies of one edge can run
+// in any order
+void destruct_ssa(CompilerContext* ctx, FunctionInfo* info, SSABuilder* ssa) {
+	CFG* cfg = info->cfg;
+
+	if (ssa->num_phis > 0) {
+		int num_blocks = cfg->num_blocks;
+		BasicBlock** blocks = arena_allocate(ctx->ir_arena, sizeof(BasicBlock*) * num_blocks);
+		assert(blocks);
+		memcpy(blocks, cfg->all_blocks, sizeof(BasicBlock*) * num_blocks);
+
+		for (int i = 0; i < num_blocks; i++) {
+			BasicBlock* block = blocks[i];
+			int start = phi_position(block);
+			int phis = count_phis(block);
+			if (phis == 0) continue;
+
+			for (int p = 0; p < block->num_predecessors; p++) {
+				BasicBlock* predecessor = block->predecessors[p];
+				if (!predecessor->visited) continue;
+
+				TACInstruction* last = predecessor->num_instructions > 0 ? predecessor->instructions[predecessor->num_instructions - 1] : NULL;
+				if (predecessor->num_successors > 1 || (last && last->kind == TAC_IF_FALSE)) {
+					predecessor = split_edge(ctx, ssa, predecessor, p, block);
+				}
+
+				for (int k = start; k < start + phis; k++) {
+					TACInstruction* phi = block->instructions[k];
+					Operand* src = phi->phi_args[p] ? phi->phi_args[p] : phi->op1;
+					if (src == phi->result) continue;
+
+					insert_copy(ctx, predecessor, phi->result, src);
+					ssa->num_copies++;
+				}
+			}
+
+			memmove(&block->instructions[start], &block->instructions[start + phis], sizeof(TACInstruction*) * (block->num_instructions - start - phis));
+			block->num_instructions -= phis;
+		}
+	}
+
+	if (ctx->verbose) {
+		fprintf(ctx->function->report, "ssa: %s: %d variables, %d phis, %d copies, %d split edges\n",
+			info->symbol->name, ssa->variables->count, ssa->num_phis, ssa->num_copies, ssa->split_edges);
+	}
+}
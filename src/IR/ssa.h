@@ -0,0 +1,44 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "compilercontext.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+
+typedef struct {
+	CFG* cfg;
+	OperandNumbering* variables; // the local symbols assigned somewhere in the function
+	int* live_numbers; // by variable: its number in the cfg's liveness numbering
+	Operand** current; // by variable: the version that reaches the point renaming is at
+	int* versions; // by variable: versions made so far
+
+	// restores 'current' when renaming leaves a block
+	int* undo_variables;
+	Operand** undo_operands;
+	int undo_size;
+	int undo_capacity;
+
+	int num_phis;
+	int num_copies;
+	int split_edges;
+} SSABuilder;
+
+SSABuilder* create_ssa_builder(CompilerContext* ctx, CFG* cfg);
+int phi_position(BasicBlock* block);
+int count_phis(BasicBlock* block);
+bool add_entry_block(CompilerContext* ctx, CFG* cfg);
+bool is_ssa_variable(Operand* op);
+bool collect_ssa_variables(CompilerContext* ctx, SSABuilder* ssa);
+void place_phis(CompilerContext* ctx, SSABuilder* ssa);
+Operand* create_version(CompilerContext* ctx, SSABuilder* ssa, int variable);
+Operand* current_version(SSABuilder* ssa, Operand* op);
+void define_version(CompilerContext* ctx, SSABuilder* ssa, int variable, Operand** slot);
+void rename_block(CompilerContext* ctx, SSABuilder* ssa, BasicBlock* block);
+void rename_variables(CompilerContext* ctx, SSABuilder* ssa);
+SSABuilder* construct_ssa(CompilerContext* ctx, FunctionInfo* info);
+
+BasicBlock* split_edge(CompilerContext* ctx, SSABuilder* ssa, BasicBlock* from, int predecessor_index, BasicBlock* to);
+void insert_copy(CompilerContext* ctx, BasicBlock* block, Operand* dest, Operand* src);
+void destruct_ssa(CompilerContext* ctx, FunctionInfo* info, SSABuilder* ssa);
+
+#endif
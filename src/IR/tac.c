@@ -1,18 +1,11 @@
 #include "tac.h"
 #include "assert.h"
-
-static int label_counter = 0;
-static int tac_variable_index = 0;
-static int tac_parameter_index = 0;
-static int tac_function_argument_index = 0;
-static int tac_instruction_index = 0;
-
-TACTable* tac_table = NULL;
-TACContextStack tac_context_stack;
+#include "interner.h"
+#include "backend.h"
 
 bool init_tac_table(CompilerContext* ctx) {
-	tac_table = create_tac_table(ctx);
-	if (!tac_table) return false;
+	ctx->function->tac_table = create_tac_table(ctx);
+	if (!ctx->function->tac_table) return false;
 	return true;
 }
 
@@ -36,19 +29,21 @@ TACInstruction* create_tac(CompilerContext* ctx, tac_t kind, Operand* result, Op
 	if (!tac) return NULL;
 
 	tac->kind = kind;
-	tac->id = tac_instruction_index++;
+	tac->id = ctx->function->tac_instruction_index++;
 	tac->result = result;
 	tac->op1 = op1;
 	tac->op2 = op2;
+	tac->phi_args = NULL;
 
 	tac->handled = false;
 	tac->precedes_conditional = false;
+	tac->source_dies = false;
 	return tac;
 }
 
 bool init_tac_context_stack(CompilerContext* ctx) {
-	tac_context_stack = create_tac_context_stack(ctx);
-	if (!tac_context_stack.contexts) return false;
+	ctx->function->tac_context_stack = create_tac_context_stack(ctx);
+	if (!ctx->function->tac_context_stack.contexts) return false;
 	return true;
 }
 
@@ -90,18 +85,19 @@ TACContext* create_tac_context(CompilerContext* ctx, context_t type, char* next_
 	tac_context->update_label = update_label;
 	tac_context->root_chain_mem = root_chain_mem;
 
-	tac_context->parent = peek_tac_context();
+	tac_context->parent = peek_tac_context(ctx);
 
 	return tac_context;
 }
 
-TACContext* tac_context_lookup(tac_t* tac_target_types, size_t length) {
-	if (!tac_target_types || !tac_context_stack.contexts) return NULL;
+TACContext* tac_context_lookup(CompilerContext* ctx, tac_t* tac_target_types, size_t length) {
+	TACContextStack* tac_context_stack = &ctx->function->tac_context_stack;
+	if (!tac_target_types || !tac_context_stack->contexts) return NULL;
 
 	if (length <= 0) return NULL;
 			
-	for (int i = tac_context_stack.top; i >= 0; i--) {
-		TACContext* current_context = tac_context_stack.contexts[i];
+	for (int i = tac_context_stack->top; i >= 0; i--) {
+		TACContext* current_context = tac_context_stack->contexts[i];
 		if (current_context) {
 			for (int j = 0; j < length; j++) {
 				if (current_context->type == tac_target_types[j]) {
@@ -114,22 +110,23 @@ TACContext* tac_context_lookup(tac_t* tac_target_types, size_t length) {
 	return NULL;
 }
 
-bool is_tac_context_stack_empty() {
-	return tac_context_stack.top == -1;
+bool is_tac_context_stack_empty(CompilerContext* ctx) {
+	return ctx->function->tac_context_stack.top == -1;
 } 
 
 void push_tac_context(CompilerContext* ctx, TACContext* context) {
-	if (!context || !tac_context_stack.contexts) return;
+	TACContextStack* tac_context_stack = &ctx->function->tac_context_stack;
+	if (!context || !tac_context_stack->contexts) return;
 
-	if (tac_context_stack.top >= tac_context_stack.capacity) {
-		int prev_capacity = tac_context_stack.capacity;
+	if (tac_context_stack->top >= tac_context_stack->capacity) {
+		int prev_capacity = tac_context_stack->capacity;
 
-		tac_context_stack.capacity *= 2;
-		int new_capacity = tac_context_stack.capacity;
+		tac_context_stack->capacity *= 2;
+		int new_capacity = tac_context_stack->capacity;
 
 		void* new_contexts = arena_reallocate(
 			ctx->ir_arena, 
-			tac_context_stack.contexts, 
+			tac_context_stack->contexts, 
 			prev_capacity * sizeof(TACContext*), 
 			new_capacity * sizeof(TACContext*)
 		);
@@ -138,69 +135,63 @@ void push_tac_context(CompilerContext* ctx, TACContext* context) {
 			perror("In 'push_tac_context', unable to reallocate TAC contexts.\n");
 			return;
 		}
-		tac_context_stack.contexts = new_contexts;
+		tac_context_stack->contexts = new_contexts;
 	}
-	tac_context_stack.contexts[++tac_context_stack.top] = context;
+	tac_context_stack->contexts[++tac_context_stack->top] = context;
 }
 
-TACContext* peek_tac_context() {
-	if (!is_tac_context_stack_empty()) {
-		return tac_context_stack.contexts[tac_context_stack.top];
+TACContext* peek_tac_context(CompilerContext* ctx) {
+	if (!is_tac_context_stack_empty(ctx)) {
+		TACContextStack* tac_context_stack = &ctx->function->tac_context_stack;
+		return tac_context_stack->contexts[tac_context_stack->top];
 	}
 	return NULL;
 }
 
-void pop_tac_context() {
-	if (!is_tac_context_stack_empty()) {
-		tac_context_stack.top--;
+void pop_tac_context(CompilerContext* ctx) {
+	if (!is_tac_context_stack_empty(ctx)) {
+		ctx->function->tac_context_stack.top--;
 	}
 }
 
-void reset_context_stack() {
-	if (!is_tac_context_stack_empty()) {
-		while (tac_context_stack.top >= 0) {
-			tac_context_stack.top--;
+void reset_context_stack(CompilerContext* ctx) {
+	if (!is_tac_context_stack_empty(ctx)) {
+		while (ctx->function->tac_context_stack.top >= 0) {
+			ctx->function->tac_context_stack.top--;
 		}
 	}
 }
 
+// temporaries only need to be unique within their function, but .L labels
+// end up in one listing, so they carry the function's name
 char* generate_label(CompilerContext* ctx, LabelKind kind) {
-	char buffer[52];
+	FunctionContext* function = ctx->function;
+	char buffer[160];
 
 	switch (kind) {
 		case VIRTUAL: {
-			snprintf(buffer, sizeof(buffer), "t%d", tac_variable_index++);
+			snprintf(buffer, sizeof(buffer), "t%d", function->tac_variable_index++);
 			break;
 		}
 
 		case ARG_LABEL: {
-			snprintf(buffer, sizeof(buffer), "a%d", tac_function_argument_index++);
+			snprintf(buffer, sizeof(buffer), "a%d", function->tac_function_argument_index++);
 			break;
 		}
 
 		case PARAM_LABEL: {
-			snprintf(buffer, sizeof(buffer), "p%d", tac_parameter_index++);
+			snprintf(buffer, sizeof(buffer), "p%d", function->tac_parameter_index++);
 			break;
 		}
 
 		case REG_LABEL: {
-			snprintf(buffer, sizeof(buffer), ".L%d", label_counter++);
+			snprintf(buffer, sizeof(buffer), ".L%s_%d", function->name, function->label_counter++);
 			break;
 		}
 	}
 
-
-	char* label = NULL;
-	if (buffer) {
-		int length = strlen(buffer);
-		label = arena_allocate(ctx->ir_arena, length + 1);
-		if (!label) return NULL;
-		
-		strncpy(label, buffer, length);
-		label[length] = '\0';
-	} 
-	return label;
-} 
+	return intern(ctx, buffer);
+}
 
 char* tac_function_name(CompilerContext* ctx, char* function_name) {
 	if (!function_name) return NULL;
@@ -213,6 +204,7 @@ char* tac_function_name(CompilerContext* ctx, char* function_name) {
 }
 
 void add_tac_to_table(CompilerContext* ctx, TACInstruction* tac) {
+	TACTable* tac_table = ctx->function->tac_table;
 	if (!tac || !tac_table) return;
 
 	if (tac_table->size >= tac_table->capacity) {
@@ -346,17 +338,8 @@ Operand* create_operand(CompilerContext* ctx, operand_t kind, OperandValue value
 		case OP_UNARY_SUB:
 		case OP_NOT:
 		case OP_STORE: {
-			if (value.label_name) {
-				int length = strlen(value.label_name);
-				char* copy = arena_allocate(ctx->ir_arena, length + 1);
-				if (!copy) return NULL;
-
-				strncpy(copy, value.label_name, length);
-				copy[length] = '\0';
-				operand->value.label_name = copy;
-			} else {
-				operand->value.label_name = NULL;
-			}
+			// labels come from generate_label and are already interned
+			operand->value.label_name = value.label_name;
 			break;
 		}
 
@@ -393,23 +376,23 @@ TACInstruction* build_tac_from_array_dagnode(CompilerContext* ctx, Node* array_i
 	OperandValue array_subtype_val;
 	Operand* array_subtype_op = NULL;
 	if (array_identifier->left) {
-		array_subtype_val.label_name = convert_subtype_to_string(array_identifier->left->t);
+		array_subtype_val.label_name = convert_subtype_to_string(node_datatype(ctx, node_left(ctx, array_identifier)));
 		array_subtype_op = create_operand(ctx, OP_SUBTYPE_STR, array_subtype_val, TYPE_INTEGER);
 	}
 
 	OperandValue array_identifier_val;
 	Operand* array_identifier_op = NULL;
 	if (array_identifier->left) {
-		array_identifier_val.sym = array_identifier->left->symbol;
-		Type* t = ((Symbol*)array_identifier->left->symbol)->type;
+		array_identifier_val.sym = node_symbol(ctx, node_left(ctx, array_identifier));
+		Type* t = ((Symbol*)node_symbol(ctx, node_left(ctx, array_identifier)))->type;
 		TypeKind type = t->kind;
 		array_identifier_op = create_operand(ctx, OP_SYMBOL, array_identifier_val, type);
 	}
 
 	int i = 0;
-	Node* element = array_list->right;
+	Node* element = node_right(ctx, array_list);
 	while (element) {
-		Node* next_element = element->next;
+		Node* next_element = node_next(ctx, element);
 
 		OperandValue element_index_val = { 
 			.label_name = generate_label(ctx, VIRTUAL) 
@@ -433,7 +416,7 @@ TACInstruction* build_tac_from_array_dagnode(CompilerContext* ctx, Node* array_i
 		add_tac_to_table(ctx, pos_tac);
 
 		OperandValue element_val = { 
-			.int_val = element->value.val 
+			.int_val = element->value 
 		};
 		Operand* element_op = create_operand(ctx, OP_INT_LITERAL, element_val, TYPE_INTEGER);
 
@@ -517,8 +500,8 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 		case NODE_DIV:
 		case NODE_MODULO: {
 			tac_t kind = get_tac_type(node->type);
-			TACInstruction* left = build_tac_from_expression_dag(ctx, node->left);
-			TACInstruction* right = build_tac_from_expression_dag(ctx, node->right);
+			TACInstruction* left = build_tac_from_expression_dag(ctx, node_left(ctx, node));
+			TACInstruction* right = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 
 			if (!left || (left && !left->result)) {
 				printf("\033[31mProcessing node type %d, left or left result is NULL\n", node->type);
@@ -549,8 +532,8 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 		case NODE_LOGICAL_OR:
 		case NODE_LOGICAL_AND: {
 			tac_t kind = get_tac_type(node->type);
-			TACInstruction* left = build_tac_from_expression_dag(ctx, node->left);
-			TACInstruction* right = build_tac_from_expression_dag(ctx, node->right);
+			TACInstruction* left = build_tac_from_expression_dag(ctx, node_left(ctx, node));
+			TACInstruction* right = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 
 			if (!left || !right) return NULL;
 			OperandValue main_operand_value = {
@@ -566,7 +549,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 
 		case NODE_UNARY_ADD:
 		case NODE_UNARY_SUB: {
-			TACInstruction* unary_tac = build_tac_from_expression_dag(ctx, node->right);
+			TACInstruction* unary_tac = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 			if (!unary_tac) return NULL;
 
 			OperandValue val = {
@@ -583,7 +566,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 		}
 
 		case NODE_NOT: {
-			TACInstruction* unary_tac = build_tac_from_expression_dag(ctx, node->right);
+			TACInstruction* unary_tac = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 			if (!unary_tac) return NULL;
 
 			OperandValue val = {
@@ -607,7 +590,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 			Operand* left_operand = create_operand(ctx, OP_STORE, tac_variable_union, node_to_type(node->type));
 
 			OperandValue buffer_union = {
-				.int_val = node->value.val,
+				.int_val = node->value,
 			};
 			Operand* right_operand = create_operand(ctx, OP_INT_LITERAL, buffer_union, TYPE_INTEGER);
 			
@@ -624,17 +607,17 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 			Node* int_node = create_int_node(ctx, NODE_INTEGER, 1, NULL, NULL, NULL, NULL, NULL, NULL);
 
 			node_t kind = (node->type == NODE_INCREMENT) ? NODE_ADD : NODE_SUB;
-			Node* op_node = create_node(ctx, kind, node->left, int_node, NULL, NULL, NULL, NULL);
+			Node* op_node = create_node(ctx, kind, node_left(ctx, node), int_node, NULL, NULL, NULL, NULL);
 			
 			TACInstruction* tac = build_tac_from_expression_dag(ctx, op_node);
-			build_tac_from_expression_dag(ctx, node->left);
+			build_tac_from_expression_dag(ctx, node_left(ctx, node));
 			
 			if (!tac || (tac && !tac->result)) return NULL;
 
 			OperandValue res_val;
 			Operand* res_op = NULL;
 			if (node->left) {
-				res_val.sym = node->left->symbol;
+				res_val.sym = node_symbol(ctx, node_left(ctx, node));
 				res_op = create_operand(ctx, OP_SYMBOL, res_val, TYPE_INTEGER);
 			}
 
@@ -648,7 +631,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 		case NODE_AUG:
 		case NODE_DECL:
 		case NODE_DEF: {
-			result = build_tac_from_expression_dag(ctx, node->left);
+			result = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 			if (!result) {
 				printf("\033[31mNODE_DEF/DECL/AUG NULL\033[0m\n");
 			}
@@ -659,22 +642,22 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 			OperandValue sym_val;
 			Operand* sym_op = NULL;
 			
-			if (node->symbol && ((Symbol*)node->symbol)->type) {
-				sym_val.sym = node->symbol;
-				Type* t = ((Symbol*)node->symbol)->type;
+			if (node_symbol(ctx, node) && ((Symbol*)node_symbol(ctx, node))->type) {
+				sym_val.sym = node_symbol(ctx, node);
+				Type* t = ((Symbol*)node_symbol(ctx, node))->type;
 				sym_op = create_operand(ctx, OP_SYMBOL, sym_val, t->kind);
 			}
 
 			Operand* existing_sym_op = NULL;
 			if (sym_op) {
-				existing_sym_op = find_operand_in_op_set(tac_table->op_names, sym_op);
+				existing_sym_op = find_operand_in_op_set(ctx->function->tac_table->op_names, sym_op);
 			}
 
 			if (existing_sym_op) {
 				result = create_tac(ctx, TAC_NAME, existing_sym_op, NULL, NULL);
 			} else {
 				result = create_tac(ctx, TAC_NAME, sym_op, NULL, NULL);
-				add_to_operand_set(ctx, tac_table->op_names, sym_op);
+				add_to_operand_set(ctx, ctx->function->tac_table->op_names, sym_op);
 			}
 			break;
 		}
@@ -685,7 +668,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 			};
 			Operand* left_operand = create_operand(ctx, OP_ARG, arg_value_label, TYPE_UNKNOWN);
 
-			TACInstruction* arg = build_tac_from_expression_dag(ctx, node->right);
+			TACInstruction* arg = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 			if (!arg || (arg && !arg->result)) {
 				return NULL;
 			}
@@ -697,9 +680,9 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 		case NODE_CALL: {
 			TACTable* arg_table = create_tac_table(ctx);
 
-			Node* arg = node->params;
+			Node* arg = node_params(ctx, node);
 			while (arg) {
-				Node* next_arg = arg->next;
+				Node* next_arg = node_next(ctx, arg);
 				TACInstruction* tac = build_tac_from_expression_dag(ctx, arg);
 				if (tac) {
 					add_to_local_table(ctx, arg_table, tac);
@@ -707,7 +690,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 				arg = next_arg;
 			}
 
-			tac_function_argument_index = 0;
+			ctx->function->tac_function_argument_index = 0;
 
 			for (int i = 0; i < arg_table->size; i++) {
 				TACInstruction* tac_arg = arg_table->tacs[i];
@@ -716,7 +699,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 				} 
 			}
 
-			TACInstruction* function_name = build_tac_from_expression_dag(ctx, node->left);
+			TACInstruction* function_name = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 			if (!function_name) return NULL;
 
 			TACInstruction* tac_call = create_tac(ctx, TAC_CALL, function_name->result, NULL, NULL);
@@ -726,14 +709,16 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 				.label_name = generate_label(ctx, VIRTUAL)
 			};
 
+			// the result has the callee's return type
 			Type* t = NULL;
-			if ((Symbol*)node->symbol) {
-				t = ((Symbol*)node->symbol)->type;
+			Symbol* callee = node_symbol(ctx, node_left(ctx, node));
+			if (callee && callee->type) {
+				t = callee->type->subtype;
 			}
 			Operand* function_label_operand = create_operand(ctx, OP_STORE, func_return_val, t ? t->kind : TYPE_UNKNOWN);
 
 			OperandValue _return_label = {
-				.label_name = "_RET"
+				.label_name = intern(ctx, "_RET")
 			};
 			Operand* _return_operand = create_operand(ctx, OP_RETURN, _return_label, TYPE_UNKNOWN);
 
@@ -745,12 +730,12 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 		}
 
 		case NODE_SUBSCRIPT: {
-			TACInstruction* array_tac = build_tac_from_expression_dag(ctx, node->left);
-			TACInstruction* index_tac = build_tac_from_expression_dag(ctx, node->right);
+			TACInstruction* array_tac = build_tac_from_expression_dag(ctx, node_left(ctx, node));
+			TACInstruction* index_tac = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 
 			if (!array_tac || !index_tac) return NULL;
 
-			OperandValue array_val = { .label_name = convert_subtype_to_string(node->t) };
+			OperandValue array_val = { .label_name = convert_subtype_to_string(node_datatype(ctx, node)) };
 			Operand* op_array_val = create_operand(ctx, OP_SUBTYPE_STR, array_val, TYPE_INTEGER);
 
 
@@ -769,7 +754,7 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node)
 			add_tac_to_table(ctx, address_tac);
 
 			OperandValue store_val = { .label_name = generate_label(ctx, VIRTUAL) };
-			Type* t = ((Symbol*)node->symbol)->type;
+			Type* t = ((Symbol*)node_symbol(ctx, node))->type;
 			Operand* store_op = create_operand(ctx, OP_STORE, store_val, t ? t->kind : TYPE_UNKNOWN);
 			
 			TACInstruction* dereference_tac = create_tac(ctx, TAC_DEREFERENCE, store_op, op_add, NULL);
@@ -806,8 +791,8 @@ void emit_goto(CompilerContext* ctx, char* target) {
 	add_tac_to_table(ctx, tac);
 }
 
-bool determine_if_next_conditional(Node* node, bool has_next_statement) {
-	return has_next_statement && (node->next->type == NODE_ELSE_IF || node->next->type == NODE_ELSE);
+bool determine_if_next_conditional(CompilerContext* ctx, Node* node, bool has_next_statement) {
+	return has_next_statement && (node_next(ctx, node)->type == NODE_ELSE_IF || node_next(ctx, node)->type == NODE_ELSE);
 }
 
 void set_end_label_based_on_context(TACContext* context, char** end_label) {
@@ -840,19 +825,19 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 
 	switch (node->type) {
 		case NODE_ASSIGNMENT: {
-			if (node->right && node->right->type == NODE_ARRAY_LIST) {
-				build_tac_from_array_dagnode(ctx, node->left, node->right);
+			if (node_right(ctx, node) && node_right(ctx, node)->type == NODE_ARRAY_LIST) {
+				build_tac_from_array_dagnode(ctx, node_left(ctx, node), node_right(ctx, node));
 
-			} else if (node->left->type == NODE_AUG) {
-				if (node->left->left && node->left->left->type == NODE_SUBSCRIPT) {
-					TACInstruction* right = build_tac_from_expression_dag(ctx, node->right);
+			} else if (node_left(ctx, node)->type == NODE_AUG) {
+				if (node_left(ctx, node_left(ctx, node)) && node_left(ctx, node_left(ctx, node))->type == NODE_SUBSCRIPT) {
+					TACInstruction* right = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 
-					TACInstruction* array_tac = build_tac_from_expression_dag(ctx, node->left->left->left);
-					TACInstruction* index_tac = build_tac_from_expression_dag(ctx, node->left->left->right);
+					TACInstruction* array_tac = build_tac_from_expression_dag(ctx, node_left(ctx, node_left(ctx, node_left(ctx, node))));
+					TACInstruction* index_tac = build_tac_from_expression_dag(ctx, node_right(ctx, node_left(ctx, node_left(ctx, node))));
 					if (!array_tac || !index_tac) return;
 
 
-					OperandValue array_val = { .label_name = convert_subtype_to_string(node->left->left->t) };
+					OperandValue array_val = { .label_name = convert_subtype_to_string(node_datatype(ctx, node_left(ctx, node_left(ctx, node)))) };
 					Operand* op_array_val = create_operand(ctx, OP_SUBTYPE_STR, array_val, TYPE_UNKNOWN);
 					if (!op_array_val) return;
 
@@ -884,8 +869,8 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 					}
 
 				} else {
-					TACInstruction* left_instruction = build_tac_from_expression_dag(ctx, node->left);
-					TACInstruction* right_instruction = build_tac_from_expression_dag(ctx, node->right);
+					TACInstruction* left_instruction = build_tac_from_expression_dag(ctx, node_left(ctx, node));
+					TACInstruction* right_instruction = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 					
 					if (!left_instruction) {
 						printf("\033[31mIn NODE_ASSIGNMENT Case -> left instruction is NULL\033[0m\n");
@@ -909,13 +894,13 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 				}
 				
 			} else {
-				TACInstruction* left = build_tac_from_expression_dag(ctx, node->left);
+				TACInstruction* left = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 				if (!left) {
 					printf("\033[31mIn NODE_ASSIGNMENT Case -> left instruction is NULL\033[0m\n");
 					return;
 				}
 
-				TACInstruction* right = build_tac_from_expression_dag(ctx, node->right);
+				TACInstruction* right = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 				if (!right) {
 					printf("\033[31mIn NODE_ASSIGNMENT Case -> right instruction is NULL\033[0m\n");
 					return;
@@ -935,14 +920,14 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_CALL: {
-			Node* arg = node->right;
+			Node* arg = node_right(ctx, node);
 			while (arg) {
-				Node* next_arg = arg->next;
+				Node* next_arg = node_next(ctx, arg);
 				build_tac_from_expression_dag(ctx, arg);
 				arg = next_arg;
 			}
 
-			TACInstruction* function_name = build_tac_from_expression_dag(ctx, node->left);
+			TACInstruction* function_name = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 			if (!function_name) return NULL;
 
 			TACInstruction* tac_call = create_tac(ctx, TAC_CALL, function_name->result, NULL, NULL);
@@ -951,8 +936,8 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_IF: {
-		    bool has_next_statement = node->next != NULL;
-		    bool has_next_conditional = determine_if_next_conditional(node, has_next_statement);
+		    bool has_next_statement = node_next(ctx, node) != NULL;
+		    bool has_next_conditional = determine_if_next_conditional(ctx, node, has_next_statement);
 		    
 		    char* if_false_label = NULL;
 		    char* next_jmp_label = NULL;
@@ -976,7 +961,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		    
 		    push_tac_context(ctx, context_if);
 
-		    TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, node->left);
+		    TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 		    if (!condition_tac) return;
 
 		    char* jump_target = NULL;
@@ -991,7 +976,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		    emit_if_false(ctx, condition_tac->result, jump_target);
 
 		    if (node->right) {
-		        build_tac_from_statement_dag(ctx, node->right);
+		        build_tac_from_statement_dag(ctx, node_right(ctx, node));
 		    }
 
 		    if (has_next_conditional) {
@@ -1008,11 +993,11 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_ELSE_IF: {
-		    TACContext* retrieved_context = peek_tac_context();
+		    TACContext* retrieved_context = peek_tac_context(ctx);
 		    if (!retrieved_context) return;
 
-		    bool has_next_statement = node->next != NULL;
-		    bool has_next_conditional = determine_if_next_conditional(node, has_next_statement);
+		    bool has_next_statement = node_next(ctx, node) != NULL;
+		    bool has_next_conditional = determine_if_next_conditional(ctx, node, has_next_statement);
 
 		    char* if_false_label = NULL;
 		    char* next_jmp_label = NULL;
@@ -1038,7 +1023,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 
 		    emit_label(ctx, retrieved_context->next_label);
 
-		    TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, node->left);
+		    TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 		    if (!condition_tac) return;
 
 		    char* jump_target = NULL;
@@ -1053,7 +1038,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		    emit_if_false(ctx, condition_tac->result, jump_target);
 
 		    if (node->right) {
-		        build_tac_from_statement_dag(ctx, node->right);
+		        build_tac_from_statement_dag(ctx, node_right(ctx, node));
 		    }
 
 		    if (has_next_conditional) {
@@ -1074,10 +1059,10 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_ELSE: {
-		    TACContext* retrieved_context = peek_tac_context();
+		    TACContext* retrieved_context = peek_tac_context(ctx);
 		    if (!retrieved_context) return;
 
-		    bool has_next_statement = node->next != NULL;
+		    bool has_next_statement = node_next(ctx, node) != NULL;
 		    char* next_jmp_label = NULL;
 		    if (has_next_statement) {
 		        next_jmp_label = generate_label(ctx, REG_LABEL);
@@ -1097,7 +1082,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		    emit_label(ctx, retrieved_context->next_label);
 
 		    if (node->right) {
-		        build_tac_from_statement_dag(ctx, node->right);
+		        build_tac_from_statement_dag(ctx, node_right(ctx, node));
 		    }
 
 		    if (has_next_statement) {
@@ -1129,13 +1114,13 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 
 			emit_label(ctx, loop_start_label);
 
-			TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, node->left);
+			TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 			if (!condition_tac) return;
 
 			emit_if_false(ctx, condition_tac->result, end_label);				
 
 			if (node->right) {
-				build_tac_from_statement_dag(ctx, node->right);
+				build_tac_from_statement_dag(ctx, node_right(ctx, node));
 			}
 
 			emit_goto(ctx, loop_start_label);
@@ -1160,23 +1145,23 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 			);
 			push_tac_context(ctx, context);
 
-			Node* initializer_node = node->left ? node->left : NULL;
+			Node* initializer_node = node_left(ctx, node) ? node_left(ctx, node) : NULL;
 			build_tac_from_statement_dag(ctx, initializer_node);
 
 			emit_label(ctx, loop_start_label);
 
-			Node* condition_node = initializer_node ? initializer_node->next : NULL;
+			Node* condition_node = initializer_node ? node_next(ctx, initializer_node) : NULL;
 			TACInstruction* condition_tac = build_tac_from_expression_dag(ctx, condition_node);
 			if (!condition_tac) return;
 
 			emit_if_false(ctx, condition_tac->result, end_label);
 
 			if (node->right) {
-				build_tac_from_statement_dag(ctx, node->right); 
+				build_tac_from_statement_dag(ctx, node_right(ctx, node)); 
 			}
 				
 			emit_label(ctx, update_label);
-			Node* update_node = condition_node ? condition_node->next : NULL;
+			Node* update_node = condition_node ? node_next(ctx, condition_node) : NULL;
 			build_tac_from_statement_dag(ctx, update_node);
 			emit_goto(ctx, loop_start_label);
 			emit_label(ctx, end_label);
@@ -1188,7 +1173,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		case NODE_RETURN: {
 			TACInstruction* result = NULL;
 			if (node->right) {
-				TACInstruction* tac = build_tac_from_expression_dag(ctx, node->right);
+				TACInstruction* tac = build_tac_from_expression_dag(ctx, node_right(ctx, node));
 				OperandValue val = { .label_name = generate_label(ctx, VIRTUAL)};
 				Operand* storage = create_operand(ctx, OP_STORE, val, tac && tac->result ? tac->result->type : TYPE_UNKNOWN);
 				result = create_tac(
@@ -1212,10 +1197,10 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 			if (!int_node) return;
 
 			node_t kind = (node->type == NODE_INCREMENT) ? NODE_ADD : NODE_SUB;
-			Node* op_node = create_node(ctx, kind, node->left, int_node, NULL, NULL, NULL, NULL);	
+			Node* op_node = create_node(ctx, kind, node_left(ctx, node), int_node, NULL, NULL, NULL, NULL);	
 
 			TACInstruction* tac_arithmetic = build_tac_from_expression_dag(ctx, op_node);
-			TACInstruction* tac_var = build_tac_from_expression_dag(ctx, node->left);
+			TACInstruction* tac_var = build_tac_from_expression_dag(ctx, node_left(ctx, node));
 			if (!tac_arithmetic || !tac_var) return;
 			TACInstruction* tac_assignment = create_tac(
 				ctx, 
@@ -1229,7 +1214,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_BREAK: {
-			TACContext* retrieved_context = peek_tac_context();
+			TACContext* retrieved_context = peek_tac_context(ctx);
 
 			TACContext* loop_context = context_loop_lookup(retrieved_context);
 			if (loop_context) {
@@ -1239,7 +1224,7 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_CONTINUE: {
-			TACContext* retrieved_context = peek_tac_context();
+			TACContext* retrieved_context = peek_tac_context(ctx);
 
 			TACContext* loop_context = context_loop_lookup(retrieved_context);
 			if (loop_context) {
@@ -1249,9 +1234,9 @@ void build_tac_from_statement_dag(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_BLOCK: {
-			Node* stmt = node->right;
+			Node* stmt = node_right(ctx, node);
 			while (stmt) {
-				Node* next_stmt = stmt->next;
+				Node* next_stmt = node_next(ctx, stmt);
 				build_tac_from_statement_dag(ctx, stmt);
 				stmt = next_stmt;
 			}
@@ -1267,12 +1252,12 @@ void build_tac_from_parameter_dag(CompilerContext* ctx, Node* wrapped_param) {
 	
 	Node* current_wrapped_param = wrapped_param;
 	while (current_wrapped_param) {
-		Node* next_wrapped_param = current_wrapped_param->next;
+		Node* next_wrapped_param = node_next(ctx, current_wrapped_param);
 
 		OperandValue parameter_val = { .label_name = generate_label(ctx, PARAM_LABEL) };
 		Operand* parameter_op = create_operand(ctx, OP_LABEL, parameter_val, TYPE_UNKNOWN);
 
-		TACInstruction* param_instruction = build_tac_from_expression_dag(ctx, current_wrapped_param->right);
+		TACInstruction* param_instruction = build_tac_from_expression_dag(ctx, node_right(ctx, current_wrapped_param));
 		if (param_instruction) {
 			result = create_tac(ctx, TAC_PARAM, parameter_op, param_instruction->result, NULL);
 			add_tac_to_table(ctx, result);
@@ -1282,10 +1267,12 @@ void build_tac_from_parameter_dag(CompilerContext* ctx, Node* wrapped_param) {
 	}
 }
 
-void reset_tac_indices() {
-	tac_instruction_index = 0;
-	tac_parameter_index = 0;
-	tac_function_argument_index = 0;
+void reset_tac_indices(CompilerContext* ctx) {
+	ctx->function->label_counter = 0;
+	ctx->function->tac_variable_index = 0;
+	ctx->function->tac_instruction_index = 0;
+	ctx->function->tac_parameter_index = 0;
+	ctx->function->tac_function_argument_index = 0;
 }
 
 void build_tac_from_global_dag(CompilerContext* ctx, Node* node) {
@@ -1293,25 +1280,26 @@ void build_tac_from_global_dag(CompilerContext* ctx, Node* node) {
 
 	switch (node->type) {
 		case NODE_NAME: {
-			Symbol* sym = node->symbol;
+			Symbol* sym = node_symbol(ctx, node);
 			if (sym) {
 				if (sym->type) {
 					Type* t = sym->type;
 					if (t->kind == TYPE_FUNCTION) {
-						reset_tac_indices();
-						reset_context_stack();
+						ctx->function->name = sym->name;
+						reset_tac_indices(ctx);
+						reset_context_stack(ctx);
 						
 						Operand* func_op = NULL;
-						if (node->symbol) {
-							OperandValue func_val = {.sym = node->symbol};
+						if (node_symbol(ctx, node)) {
+							OperandValue func_val = {.sym = node_symbol(ctx, node)};
 							func_op = create_operand(ctx, OP_SYMBOL, func_val, t->kind);
 						}
 						if (func_op) {
 							TACInstruction* tac_function = create_tac(ctx, TAC_NAME, func_op, NULL, NULL);
 							add_tac_to_table(ctx, tac_function);
 							
-							build_tac_from_parameter_dag(ctx, node->params);
-							build_tac_from_statement_dag(ctx, node->right);
+							build_tac_from_parameter_dag(ctx, node_params(ctx, node));
+							build_tac_from_statement_dag(ctx, node_right(ctx, node));
 						}
 					}
 				} 
@@ -1321,23 +1309,39 @@ void build_tac_from_global_dag(CompilerContext* ctx, Node* node) {
 	}
 }
 
+// lowers the whole program into one table; compile_functions lowers one
+// function at a time through build_function_tacs instead
 TACTable* build_tacs(CompilerContext* ctx, Node* node) {
 	if (!node) return NULL;
 
+	if (!ctx->function) {
+		ctx->function = create_function_context(ctx, NULL);
+		if (!ctx->function) return NULL;
+	}
+
 	if (!init_tac_table(ctx)) return NULL;
 
 	if (!init_tac_context_stack(ctx)) return NULL;
 
 	Node* current = node;
 	while (current) {
-		Node* next = current->next;
+		Node* next = node_next(ctx, current);
 		build_tac_from_global_dag(ctx, current);
 		current = next;
 	}
 
-	// emit_tac_instructions();
+	// emit_tac_instructions(ctx);
+
+	return ctx->function->tac_table;
+}
+
+TACTable* build_function_tacs(CompilerContext* ctx) {
+	if (!init_tac_table(ctx)) return NULL;
+
+	if (!init_tac_context_stack(ctx)) return NULL;
 
-	return tac_table;
+	build_tac_from_global_dag(ctx, ctx->function->node);
+	return ctx->function->tac_table;
 }
 
 char* get_tac_op(TACInstruction* tac) {
@@ -1364,6 +1368,7 @@ char* get_tac_op(TACInstruction* tac) {
 		case TAC_LOGICAL_AND: return "&&";
 		case TAC_LOGICAL_OR: return "||";
 		case TAC_MODULO: return "%";
+		case TAC_PHI: return "phi";
 	}
 }
 
@@ -1389,7 +1394,8 @@ bool is_op(operand_t type) {
 	}
 }
 
-void emit_tac_instructions() {
+void emit_tac_instructions(CompilerContext* ctx) {
+	TACTable* tac_table = ctx->function->tac_table;
 	if (!tac_table || (tac_table && !tac_table->tacs)) return;
 	
 	for (int i = 0; i < tac_table->size; i++) {
@@ -1720,6 +1726,8 @@ void emit_tac_instructions() {
 					}
 					break;
 				}
+
+				case TAC_PHI: assert(false && "phis are never in the tac table"); break;
 			}
 		}
 	}
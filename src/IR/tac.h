@@ -168,7 +168,8 @@ typedef enum {
 	TAC_DEREFERENCE_AND_ASSIGN,
 	TAC_UNARY_ADD,
 	TAC_UNARY_SUB,
-	TAC_FUNCTION_RET_VAL
+	TAC_FUNCTION_RET_VAL,
+	TAC_PHI // only between construct_ssa and destruct_ssa
 } tac_t;
 
 typedef struct {
@@ -177,10 +178,12 @@ typedef struct {
 	bool handled; 
 	
 	bool precedes_conditional; // for inteference graph
+	bool source_dies; // copy whose op2 is not live afterwards, so it may share a register
 
 	Operand* result;
 	Operand* op1;
 	Operand* op2;
+	Operand** phi_args; // TAC_PHI: one per predecessor, in the block's order; op1 is the variable
 	
 	OperandSet* live_out;
 } TACInstruction;
@@ -211,7 +214,7 @@ typedef struct {
 
 void add_to_local_table(CompilerContext* ctx, TACTable* local_table, TACInstruction* tac);
 
-bool determine_if_next_conditional(Node* node, bool has_next_statement);
+bool determine_if_next_conditional(CompilerContext* ctx, Node* node, bool has_next_statement);
 void emit_label(CompilerContext* ctx, char* label);
 void emit_if_false(CompilerContext* ctx, Operand* condition, char* target);
 void emit_goto(CompilerContext* ctx, char* target);
@@ -231,9 +234,10 @@ TACInstruction* build_tac_from_array_dagnode(CompilerContext* ctx, Node* array_i
 
  
 TACContext* context_loop_lookup(TACContext* starting_context);
-TACContext* peek_tac_context();
-bool is_tac_context_stack_empty();
-void pop_tac_context();
+TACContext* tac_context_lookup(CompilerContext* ctx, tac_t* tac_target_types, size_t length);
+TACContext* peek_tac_context(CompilerContext* ctx);
+bool is_tac_context_stack_empty(CompilerContext* ctx);
+void pop_tac_context(CompilerContext* ctx);
 void push_tac_context(CompilerContext* ctx, TACContext* context);
 
 TACContext* create_tac_context(CompilerContext* ctx, context_t type, 
@@ -255,8 +259,8 @@ TACTable* create_tac_table(CompilerContext* ctx);
 
 void set_end_label_based_on_context(TACContext* context, char** end_label);
 
-void reset_context_stack();
-void reset_tac_indices();
+void reset_context_stack(CompilerContext* ctx);
+void reset_tac_indices(CompilerContext* ctx);
 
 Operand* find_operand_in_op_set(OperandSet* op_set, Operand* sym_op);
 
@@ -265,7 +269,8 @@ TACInstruction* build_tac_from_expression_dag(CompilerContext* ctx, Node* node);
 void build_tac_from_statement_dag(CompilerContext* ctx, Node* node);
 void build_tac_from_global_dag(CompilerContext* ctx, Node* node);
 TACTable* build_tacs(CompilerContext* ctx, Node* node);
+TACTable* build_function_tacs(CompilerContext* ctx);
 
 char* get_tac_op(TACInstruction* tac);
-void emit_tac_instructions();
+void emit_tac_instructions(CompilerContext* ctx);
 #endif
\ No newline at end of file
@@ -3,8 +3,36 @@
 #include "token.h"
 #include "assert.h"
 #include "errors.h"
-
-Lexer* initialize_lexer(CompilerContext* ctx, FileInfo* info) {
+#include "interner.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// every byte the main loop can see; bytes not listed are skipped
+const unsigned char char_classes[256] = {
+	['\t'] = CHAR_SPACE, ['\n'] = CHAR_SPACE, ['\v'] = CHAR_SPACE,
+	['\f'] = CHAR_SPACE, ['\r'] = CHAR_SPACE, [' '] = CHAR_SPACE,
+
+	['a' ... 'z'] = CHAR_ALPHA, ['A' ... 'Z'] = CHAR_ALPHA,
+	['0' ... '9'] = CHAR_DIGIT,
+	['_'] = CHAR_UNDERSCORE,
+
+	['='] = CHAR_OPERATOR, ['+'] = CHAR_OPERATOR, ['-'] = CHAR_OPERATOR,
+	['*'] = CHAR_OPERATOR, ['/'] = CHAR_OPERATOR, ['<'] = CHAR_OPERATOR,
+	['!'] = CHAR_OPERATOR, ['&'] = CHAR_OPERATOR, ['>'] = CHAR_OPERATOR,
+	['|'] = CHAR_OPERATOR, ['%'] = CHAR_OPERATOR,
+
+	['\''] = CHAR_DELIMITER, [':'] = CHAR_DELIMITER, ['('] = CHAR_DELIMITER,
+	[')'] = CHAR_DELIMITER, ['['] = CHAR_DELIMITER, [']'] = CHAR_DELIMITER,
+	['{'] = CHAR_DELIMITER, ['}'] = CHAR_DELIMITER, [','] = CHAR_DELIMITER,
+	['"'] = CHAR_DELIMITER, [';'] = CHAR_DELIMITER
+};
+
+Lexer* initialize_lexer(CompilerContext* ctx, FileInfo* info, bool streaming) {
 	Lexer* lexer = arena_allocate(ctx->lexer_arena, sizeof(Lexer));
 	if (!lexer) {
 		fprintf(stderr, "Error: Failed to allocate space for lexer\n");
@@ -13,12 +41,19 @@ Lexer* initialize_lexer(CompilerContext* ctx, FileInfo* info) {
 
 	lexer->start = info->contents;
 	lexer->end = info->contents;
+	lexer->limit = info->contents + info->length;
 	lexer->line = 1;
 	lexer->column = 1;
+	lexer->streaming = streaming;
+	lexer->finished = false;
 	lexer->capacity = INITIAL_TOKEN_CAPACITY;
+	if (streaming) {
+		lexer->capacity = TOKEN_RING_SIZE;
+	} else if (info->length / SOURCE_BYTES_PER_TOKEN > INITIAL_TOKEN_CAPACITY) {
+		lexer->capacity = info->length / SOURCE_BYTES_PER_TOKEN;
+	}
 	lexer->size = 0;
-	lexer->tokens = arena_allocate(ctx->lexer_arena, sizeof(Token) * lexer->capacity);
-	if (!lexer->tokens) {
+	if (!allocate_tokens(ctx, lexer)) {
 		printf("Error: Unable to allocate space for tokens\n");
 		return NULL;
 	}
@@ -54,17 +89,53 @@ char advance_lexer(Lexer* lexer) {
 	return current;
 }
 
+bool is_identifier_char(char c) {
+	unsigned char class = char_classes[(unsigned char)c];
+	return class == CHAR_ALPHA || class == CHAR_DIGIT || class == CHAR_UNDERSCORE;
+}
+
+// indentation is consumed 16 bytes at a time, taking line and column from
+// the newlines in each block; \v and \f are left to the byte loop
 bool skip_lexer_whitespace(Lexer* lexer) {
-	while (!lexer_at_end(lexer) && isspace(peek_lexer(lexer))) {
+#ifdef __SSE2__
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i carriage_return = _mm_set1_epi8('\r');
+
+	while (lexer->end + 16 <= lexer->limit) {
+		__m128i block = _mm_loadu_si128((const __m128i*)lexer->end);
+		__m128i newlines = _mm_cmpeq_epi8(block, newline);
+		__m128i blanks = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+			_mm_or_si128(newlines, _mm_cmpeq_epi8(block, carriage_return))
+		);
+
+		unsigned int blank_mask = _mm_movemask_epi8(blanks);
+		int count = blank_mask == 0xffff ? 16 : __builtin_ctz(~blank_mask);
+		unsigned int newline_mask = _mm_movemask_epi8(newlines) & ((1u << count) - 1);
+
+		if (newline_mask) {
+			lexer->line += __builtin_popcount(newline_mask);
+			lexer->column = count - (31 - __builtin_clz(newline_mask));
+		} else {
+			lexer->column += count;
+		}
+		lexer->end += count;
+		if (count < 16) break;
+	}
+#endif
+	while (!lexer_at_end(lexer) && char_classes[(unsigned char)peek_lexer(lexer)] == CHAR_SPACE) {
 		advance_lexer(lexer);
 	}
 	return true;
 }
 
 bool skip_lexer_comment(Lexer* lexer) {
-	while (!lexer_at_end(lexer) && peek_lexer(lexer) != '\n') {
-		advance_lexer(lexer);
-	}
+	char* newline = memchr(lexer->end, '\n', lexer->limit - lexer->end);
+	char* stop = newline ? newline : lexer->limit;
+	lexer->column += stop - lexer->end;
+	lexer->end = stop;
 	return true;
 }
 
@@ -97,117 +168,239 @@ token_t key_t_to_token_t(keyword_t type) {
 	}
 }
 
-keyword_t get_keyword_t(CompilerContext* ctx, char* identifier) {
-	for (int i = 0; i < KEYWORDS; i++) {
-		if (strcmp(ctx->keywords[i], identifier) == 0) {
-			return (keyword_t)i;
+// length and first character leave at most two candidates to compare
+keyword_t get_keyword_t(char* text, int length) {
+	switch (length) {
+		case 2: {
+			if (memcmp(text, "if", 2) == 0) return KEYWORD_IF;
+			break;
+		}
+
+		case 3: {
+			switch (text[0]) {
+				case 'l': if (memcmp(text, "let", 3) == 0) return KEYWORD_LET; break;
+				case 'i': if (memcmp(text, "int", 3) == 0) return KEYWORD_INT; break;
+				case 'f': if (memcmp(text, "for", 3) == 0) return KEYWORD_FOR; break;
+				case 's': if (memcmp(text, "str", 3) == 0) return KEYWORD_STR; break;
+			}
+			break;
+		}
+
+		case 4: {
+			switch (text[0]) {
+				case 'c': {
+					if (memcmp(text, "char", 4) == 0) return KEYWORD_CHAR;
+					if (memcmp(text, "case", 4) == 0) return KEYWORD_CASE;
+					break;
+				}
+				case 'e': {
+					if (memcmp(text, "else", 4) == 0) return KEYWORD_ELSE;
+					if (memcmp(text, "enum", 4) == 0) return KEYWORD_ENUM;
+					break;
+				}
+				case 'b': if (memcmp(text, "bool", 4) == 0) return KEYWORD_BOOL; break;
+				case 'v': if (memcmp(text, "void", 4) == 0) return KEYWORD_VOID; break;
+				case 't': if (memcmp(text, "true", 4) == 0) return KEYWORD_TRUE; break;
+			}
+			break;
+		}
+
+		case 5: {
+			switch (text[0]) {
+				case 'w': if (memcmp(text, "while", 5) == 0) return KEYWORD_WHILE; break;
+				case 'b': if (memcmp(text, "break", 5) == 0) return KEYWORD_BREAK; break;
+				case 'f': if (memcmp(text, "false", 5) == 0) return KEYWORD_FALSE; break;
+			}
+			break;
+		}
+
+		case 6: {
+			switch (text[0]) {
+				case 's': {
+					if (memcmp(text, "struct", 6) == 0) return KEYWORD_STRUCT;
+					if (memcmp(text, "switch", 6) == 0) return KEYWORD_SWITCH;
+					break;
+				}
+				case 'r': if (memcmp(text, "return", 6) == 0) return KEYWORD_RETURN; break;
+			}
+			break;
+		}
+
+		case 8: {
+			switch (text[0]) {
+				case 'f': if (memcmp(text, "function", 8) == 0) return KEYWORD_FUNCTION; break;
+				case 'c': if (memcmp(text, "continue", 8) == 0) return KEYWORD_CONTINUE; break;
+			}
+			break;
 		}
 	}
 	return KEYWORD_UNKNOWN;
 }
 
-Token create_char_token(token_t type, char c, int line, int column) {
-	Token t = {
-		.type = type,
-		.line = line,
-		.column = column
-	};
-	t.value.c = c;
-	return t;
+// tokens whose payload is an interned id: identifiers, keywords, string
+// literals and two character operators
+bool token_has_text(token_t type) {
+	switch (type) {
+		case TOKEN_ID:
+		case TOKEN_STR_LITERAL:
+		case TOKEN_FUNCTION_KEYWORD:
+		case TOKEN_LET_KEYWORD:
+		case TOKEN_INT_KEYWORD:
+		case TOKEN_CHAR_KEYWORD:
+		case TOKEN_BOOL_KEYWORD:
+		case TOKEN_VOID_KEYWORD:
+		case TOKEN_STRUCT_KEYWORD:
+		case TOKEN_ENUM_KEYWORD:
+		case TOKEN_IF_KEYWORD:
+		case TOKEN_ELSE_KEYWORD:
+		case TOKEN_FOR_KEYWORD:
+		case TOKEN_WHILE_KEYWORD:
+		case TOKEN_CONTINUE_KEYWORD:
+		case TOKEN_BREAK_KEYWORD:
+		case TOKEN_RETURN_KEYWORD:
+		case TOKEN_SWITCH_KEYWORD:
+		case TOKEN_CASE_KEYWORD:
+		case TOKEN_TRUE_KEYWORD:
+		case TOKEN_FALSE_KEYWORD:
+		case TOKEN_STR_KEYWORD:
+		case TOKEN_ADD_EQUAL:
+		case TOKEN_SUB_EQUAL:
+		case TOKEN_DIV_EQUAL:
+		case TOKEN_MUL_EQUAL:
+		case TOKEN_LESS_EQUAL:
+		case TOKEN_GREATER_EQUAL:
+		case TOKEN_EQUAL:
+		case TOKEN_NOT_EQUAL:
+		case TOKEN_INCREMENT:
+		case TOKEN_DECREMENT:
+		case TOKEN_LOGICAL_AND:
+		case TOKEN_LOGICAL_OR:
+		case TOKEN_ARROW:
+			return true;
+
+		default:
+			return false;
+	}
 }
 
-Token create_int_token(token_t type, int val, int line, int column) {
-	Token t = {
-		.type = type,
-		.line = line,
-		.column = column
-	};
-	t.value.val = val;
-	return t;
+bool allocate_tokens(CompilerContext* ctx, Lexer* lexer) {
+	lexer->kinds = arena_allocate(ctx->lexer_arena, sizeof(uint8_t) * lexer->capacity);
+	lexer->offsets = arena_allocate(ctx->lexer_arena, sizeof(uint32_t) * lexer->capacity);
+	lexer->payloads = arena_allocate(ctx->lexer_arena, sizeof(uint32_t) * lexer->capacity);
+	return lexer->kinds && lexer->offsets && lexer->payloads;
 }
 
-Token create_string_token(CompilerContext* ctx, token_t type, char* str, int line, int column) {
-	Token t = {
-		.type = type,
-		.line = line,
-		.column = column
-	};
-
-	int length = strlen(str);
-	t.value.str = arena_allocate(ctx->lexer_arena, length + 1);
-	if (!t.value.str) {
-		TokenValue error_val = {
-			.str = NULL
-		};
+void add_token(CompilerContext* ctx, Lexer* lexer, token_t type, char* start, uint32_t payload) {
+	if (!lexer->streaming && lexer->size >= lexer->capacity) {
+		size_t prev_capacity = lexer->capacity;
 
-		Token error_token = {
-			.type = TOKEN_UNKNOWN,
-			.value = error_val,
-			.line = -1,
-			.column = -1,
-		};
-		return error_token;
+		lexer->capacity *= 2;
+		size_t new_capacity = lexer->capacity;
+		lexer->kinds = arena_reallocate(ctx->lexer_arena, lexer->kinds, prev_capacity * sizeof(uint8_t), new_capacity * sizeof(uint8_t));
+		lexer->offsets = arena_reallocate(ctx->lexer_arena, lexer->offsets, prev_capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
+		lexer->payloads = arena_reallocate(ctx->lexer_arena, lexer->payloads, prev_capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
+		assert(lexer->kinds && lexer->offsets && lexer->payloads);
 	}
-	strncpy(t.value.str, str, length);
-	t.value.str[length] = '\0';
 
-	return t;
+	int slot = lexer->streaming ? lexer->size & (lexer->capacity - 1) : lexer->size;
+	lexer->size++;
+
+	lexer->kinds[slot] = (uint8_t)type;
+	lexer->offsets[slot] = (uint32_t)(start - lexer->info->contents);
+	lexer->payloads[slot] = payload;
 }
 
-void add_token(CompilerContext* ctx, Lexer* lexer, Token token) {
-	if (lexer->size >= lexer->capacity) {
-		size_t prev_capacity = lexer->capacity;
+void add_text_token(CompilerContext* ctx, Lexer* lexer, token_t type, char* start, char* text, int length) {
+	InternedString* entry = intern_string(ctx, text, length);
+	assert(entry);
+	add_token(ctx, lexer, type, start, entry->id);
+}
 
-		lexer->capacity *= 2;
-		size_t new_capacity = lexer->capacity;
-		void* new_tokens = arena_reallocate(
-			ctx->lexer_arena, 
-			lexer->tokens, 
-			prev_capacity * sizeof(Token), 
-			new_capacity * sizeof(Token)
-		);
-		
-		assert(new_tokens);
-		lexer->tokens = new_tokens;
+// the slot holding an already scanned token; indices past EOF read EOF
+int token_slot(Lexer* lexer, int index) {
+	if (index >= lexer->size) index = lexer->size - 1;
+	return lexer->streaming ? index & (lexer->capacity - 1) : index;
+}
+
+// scans up to token index if a streaming lexer has not reached it yet; its
+// errors are still logged as lexer errors
+int fetch_token(CompilerContext* ctx, Lexer* lexer, int index) {
+	if (index >= lexer->size && !lexer->finished) {
+		phase_t phase = ctx->phase;
+		ctx->phase = PHASE_LEXER;
+		while (index >= lexer->size && !lexer->finished) {
+			scan_token(ctx, lexer);
+		}
+		ctx->phase = phase;
 	}
-	lexer->tokens[lexer->size++] = token;
+	return token_slot(lexer, index);
 }
 
-void get_identifier(CompilerContext* ctx, Lexer* lexer) {
-	while (!lexer_at_end(lexer) && (isalnum(peek_lexer(lexer)) || peek_lexer(lexer) == '_')) {
-		advance_lexer(lexer);
+Token get_token(Lexer* lexer, Interner* interner, int index) {
+	int slot = token_slot(lexer, index);
+	Token token = {
+		.type = (token_t)lexer->kinds[slot],
+		.offset = lexer->offsets[slot]
+	};
+
+	uint32_t payload = lexer->payloads[slot];
+	if (token.type == TOKEN_INTEGER) {
+		token.value.val = (int)payload;
+	} else if (token_has_text(token.type)) {
+		token.value.str = interner->entries[payload]->str;
+	} else {
+		token.value.c = (char)payload;
+	}
+	return token;
+}
+
+// lines and columns are 1-based; only called when reporting an error
+void locate_offset(FileInfo* info, size_t offset, int* line, int* column) {
+	int low = 0;
+	int high = info->line_count - 1;
+	while (low < high) {
+		int mid = low + (high - low + 1) / 2;
+		if (info->line_starts[mid] <= offset) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
 	}
 
-	int length = lexer->end - lexer->start;
-	char* identifier = arena_allocate(ctx->lexer_arena, length + 1);
-	assert(identifier);
+	size_t line_start = info->line_count > 0 ? info->line_starts[low] : 0;
+	*line = low + 1;
+	*column = (int)(offset - line_start) + 1;
+}
 
-	strncpy(identifier, lexer->start, length);
-	identifier[length] = '\0';
+// identifiers and numbers never span a newline, so only the column moves
+void get_identifier(CompilerContext* ctx, Lexer* lexer) {
+	char* cursor = lexer->end;
+	while (is_identifier_char(*cursor)) {
+		cursor++;
+	}
+	lexer->column += cursor - lexer->end;
+	lexer->end = cursor;
 
-	keyword_t key_t = get_keyword_t(ctx, identifier);
+	int length = lexer->end - lexer->start;
+	token_t type = TOKEN_ID;
+	keyword_t key_t = get_keyword_t(lexer->start, length);
 	if (key_t != KEYWORD_UNKNOWN) {
-		token_t tok_t = key_t_to_token_t(key_t);
-		add_token(ctx, lexer, create_string_token(ctx, tok_t, identifier, lexer->line, lexer->column));
-	} else {
-		add_token(ctx, lexer, create_string_token(ctx, TOKEN_ID, identifier, lexer->line, lexer->column));
+		type = key_t_to_token_t(key_t);
 	}
+	add_text_token(ctx, lexer, type, lexer->start, lexer->start, length);
 }	
 
 void get_number(CompilerContext* ctx, Lexer* lexer) {
-	while (!lexer_at_end(lexer) && isdigit(peek_lexer(lexer))) {
-		advance_lexer(lexer);
+	unsigned int number = 0;
+	char* cursor = lexer->end;
+	while (char_classes[(unsigned char)*cursor] == CHAR_DIGIT) {
+		number = number * 10 + (*cursor - '0');
+		cursor++;
 	}
+	lexer->column += cursor - lexer->end;
+	lexer->end = cursor;
 
-	int length = lexer->end - lexer->start;
-	char* text = arena_allocate(ctx->lexer_arena, length + 1);
-	assert(text);
-
-	strncpy(text, lexer->start, length);
-	text[length] = '\0';
-
-	int number = atoi(text);
-	add_token(ctx, lexer, create_int_token(TOKEN_INTEGER, number, lexer->line, lexer->column));
+	add_token(ctx, lexer, TOKEN_INTEGER, lexer->start, number);
 }
 
 void get_string_literal(CompilerContext* ctx, Lexer* lexer) {
@@ -231,13 +424,7 @@ void get_string_literal(CompilerContext* ctx, Lexer* lexer) {
 		return;
 	}
 	int length = lexer->end - lexer->start;
-	char* identifier = arena_allocate(ctx->lexer_arena, length + 1);
-	if (!identifier) return;
-
-	strncpy(identifier, lexer->start, length);
-	identifier[length] = '\0';
-
-	add_token(ctx, lexer, create_string_token(ctx, TOKEN_STR_LITERAL, identifier, lexer->line, lexer->column));
+	add_text_token(ctx, lexer, TOKEN_STR_LITERAL, lexer->start, lexer->start, length);
 }
 
 void get_delimeters(CompilerContext* ctx, Lexer* lexer) {
@@ -255,7 +442,7 @@ void get_delimeters(CompilerContext* ctx, Lexer* lexer) {
 		case ':': type = TOKEN_COLON; break;
 		case ',': type = TOKEN_COMMA; break;
 		case '\'': {
-			add_token(ctx, lexer, create_char_token(TOKEN_CHAR_LITERAL, peek_lexer(lexer), lexer->line, lexer->column));
+			add_token(ctx, lexer, TOKEN_CHAR_LITERAL, lexer->end, (unsigned char)peek_lexer(lexer));
 			advance_lexer(lexer);
 			if (peek_lexer(lexer) != '\'') {
 				char* message = error_prelude(ctx, lexer->info->filename, lexer->line, lexer->column);
@@ -281,7 +468,7 @@ void get_delimeters(CompilerContext* ctx, Lexer* lexer) {
 			return;
 		}
 	}
-	add_token(ctx, lexer, create_char_token(type, c, lexer->line, lexer->column - 1));
+	add_token(ctx, lexer, type, lexer->start, (unsigned char)c);
 }
 
 bool match(Lexer* lexer, char expected) {
@@ -420,14 +607,13 @@ void get_operator(CompilerContext* ctx, Lexer* lexer) {
 	if (type == TOKEN_UNKNOWN) return;
 
 	if (isCompoundOp) {
-		char str_opr[3] = {c, *(lexer->end - 1), '\0'};
-		add_token(ctx, lexer, create_string_token(ctx, type, str_opr, lexer->line, lexer->column - 2));
+		add_text_token(ctx, lexer, type, lexer->start, lexer->start, 2);
 	} else {
-		add_token(ctx, lexer, create_char_token(type, c, lexer->line, lexer->column - 1));
+		add_token(ctx, lexer, type, lexer->start, (unsigned char)c);
 	}
 }
 
-FileInfo* create_info(CompilerContext* ctx, char* filename, int line_count, char* contents) {
+FileInfo* create_info(CompilerContext* ctx, char* filename, size_t length, char* contents) {
 	FileInfo* info = arena_allocate(ctx->lexer_arena, sizeof(FileInfo));
 	if (!info) {
 		perror("Failed to create file info\n");
@@ -435,144 +621,183 @@ FileInfo* create_info(CompilerContext* ctx, char* filename, int line_count, char
 	}
 
 	info->filename = filename;
-	info->line_count = line_count;
+	info->line_count = 0;
 	info->contents = contents;
-	info->lines = NULL;
+	info->length = length;
+	info->mapped = false;
+	info->line_starts = NULL;
 
 	return info;
 }
 
-FileInfo* retrieve_file_contents(CompilerContext* ctx, char* filename) {
-	FILE* file = fopen(filename, "r");
-	if (!file) {
-		printf("Could not open file\n");
-		return NULL;
-	}
-	fpos_t position;
-	fgetpos(file, &position);
-	
-	fseek(file, 0, SEEK_END);
-	long file_size = ftell(file);
-	
-	fsetpos(file, &position);
+// one memchr pass over the text; a last line without a trailing newline
+// still counts
+bool index_lines(CompilerContext* ctx, FileInfo* info) {
+	int capacity = info->length / 32 + 2;
+	info->line_starts = arena_allocate(ctx->lexer_arena, sizeof(size_t) * capacity);
+	if (!info->line_starts) return false;
+
+	char* end = info->contents + info->length;
+	char* line_start = info->contents;
+
+	// a trailing newline opens an empty last line, where EOF is reported
+	while (line_start <= end) {
+		if (info->line_count >= capacity) {
+			int prev_capacity = capacity;
+			capacity *= 2;
+
+			size_t* new_starts = arena_reallocate(
+				ctx->lexer_arena,
+				info->line_starts,
+				prev_capacity * sizeof(size_t),
+				capacity * sizeof(size_t)
+			);
+			if (!new_starts) return false;
+			info->line_starts = new_starts;
+		}
+		info->line_starts[info->line_count++] = line_start - info->contents;
 
-	char* buffer = arena_allocate(ctx->lexer_arena, file_size + 1);
-	if (!buffer) {
-		printf("Could not allocate buffer\n");
-		fclose(file);
-		exit(EXIT_FAILURE);
+		char* newline = memchr(line_start, '\n', end - line_start);
+		if (!newline) break;
+		line_start = newline + 1;
 	}
+	return true;
+}
 
-	int line_count = 0;
-	for (long i = 0; i < file_size; i++) {
-		char c = fgetc(file);
-		if (c == '\n') {
-			line_count++;
-		}
-		if (feof(file)) { break; }
-		buffer[i] = c;
+// lines are 1-based, as in tokens; the text is not copied or terminated
+char* get_source_line(FileInfo* info, int line, int* length) {
+	if (line < 1 || line > info->line_count) {
+		*length = 0;
+		return "";
 	}
-	buffer[file_size] = '\0';
-	
-	if (file_size > 0 && buffer[file_size - 1] != '\n') {
-	    line_count++;
+
+	char* start = info->contents + info->line_starts[line - 1];
+	char* end = info->contents + info->length;
+	char* newline = memchr(start, '\n', end - start);
+	*length = (newline ? newline : end) - start;
+	return start;
+}
+
+// the file is mapped copy-on-write; the lexer stops at a '\0', which the
+// zero fill after end of file provides unless the file ends exactly on a
+// page boundary, in which case it is read into the arena with one read
+FileInfo* retrieve_file_contents(CompilerContext* ctx, char* filename) {
+	int fd = open(filename, O_RDONLY);
+	if (fd == -1) {
+		printf("Could not open file\n");
+		return NULL;
 	}
-	fsetpos(file, &position);
 
-	FileInfo* info = create_info(ctx, filename, line_count, buffer);
-	if (!info) {
-		fclose(file);
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == -1) {
+		printf("Could not stat file\n");
+		close(fd);
 		return NULL;
 	}
+	size_t file_size = file_stat.st_size;
 
-	if (line_count > 0) {
-		info->lines = arena_allocate(ctx->lexer_arena, sizeof(char*) * line_count);
-		if (!info->lines) {
-			perror("Failed to allocate space for info->lines\n");
-			fclose(file);
-			return NULL;
-		}
-	} else {
-		info->lines = NULL;
-	}
-
-	int current_line_index = 0;
-	char* line_start = buffer;
-	for (long i = 0; i < file_size; i++) {
-		if (buffer[i] == '\n') {
-			if (current_line_index < line_count) {
-				int length = &buffer[i] - line_start;
-				info->lines[current_line_index] = arena_allocate(ctx->lexer_arena, length + 1);
-				if (!info->lines[current_line_index]) {
-					fclose(file);
-					return NULL;
-				}
-				strncpy(info->lines[current_line_index], line_start, length);	
-				info->lines[current_line_index][length] =  '\0';
-				current_line_index++;
+	char* buffer = NULL;
+	bool mapped = false;
+	long page_size = sysconf(_SC_PAGESIZE);
 
-			}
-			line_start = &buffer[i + 1];
+	if (file_size > 0 && file_size % page_size != 0) {
+		buffer = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (buffer == MAP_FAILED) {
+			buffer = NULL;
+		} else {
+			mapped = true;
 		}
 	}
 
+	if (!buffer) {
+		buffer = arena_allocate(ctx->lexer_arena, file_size + 1);
+		if (!buffer) {
+			printf("Could not allocate buffer\n");
+			close(fd);
+			exit(EXIT_FAILURE);
+		}
 
-	if (line_start < (buffer + file_size) && current_line_index < line_count) {
-		long line_length = (buffer + file_size) - line_start;
-		info->lines[current_line_index] = arena_allocate(ctx->lexer_arena, line_length + 1);
-		if (!info->lines[current_line_index]) {
-			perror("Failed to allocate memory for the last line\n");
-			
-			fclose(file);
-			return NULL;
+		size_t total = 0;
+		while (total < file_size) {
+			ssize_t bytes = read(fd, buffer + total, file_size - total);
+			if (bytes <= 0) break;
+			total += bytes;
 		}
-		strncpy(info->lines[current_line_index], line_start, line_length);
-		info->lines[current_line_index][line_length] = '\0';
-		current_line_index++;
+		file_size = total;
+		buffer[file_size] = '\0';
 	}
+	close(fd);
 
-	fclose(file);
+	FileInfo* info = create_info(ctx, filename, file_size, buffer);
+	if (!info) return NULL;
+	info->mapped = mapped;
+
+	if (!index_lines(ctx, info)) {
+		perror("Failed to allocate space for info->line_starts\n");
+		return NULL;
+	}
 	return info;
 }
 
-Lexer* lex(CompilerContext* ctx, char* filename) {
+void release_file_contents(FileInfo* info) {
+	if (info && info->mapped) {
+		munmap(info->contents, info->length);
+		info->mapped = false;
+	}
+}
+
+Lexer* create_lexer(CompilerContext* ctx, char* filename, bool streaming) {
 	ctx->phase = PHASE_LEXER;
 
 	FileInfo* info = retrieve_file_contents(ctx, filename);
-	Lexer* lexer = initialize_lexer(ctx, info);
-	assert(info && lexer);
+	assert(info);
+	Lexer* lexer = initialize_lexer(ctx, info, streaming);
+	assert(lexer);
 	ctx->info = info;
+	return lexer;
+}
 
-	while (!lexer_at_end(lexer)) {
+// scans until one token is added, or adds EOF once the source runs out
+void scan_token(CompilerContext* ctx, Lexer* lexer) {
+	int size = lexer->size;
+	while (lexer->size == size) {
 		skip_lexer_whitespace(lexer);
-		
+		if (lexer_at_end(lexer)) {
+			add_token(ctx, lexer, TOKEN_EOF, lexer->end, 0);
+			lexer->finished = true;
+			return;
+		}
+
 		lexer->start = lexer->end;
 
-		if (isalpha(peek_lexer(lexer))) {
-			get_identifier(ctx, lexer);
-		} else if (isdigit(peek_lexer(lexer))) {
-			get_number(ctx, lexer);
-		} else if (strchr("=+-*/<!&>|%", peek_lexer(lexer))) {
-			get_operator(ctx, lexer);
-		} else if (strchr("':()[]{},\";", peek_lexer(lexer))) {
-			get_delimeters(ctx, lexer);
-		} else {
-			advance_lexer(lexer);
+		switch (char_classes[(unsigned char)peek_lexer(lexer)]) {
+			case CHAR_ALPHA: get_identifier(ctx, lexer); break;
+			case CHAR_DIGIT: get_number(ctx, lexer); break;
+			case CHAR_OPERATOR: get_operator(ctx, lexer); break;
+			case CHAR_DELIMITER: get_delimeters(ctx, lexer); break;
+			default: advance_lexer(lexer); break;
 		}
 	}
-	Token eof_token = {
-		.type = TOKEN_EOF,
-		.line = lexer->line,
-		.column = lexer->column
-	};
-	add_token(ctx, lexer, eof_token);
+}
+
+Lexer* lex(CompilerContext* ctx, char* filename) {
+	Lexer* lexer = create_lexer(ctx, filename, false);
+	while (!lexer->finished) {
+		scan_token(ctx, lexer);
+	}
 	return lexer;
 }
 
-void print_tokens(Token* tokens) {
-	if (!tokens) return;
-	for (int i = 0; tokens[i].type != TOKEN_EOF; i++) {
-		switch (tokens[i].type) {
+// nothing is scanned until the parser asks for a token
+Lexer* stream_tokens(CompilerContext* ctx, char* filename) {
+	return create_lexer(ctx, filename, true);
+}
+
+void print_tokens(Lexer* lexer, Interner* interner) {
+	if (!lexer) return;
+	for (int i = 0; lexer->kinds[i] != TOKEN_EOF; i++) {
+		Token token = get_token(lexer, interner, i);
+		switch (token.type) {
 			case TOKEN_ARROW:
 			case TOKEN_ADD_EQUAL:
 			case TOKEN_SUB_EQUAL:
@@ -606,12 +831,12 @@ void print_tokens(Token* tokens) {
 			case TOKEN_LOGICAL_AND:
 			case TOKEN_LOGICAL_OR:
 			case TOKEN_ID: {
-				printf("TOKEN TYPE: %d TOKEN: %s\n", tokens[i].type, tokens[i].value.str);
+				printf("TOKEN TYPE: %d TOKEN: %s\n", token.type, token.value.str);
 				break;
 			}
 
 			case TOKEN_INTEGER: {
-				printf("TOKEN TYPE: %d TOKEN: %d\n", tokens[i].type, tokens[i].value.val);
+				printf("TOKEN TYPE: %d TOKEN: %d\n", token.type, token.value.val);
 				break;
 			}
 
@@ -636,7 +861,7 @@ void print_tokens(Token* tokens) {
 			case TOKEN_AMPERSAND:
 			case TOKEN_CHAR_LITERAL:
 			case TOKEN_PERIOD: {
-				printf("TOKEN TYPE: %d, TOKEN: %c\n", tokens[i].type, tokens[i].value.c);
+				printf("TOKEN TYPE: %d, TOKEN: %c\n", token.type, token.value.c);
 				break;				
 			}
 		}
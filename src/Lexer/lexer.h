@@ -6,18 +6,27 @@
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <stdint.h>
 
 typedef struct CompilerContext CompilerContext;
+typedef struct Interner Interner;
 typedef struct Token Token;
 typedef enum token_t token_t;
 
 #define INITIAL_TOKEN_CAPACITY 250
+#define SOURCE_BYTES_PER_TOKEN 3 // token array is sized from the file length up front
+#define TOKEN_RING_SIZE 16 // slots in a streaming lexer; a power of two
 
+// contents is the source as loaded, mapped or read, and always followed by a
+// '\0'; line_starts holds the offset of each line's first byte
 typedef struct FileInfo {
 	char* filename;
-	int line_count;
 	char* contents;
-	char** lines;
+	size_t length;
+	bool mapped;
+
+	int line_count;
+	size_t* line_starts;
 } FileInfo;
 
 typedef struct Lexer {
@@ -26,12 +35,22 @@ typedef struct Lexer {
 	
 	char* start;
 	char* end;
+	char* limit; // one past the last byte of source
 
 	int line;
 	int column;
 	
-	Token* tokens;
+	// token i is kinds[i], starting offsets[i] bytes into the source; its
+	// payload is an interned string id, an integer value or a character
+	uint8_t* kinds;
+	uint32_t* offsets;
+	uint32_t* payloads;
 	FileInfo* info;
+
+	// a streaming lexer scans only as far as the parser has asked, keeping
+	// the last TOKEN_RING_SIZE tokens; finished is set once EOF is added
+	bool streaming;
+	bool finished;
 } Lexer;
 
 typedef enum {
@@ -63,8 +82,21 @@ typedef struct {
 	char* str;
 } Keyword;
 
+typedef enum {
+	CHAR_OTHER,
+	CHAR_SPACE,
+	CHAR_ALPHA,
+	CHAR_DIGIT,
+	CHAR_UNDERSCORE,
+	CHAR_OPERATOR,
+	CHAR_DELIMITER
+} char_class_t;
+
+extern const unsigned char char_classes[256];
+
 token_t key_t_to_token_t(keyword_t type);
-keyword_t get_keyword_t(CompilerContext* ctx, char* identififer);
+keyword_t get_keyword_t(char* text, int length);
+bool is_identifier_char(char c);
 
 char peek_lexer(Lexer* lexer);
 char peek_lexer_next(Lexer* lexer);
@@ -80,15 +112,25 @@ void get_operator(CompilerContext* ctx, Lexer* lexer);
 void get_delimeters(CompilerContext* ctx, Lexer* lexer);
 bool match(Lexer* lexer, char expected);
 
-Token create_char_token(token_t type, char c, int line, int column);
-Token create_int_token(token_t type, int val, int line, int column);
-Token create_string_token(CompilerContext* ctx, token_t type, char* str, int line, int column);
-void add_token(CompilerContext* ctx, Lexer* lexer, Token token);
+bool token_has_text(token_t type);
+bool allocate_tokens(CompilerContext* ctx, Lexer* lexer);
+void add_token(CompilerContext* ctx, Lexer* lexer, token_t type, char* start, uint32_t payload);
+void add_text_token(CompilerContext* ctx, Lexer* lexer, token_t type, char* start, char* text, int length);
+int token_slot(Lexer* lexer, int index);
+int fetch_token(CompilerContext* ctx, Lexer* lexer, int index);
+Token get_token(Lexer* lexer, Interner* interner, int index);
+void locate_offset(FileInfo* info, size_t offset, int* line, int* column);
 
-FileInfo* create_info(CompilerContext* ctx, char* filename, int line_count, char* contents);
+FileInfo* create_info(CompilerContext* ctx, char* filename, size_t length, char* contents);
+bool index_lines(CompilerContext* ctx, FileInfo* info);
+char* get_source_line(FileInfo* info, int line, int* length);
 FileInfo* retrieve_file_contents(CompilerContext* ctx, char* filename);
-Lexer* initialze_lexer(CompilerContext* ctx, FileInfo* info);
+void release_file_contents(FileInfo* info);
+Lexer* initialize_lexer(CompilerContext* ctx, FileInfo* info, bool streaming);
+Lexer* create_lexer(CompilerContext* ctx, char* filename, bool streaming);
+void scan_token(CompilerContext* ctx, Lexer* lexer);
 Lexer* lex(CompilerContext* ctx, char* filename);
+Lexer* stream_tokens(CompilerContext* ctx, char* filename);
 
-void print_tokens(Token* tokens);
+void print_tokens(Lexer* lexer, Interner* interner);
 #endif
\ No newline at end of file
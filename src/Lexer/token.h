@@ -1,6 +1,8 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <stdint.h>
+
 typedef enum token_t {
 	TOKEN_ID, 
 	TOKEN_CHAR_LITERAL,
@@ -74,11 +76,12 @@ typedef union {
 	char* str;
 } TokenValue;
 
+// the parser's view of one token, rebuilt from the lexer's arrays by
+// get_token; line and column are found from offset with locate_offset
 typedef struct Token {
 	token_t type;
 	TokenValue value;
-	int line;
-	int column;
+	uint32_t offset;
 } Token;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "node.h"
+#include "compilercontext.h"
+#include "types.h"
+#include <assert.h>
+#include <stdio.h>
+
+NodePool* create_node_pool(CompilerContext* ctx) {
+	NodePool* pool = arena_allocate(ctx->ast_arena, sizeof(NodePool));
+	if (!pool) {
+		perror("In 'create_node_pool', unable to allocate space for node pool\n");
+		return NULL;
+	}
+
+	pool->ctx = ctx;
+	pool->arena = ctx->ast_arena;
+	pool->node_chunk_slots = INIT_NODE_CHUNK_SLOTS;
+	pool->binding_chunk_slots = INIT_NODE_CHUNK_SLOTS;
+	pool->node_chunks = arena_allocate(pool->arena, sizeof(Node*) * pool->node_chunk_slots);
+	pool->binding_chunks = arena_allocate(pool->arena, sizeof(NodeBinding*) * pool->binding_chunk_slots);
+	if (!pool->node_chunks || !pool->binding_chunks) {
+		perror("In 'create_node_pool', unable to allocate space for chunk tables\n");
+		return NULL;
+	}
+
+	// id 0 stands for no node or binding, so both start one slot in
+	pool->num_nodes = 1;
+	pool->num_bindings = 1;
+	pool->node_chunks[0] = arena_allocate(pool->arena, sizeof(Node) * NODE_CHUNK_SIZE);
+	pool->binding_chunks[0] = arena_allocate(pool->arena, sizeof(NodeBinding) * NODE_CHUNK_SIZE);
+	pool->num_node_chunks = 1;
+	pool->num_binding_chunks = 1;
+
+	pool->integer_type = type_create(ctx, TYPE_INTEGER, NULL);
+	pool->char_type = type_create(ctx, TYPE_CHAR, NULL);
+	if (!pool->node_chunks[0] || !pool->binding_chunks[0] || !pool->integer_type || !pool->char_type) {
+		perror("In 'create_node_pool', unable to allocate first chunks\n");
+		return NULL;
+	}
+	return pool;
+}
+
+void* grow_chunks(NodePool* pool, void* chunks, int* slots) {
+	int prev_slots = *slots;
+	*slots *= 2;
+	return arena_reallocate(pool->arena, chunks, prev_slots * sizeof(void*), *slots * sizeof(void*));
+}
+
+Node* allocate_node(NodePool* pool) {
+	uint32_t id = pool->num_nodes;
+	int chunk = id >> NODE_CHUNK_SHIFT;
+	if (chunk == pool->num_node_chunks) {
+		if (chunk == pool->node_chunk_slots) {
+			pool->node_chunks = grow_chunks(pool, pool->node_chunks, &pool->node_chunk_slots);
+			if (!pool->node_chunks) return NULL;
+		}
+
+		pool->node_chunks[chunk] = arena_allocate(pool->arena, sizeof(Node) * NODE_CHUNK_SIZE);
+		if (!pool->node_chunks[chunk]) return NULL;
+		pool->num_node_chunks++;
+	}
+
+	pool->num_nodes++;
+	Node* node = &pool->node_chunks[chunk][id & (NODE_CHUNK_SIZE - 1)];
+	node->id = id;
+	return node;
+}
+
+NodeId allocate_binding(NodePool* pool) {
+	uint32_t id = pool->num_bindings;
+	int chunk = id >> NODE_CHUNK_SHIFT;
+	if (chunk == pool->num_binding_chunks) {
+		if (chunk == pool->binding_chunk_slots) {
+			pool->binding_chunks = grow_chunks(pool, pool->binding_chunks, &pool->binding_chunk_slots);
+			if (!pool->binding_chunks) return 0;
+		}
+
+		pool->binding_chunks[chunk] = arena_allocate(pool->arena, sizeof(NodeBinding) * NODE_CHUNK_SIZE);
+		if (!pool->binding_chunks[chunk]) return 0;
+		pool->num_binding_chunks++;
+	}
+
+	pool->num_bindings++;
+	return id;
+}
+
+// what the nodes and bindings handed out so far take, not counting the
+// unused tail of the last chunks
+size_t node_pool_bytes(NodePool* pool) {
+	return (pool->num_nodes - 1) * sizeof(Node) + (pool->num_bindings - 1) * sizeof(NodeBinding);
+}
+
+// ids index the pool of the context the tree was parsed in
+Node* node_at(CompilerContext* ctx, NodeId id) {
+	if (!id) return NULL;
+	return &ctx->node_pool->node_chunks[id >> NODE_CHUNK_SHIFT][id & (NODE_CHUNK_SIZE - 1)];
+}
+
+NodeId node_id(Node* node) {
+	return node ? node->id : 0;
+}
+
+Node* node_left(CompilerContext* ctx, Node* node) {
+	return node_at(ctx, node->left);
+}
+
+Node* node_right(CompilerContext* ctx, Node* node) {
+	return node_at(ctx, node->right);
+}
+
+Node* node_prev(CompilerContext* ctx, Node* node) {
+	return node_at(ctx, node->prev);
+}
+
+Node* node_next(CompilerContext* ctx, Node* node) {
+	return node_at(ctx, node->next);
+}
+
+NodeBinding* find_binding(CompilerContext* ctx, Node* node) {
+	NodeId id = node->binding;
+	if (!id) return NULL;
+	return &ctx->node_pool->binding_chunks[id >> NODE_CHUNK_SHIFT][id & (NODE_CHUNK_SIZE - 1)];
+}
+
+// the node's binding, allocated the first time anything is stored in it
+NodeBinding* node_binding(CompilerContext* ctx, Node* node) {
+	if (!node->binding) {
+		node->binding = allocate_binding(ctx->node_pool);
+		assert(node->binding);
+	}
+	return find_binding(ctx, node);
+}
+
+char* node_name(CompilerContext* ctx, Node* node) {
+	NodeBinding* binding = find_binding(ctx, node);
+	return binding ? binding->name : NULL;
+}
+
+void* node_datatype(CompilerContext* ctx, Node* node) {
+	switch (node->type) {
+		case NODE_INTEGER: return ctx->node_pool->integer_type;
+		case NODE_CHAR: return ctx->node_pool->char_type;
+		default: break;
+	}
+
+	NodeBinding* binding = find_binding(ctx, node);
+	return binding ? binding->t : NULL;
+}
+
+void* node_symbol(CompilerContext* ctx, Node* node) {
+	NodeBinding* binding = find_binding(ctx, node);
+	return binding ? binding->symbol : NULL;
+}
+
+Node* node_params(CompilerContext* ctx, Node* node) {
+	NodeBinding* binding = find_binding(ctx, node);
+	return binding ? node_at(ctx, binding->params) : NULL;
+}
+
+void set_node_name(CompilerContext* ctx, Node* node, char* name) {
+	if (!name && !node->binding) return;
+	node_binding(ctx, node)->name = name;
+}
+
+void set_node_datatype(CompilerContext* ctx, Node* node, void* t) {
+	if (!t && !node->binding) return;
+	node_binding(ctx, node)->t = t;
+}
+
+void set_node_symbol(CompilerContext* ctx, Node* node, void* symbol) {
+	if (!symbol && !node->binding) return;
+	node_binding(ctx, node)->symbol = symbol;
+}
+
+void set_node_params(CompilerContext* ctx, Node* node, Node* params) {
+	if (!params && !node->binding) return;
+	node_binding(ctx, node)->params = node_id(params);
+}
@@ -1,6 +1,19 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct CompilerContext CompilerContext;
+typedef struct Arena Arena;
+typedef struct Type Type;
+
+#define NODE_CHUNK_SHIFT 10
+#define NODE_CHUNK_SIZE (1 << NODE_CHUNK_SHIFT)
+#define INIT_NODE_CHUNK_SLOTS 64
+
+typedef uint32_t NodeId; // position in the node pool; 0 is no node
+
 typedef enum {
 	NODE_INTEGER,
 	NODE_CHAR,
@@ -56,25 +69,71 @@ typedef enum {
 	NODE_UNKNOWN
 } node_t;
 
-typedef union {
-	int val;
-	char c;
+// names, types, symbols and parameter lists only exist for declarations,
+// names, calls and functions, so they are kept apart from the node
+typedef struct NodeBinding {
 	char* name;
-} NodeValue;
-
-typedef struct Node {
-	node_t type;
-	NodeValue value;
-
-	struct Node* left;
-	struct Node* right;
-	struct Node* prev;
-	struct Node* next;
-	struct Node* params;
-	
 	void* t;
 	void* symbol;
-	int reg;
+	NodeId params;
+} NodeBinding;
+
+// children and siblings are pool ids; literals keep their value inline and
+// take their type from their kind, anything else is in the node's binding
+typedef struct Node {
+	int value;
+	NodeId id;
+	NodeId left;
+	NodeId right;
+	NodeId prev;
+	NodeId next;
+	NodeId binding; // 0 until the node needs one
+	uint8_t type; // node_t
 } Node;
 
+// nodes and bindings live in fixed size chunks that never move, so ids and
+// pointers stay valid as the tree grows
+typedef struct NodePool {
+	CompilerContext* ctx;
+	Arena* arena;
+
+	Node** node_chunks;
+	int num_node_chunks;
+	int node_chunk_slots;
+	uint32_t num_nodes;
+
+	NodeBinding** binding_chunks;
+	int num_binding_chunks;
+	int binding_chunk_slots;
+	uint32_t num_bindings;
+
+	// shared by every integer and character literal
+	Type* integer_type;
+	Type* char_type;
+} NodePool;
+
+NodePool* create_node_pool(CompilerContext* ctx);
+void* grow_chunks(NodePool* pool, void* chunks, int* slots);
+Node* allocate_node(NodePool* pool);
+NodeId allocate_binding(NodePool* pool);
+size_t node_pool_bytes(NodePool* pool);
+
+Node* node_at(CompilerContext* ctx, NodeId id);
+NodeId node_id(Node* node);
+Node* node_left(CompilerContext* ctx, Node* node);
+Node* node_right(CompilerContext* ctx, Node* node);
+Node* node_prev(CompilerContext* ctx, Node* node);
+Node* node_next(CompilerContext* ctx, Node* node);
+
+NodeBinding* find_binding(CompilerContext* ctx, Node* node);
+NodeBinding* node_binding(CompilerContext* ctx, Node* node);
+char* node_name(CompilerContext* ctx, Node* node);
+void* node_datatype(CompilerContext* ctx, Node* node);
+void* node_symbol(CompilerContext* ctx, Node* node);
+Node* node_params(CompilerContext* ctx, Node* node);
+void set_node_name(CompilerContext* ctx, Node* node, char* name);
+void set_node_datatype(CompilerContext* ctx, Node* node, void* t);
+void set_node_symbol(CompilerContext* ctx, Node* node, void* symbol);
+void set_node_params(CompilerContext* ctx, Node* node, Node* params);
+
 #endif
\ No newline at end of file
@@ -6,14 +6,14 @@ bool validate_token(CompilerContext* ctx, Parser* parser, token_t target_type) {
 	Token tok = peek_token(parser);
 	
 	if (tok.type != target_type) {
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_SEMICOLON,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -56,8 +56,7 @@ Token* copy_token(CompilerContext* ctx, Token* original_token) {
 	}
 
 	copy_token->type = original_token->type;
-	copy_token->line = original_token->line;
-	copy_token->column = original_token->column;
+	copy_token->offset = original_token->offset;
 	switch (original_token->type) {
 		case TOKEN_ARROW:
 		case TOKEN_ADD_EQUAL:
@@ -86,13 +85,7 @@ Token* copy_token(CompilerContext* ctx, Token* original_token) {
 		case TOKEN_ID:
 		case TOKEN_LOGICAL_OR:
 		case TOKEN_LOGICAL_AND: {
-			if (original_token->value.str) {
-				int length = strlen(original_token->value.str);
-				copy_token->value.str = arena_allocate(ctx->lexer_arena, length + 1);
-				if (!copy_token->value.str) return NULL;
-				strncpy(copy_token->value.str, original_token->value.str, length);
-				copy_token->value.str[length] = '\0';
-			}
+			copy_token->value.str = original_token->value.str;
 			break;
 		}
 
@@ -110,25 +103,32 @@ Token* copy_token(CompilerContext* ctx, Token* original_token) {
 }
 
 token_t peek_token_type(Parser* parser) {
-	Token tok = peek_token(parser);
-	return tok.type;
+	return (token_t)parser->lexer->kinds[fetch_token(parser->ctx, parser->lexer, parser->position)];
 }
 
 Token peek_token(Parser* parser) {
-	return *parser->tokens;
+	fetch_token(parser->ctx, parser->lexer, parser->position);
+	return get_token(parser->lexer, parser->ctx->interner, parser->position);
 }
 
 token_t peek_next_token_type(Parser* parser) {
-	parser->tokens++;
-	Token tok = *parser->tokens;
-	parser->tokens--;
-	return tok.type;
+	return (token_t)parser->lexer->kinds[fetch_token(parser->ctx, parser->lexer, parser->position + 1)];
+}
+
+void advance_parser(Parser* parser) {
+	parser->position++;
 }
 
-Token advance_parser(Parser* parser) {
-	Token token = *parser->tokens;
-	parser->tokens++; 
-	return token;
+int token_line(Parser* parser, Token token) {
+	int line, column;
+	locate_offset(parser->info, token.offset, &line, &column);
+	return line;
+}
+
+int token_column(Parser* parser, Token token) {
+	int line, column;
+	locate_offset(parser->info, token.offset, &line, &column);
+	return column;
 }
 
 bool at_token_eof(Parser* parser) {
@@ -150,20 +150,20 @@ Node* create_node(CompilerContext* ctx, node_t type,
 	Node* left, Node* right, Node* prev, 
 	Node* next, Node* params, struct Type* t) {
 
-	Node* node = arena_allocate(ctx->ast_arena, sizeof(Node));
+	Node* node = allocate_node(ctx->node_pool);
 	if (!node) {
 		printf("In 'create_node', unable to allocate space for node\n");
 		return NULL;
 	}
 
 	node->type = type;
-	node->left = left;
-	node->right = right;
-	node->prev = prev;
-	node->next = next;
-	node->params = params;
-	node->t = t;
-	node->symbol = NULL;
+	node->left = node_id(left);
+	node->right = node_id(right);
+	node->prev = node_id(prev);
+	node->next = node_id(next);
+	set_node_params(ctx, node, params);
+	set_node_datatype(ctx, node, t);
+	set_node_symbol(ctx, node, NULL);
 
 	return node;
 }
@@ -174,7 +174,7 @@ Node* create_int_node(CompilerContext* ctx, node_t type, int val,
 
 	Node* node = create_node(ctx, type, left, right, prev, next, params, t);
 	if (!node) return NULL;
-	node->value.val = val;
+	node->value = val;
 	return node;
 }
 
@@ -184,15 +184,9 @@ Node* create_string_node(CompilerContext* ctx, node_t type, char* id,
 
 	Node* node = create_node(ctx, type, left, right, prev, next, params, t);
 	if (!node) return NULL;
-	node->value.name = NULL;
-
-	if (id) {
-		int length = strlen(id);
-		node->value.name = arena_allocate(ctx->ast_arena, length + 1);
-		if (!node->value.name) return NULL;
-		strncpy(node->value.name, id, length);
-		id[length] = '\0';
-	}
+
+	// ids come straight from tokens and are already interned
+	set_node_name(ctx, node, id);
 	return node;
 }
 
@@ -226,18 +220,7 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 
 	switch (peek_token_type(parser)) {
 		case TOKEN_ID: {
-			char* id = NULL;
-			{
-				Token tok = peek_token(parser);
-				int length = strlen(tok.value.str);
-				id = arena_allocate(ctx->ast_arena, length + 1);
-				if (!id) {
-					printf("Error: Unable to allocate space for id in 'parse_factor'\n");
-					return NULL;
-				}
-				strncpy(id, tok.value.str, length);
-				id[length] = '\0';
-			}
+			char* id = peek_token(parser).value.str;
 
 			Node* identifier_node = create_string_node(ctx, NODE_NAME, id, NULL, NULL, NULL, NULL, NULL, NULL);
 			if (!identifier_node) {
@@ -263,14 +246,14 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 				
 				if (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_RIGHT_PARENTHESES,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -283,7 +266,7 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 			} else if (peek_token_type(parser) == TOKEN_LEFT_BRACKET) {
 				advance_parser(parser);
 				
-				Node* expr_node = parse_logical_or(ctx, parser);
+				Node* expr_node = parse_expression(ctx, parser);
 				if (!expr_node) {
 					printf("In case 'TOKEN_ID' in 'parse_factor', received NULL expression node.\n");
 					return NULL;
@@ -291,14 +274,14 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 
 				if (peek_token_type(parser) != TOKEN_RIGHT_BRACKET) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_RIGHT_BRACKET,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -344,13 +327,8 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 		case TOKEN_INTEGER: {
 			Token tok = peek_token(parser);
 			int val = tok.value.val;
-			struct Type* t = type_create(ctx, TYPE_INTEGER, NULL);
-			if (!t) {
-				printf("In case 'TOKEN_INTEGER' in 'parse_factor', unable to create type with kind %d\n", TYPE_INTEGER);
-				return NULL;
-			}
-
-			Node* integer_node = create_int_node(ctx, NODE_INTEGER, val, NULL, NULL, NULL, NULL, NULL, t);
+			// literals take their type from their kind, see node_datatype
+			Node* integer_node = create_int_node(ctx, NODE_INTEGER, val, NULL, NULL, NULL, NULL, NULL, NULL);
 			if (!integer_node) {
 				printf("In case 'TOKEN_INTEGER' in 'parse_factor', received NULL integer node.\n");
 				return NULL;
@@ -364,13 +342,7 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 		case TOKEN_CHAR_LITERAL: {
 			Token tok = peek_token(parser);
 			char ch = tok.value.c;
-			struct Type* t = type_create(ctx, TYPE_CHAR, NULL);
-			if (!t) {
-				printf("In case 'TOKEN_CHAR_LITERAL' in 'parse_factor', unable to create type with kind %d\n", TYPE_CHAR);
-				return NULL;
-			}
-
-			Node* character_node = create_int_node(ctx, NODE_CHAR, ch, NULL, NULL, NULL, NULL, NULL, t);
+			Node* character_node = create_int_node(ctx, NODE_CHAR, ch, NULL, NULL, NULL, NULL, NULL, NULL);
 			if (!character_node) {
 				printf("In case 'TOKEN_CHAR_LITERAL' in 'parse_factor', received NULL CHAR LITERAL node.\n");
 				return NULL;
@@ -407,22 +379,22 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 
 		case TOKEN_LEFT_PARENTHESES: {
 			advance_parser(parser);
-			node = parse_logical_or(ctx, parser);
+			node = parse_expression(ctx, parser);
 			if (!node) {
-				printf("In case 'TOKEN_LEFT_PARENTHESES' in 'parse_factor', received NULL node after invoking 'parse_logical_or'.\n");
+				printf("In case 'TOKEN_LEFT_PARENTHESES' in 'parse_factor', received NULL node after invoking 'parse_expression'.\n");
 				return NULL;
 			}
 
 			if (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_RIGHT_PARENTHESES,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -433,22 +405,22 @@ Node* parse_factor(CompilerContext* ctx, Parser* parser) {
 
 		case TOKEN_LEFT_BRACKET: {
 			advance_parser(parser);
-			node = parse_logical_or(ctx, parser);
+			node = parse_expression(ctx, parser);
 			if (!node) {
-				printf("In case 'TOKEN_LEFT_BRACKET' in 'parse_factor', received NULL node after invoking 'parse_logical_or'.\n");
+				printf("In case 'TOKEN_LEFT_BRACKET' in 'parse_factor', received NULL node after invoking 'parse_expression'.\n");
 				return NULL;
 			}
 
 			if (peek_token_type(parser) != TOKEN_RIGHT_BRACKET) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_RIGHT_BRACKET,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -481,8 +453,8 @@ Node* parse_unary(CompilerContext* ctx, Parser* parser) {
 				head = unary_op_node;
 				current = unary_op_node;
 			} else {
-				current->right = unary_op_node;
-				unary_op_node->prev = current;
+				current->right = node_id(unary_op_node);
+				unary_op_node->prev = node_id(current);
 				current = unary_op_node;
 			}
 		} else {
@@ -500,91 +472,64 @@ Node* parse_unary(CompilerContext* ctx, Parser* parser) {
 	}
 
 	if (current) {
-		current->right = parse_factor(ctx, parser);
+		current->right = node_id(parse_factor(ctx, parser));
 		return head;
 	}
 }
 
-Node* parse_multiplicative(CompilerContext* ctx, Parser* parser) {
-	Node* node = parse_unary(ctx, parser);
-	if (!node) return NULL;
-
-	while (peek_token_type(parser) == TOKEN_MUL || peek_token_type(parser) == TOKEN_DIV ||
-		   peek_token_type(parser) == TOKEN_MUL_EQUAL || peek_token_type(parser) == TOKEN_DIV_EQUAL ||
-		   peek_token_type(parser) == TOKEN_MODULO) {
-
-		Token tok = peek_token(parser);
-		node_t op_kind = get_op_kind(&tok);
-		advance_parser(parser);
-		Node* right_child = parse_unary(ctx, parser);
-		node = create_node(ctx, op_kind, node, right_child, NULL, NULL, NULL, NULL);
-	}
-	return node;
-}
-
-Node* parse_additive(CompilerContext* ctx, Parser* parser) {
-	Node* node = parse_multiplicative(ctx, parser);
-	if (!node) return NULL;
-
-	while (peek_token_type(parser) == TOKEN_ADD || peek_token_type(parser) == TOKEN_SUB ||
-		   peek_token_type(parser) == TOKEN_ADD_EQUAL || peek_token_type(parser) == TOKEN_SUB_EQUAL) {
-
-		Token tok = peek_token(parser);
-		node_t op_kind = get_op_kind(&tok);
-		advance_parser(parser);
-		Node* right_child = parse_multiplicative(ctx, parser);
-		node = create_node(ctx, op_kind, node, right_child, NULL, NULL, NULL, NULL);
+precedence_t get_binary_precedence(token_t type) {
+	switch (type) {
+		case TOKEN_LOGICAL_OR: return PRECEDENCE_LOGICAL_OR;
+		case TOKEN_LOGICAL_AND: return PRECEDENCE_LOGICAL_AND;
+		case TOKEN_LESS:
+		case TOKEN_GREATER:
+		case TOKEN_LESS_EQUAL:
+		case TOKEN_GREATER_EQUAL:
+		case TOKEN_EQUAL:
+		case TOKEN_NOT_EQUAL: return PRECEDENCE_RELATIONAL;
+		case TOKEN_ADD:
+		case TOKEN_SUB:
+		case TOKEN_ADD_EQUAL:
+		case TOKEN_SUB_EQUAL: return PRECEDENCE_ADDITIVE;
+		case TOKEN_MUL:
+		case TOKEN_DIV:
+		case TOKEN_MUL_EQUAL:
+		case TOKEN_DIV_EQUAL:
+		case TOKEN_MODULO: return PRECEDENCE_MULTIPLICATIVE;
+		default: return PRECEDENCE_NONE;
 	}
-
-	return node;
 }
 
-Node* parse_relational(CompilerContext* ctx, Parser* parser) {
-	Node* node = parse_additive(ctx, parser);
+// precedence climbing: operators binding at least as tightly as
+// min_precedence are folded in left to right, and each right operand
+// only takes operators that bind tighter than its own, so every level
+// is left associative and a lone operand costs one call. the ceiling
+// only matters after a missing operand, where a tighter operator is
+// left alone and ends the expression
+Node* parse_binary(CompilerContext* ctx, Parser* parser, precedence_t min_precedence) {
+	Node* node = parse_unary(ctx, parser);
 	if (!node) return NULL;
 
-	while (peek_token_type(parser) == TOKEN_LESS || peek_token_type(parser) == TOKEN_GREATER ||
-		   peek_token_type(parser) == TOKEN_LESS_EQUAL || peek_token_type(parser) == TOKEN_GREATER_EQUAL ||
-		   peek_token_type(parser) == TOKEN_EQUAL || peek_token_type(parser) == TOKEN_NOT_EQUAL) {
-
-		Token tok = peek_token(parser);
+	precedence_t ceiling = PRECEDENCE_MULTIPLICATIVE;
+	token_t op = peek_token_type(parser);
+	precedence_t precedence = get_binary_precedence(op);
+	while (precedence >= min_precedence && precedence <= ceiling) {
+		Token tok = {.type = op};
 		node_t op_kind = get_op_kind(&tok);
 		advance_parser(parser);
-		Node* right_child = parse_additive(ctx, parser);
+		Node* right_child = parse_binary(ctx, parser, precedence + 1);
 		node = create_node(ctx, op_kind, node, right_child, NULL, NULL, NULL, NULL);
-	}
-
-	return node;
-}
-
-Node* parse_logical_and(CompilerContext* ctx,Parser* parser) {
-	Node* node = parse_relational(ctx, parser);
-	if (!node) return NULL;
 
-	while (peek_token_type(parser) == TOKEN_LOGICAL_AND) {
-		Token tok = peek_token(parser);
-		node_t op_kind = get_op_kind(&tok);
-		advance_parser(parser);
-		Node* right_child = parse_relational(ctx, parser);
-		node = create_node(ctx, op_kind, node, right_child, NULL, NULL, NULL, NULL);
+		ceiling = precedence;
+		op = peek_token_type(parser);
+		precedence = get_binary_precedence(op);
 	}
 
 	return node;
 }
 
-Node* parse_logical_or(CompilerContext* ctx, Parser* parser) {
-	Node* node = parse_logical_and(ctx,parser);
-	if (!node) return NULL;
-
-	while (peek_token_type(parser) == TOKEN_LOGICAL_OR) {
-		Token tok = peek_token(parser);
-		node_t op_kind = get_op_kind(&tok);
-		advance_parser(parser);
-		Node* right_child = parse_logical_and(ctx, parser);
-		node = create_node(ctx, op_kind, node, right_child, NULL, NULL, NULL, NULL);
-	}
-
-	return node;
+Node* parse_expression(CompilerContext* ctx, Parser* parser) {
+	return parse_binary(ctx, parser, PRECEDENCE_LOGICAL_OR);
 }
 
 Node* parse_statement(CompilerContext* ctx, Parser* parser) {
@@ -596,44 +541,33 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 			if (peek_token_type(parser) != TOKEN_ID) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_IDENTIFIER,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
 				return NULL;
 			}
 
-			char* id = NULL;
-			{
-				Token tok = peek_token(parser);
-				int length = strlen(tok.value.str);
-				id = arena_allocate(ctx->ast_arena, length + 1);
-				if (!id) {
-					printf("Error: Unable to allocate space for id in 'parse_statement()\n");
-					return NULL;
-				}
-				strncpy(id, tok.value.str, length);
-				id[length] = '\0';
-			}
+			char* id = peek_token(parser).value.str;
 
 			advance_parser(parser);
 			if (peek_token_type(parser) != TOKEN_COLON) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_COLON,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -648,14 +582,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				peek_token_type(parser) != TOKEN_STRUCT_KEYWORD) {
 
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_DATATYPE,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -677,19 +611,19 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				struct Type* array_type = type_create(ctx, TYPE_ARRAY, t);
 				if (!array_type) return NULL;
 
-				Node* expr_node = parse_logical_or(ctx, parser);
+				Node* expr_node = parse_expression(ctx, parser);
 				if (!expr_node) return NULL;
 
 				if (peek_token_type(parser) != TOKEN_RIGHT_BRACKET) {
 					Token token = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = token};
 					Error e = {
 						.type = EXPECTED_RIGHT_BRACKET,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -716,14 +650,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 					stmt = create_node(ctx, NODE_ASSIGNMENT, def, array_list, NULL, NULL, NULL, NULL);  
 					if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 						Token token = peek_token(parser);
-						char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+						char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 						error_unit unit = {.token = token};
 						Error e = {
 							.type = EXPECTED_SEMICOLON,
 							.unit = unit,
 							.message = message,
-							.line = tok.line,
-							.column = tok.column,
+							.line = token_line(parser, tok),
+							.column = token_column(parser, tok),
 							.info = ctx->info
 						};
 						log_error(ctx, e);
@@ -742,7 +676,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				if (!def) return NULL;
 
 				advance_parser(parser);
-				Node* expr_node = parse_logical_or(ctx, parser);
+				Node* expr_node = parse_expression(ctx, parser);
 				if (!expr_node) return NULL; 
 
 				stmt = create_node(ctx, NODE_ASSIGNMENT, def, expr_node, NULL, NULL, NULL, NULL);
@@ -758,7 +692,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				if (!stmt) return NULL;
 
 			} else {				
-				Node* node = parse_logical_or(ctx, parser);
+				Node* node = parse_expression(ctx, parser);
 				if (!node) return NULL;
 
 				stmt = create_node(ctx, NODE_RETURN, NULL, node, NULL, NULL, NULL, NULL);
@@ -771,14 +705,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 			advance_parser(parser);
 			if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_SEMICOLON,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -793,14 +727,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 			advance_parser(parser);
 			if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_SEMICOLON,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -817,20 +751,20 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 			if (peek_token_type(parser) != TOKEN_LEFT_PARENTHESES) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_LEFT_PARENTHESES,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
 			} 
 
-			Node* condition_node = parse_logical_or(ctx, parser);
+			Node* condition_node = parse_expression(ctx, parser);
 			if (!condition_node) {
 				printf("Error: received null condition node in if statement\n");
 				return NULL;
@@ -838,14 +772,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 			if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_LEFT_BRACE,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -867,31 +801,31 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				
 				if (peek_token_type(parser) != TOKEN_LEFT_PARENTHESES) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_LEFT_PARENTHESES,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
 				}			
 
-				Node* condition_node = parse_logical_or(ctx, parser);
+				Node* condition_node = parse_expression(ctx, parser);
 
 				if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_LEFT_BRACE,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -925,14 +859,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				// return stmt;
 			} else {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_LEFT_BRACE,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -945,14 +879,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 			if (peek_token_type(parser) != TOKEN_LEFT_PARENTHESES) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_LEFT_PARENTHESES,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -968,7 +902,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				}
 				
 
-				Node* condition = parse_logical_or(ctx, parser);
+				Node* condition = parse_expression(ctx, parser);
 				if (!condition) {
 					printf("Error: Condition in for loop is NULL\n");
 					return NULL;
@@ -977,14 +911,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 				if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_SEMICOLON,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -992,7 +926,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 				advance_parser(parser);
 
-				Node* update = parse_logical_or(ctx, parser);
+				Node* update = parse_expression(ctx, parser);
 				if (!update) {
 					printf("Error: Update expression in for loop is NULL\n");
 					return NULL;
@@ -1000,14 +934,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 				if (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_RIGHT_PARENTHESES,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -1017,14 +951,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 				if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_LEFT_BRACE,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -1033,8 +967,8 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				advance_parser(parser);
 				Node* loop_body = parse_block(ctx, parser);
 				
-				initializer->next = condition;
-				condition->next = update;
+				initializer->next = node_id(condition);
+				condition->next = node_id(update);
 				
 				stmt = create_node(ctx, NODE_FOR, initializer, loop_body, NULL, NULL, NULL, NULL);
 				if (!stmt) return NULL;
@@ -1042,18 +976,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 			} else if (peek_token_type(parser) == TOKEN_ID) {
 				if (peek_next_token_type(parser) == TOKEN_COLON) {
-					char* id = NULL;
-					{
-						Token tok = peek_token(parser);
-						int length = strlen(tok.value.str);
-						id = arena_allocate(ctx->ast_arena, length + 1);
-						if (!id) {
-							printf("Error: Unable to allocate space for id\n");
-							return NULL;
-						}
-						strncpy(id, tok.value.str, length); 
-						id[length] = '\0';
-					}
+					char* id = peek_token(parser).value.str;
 
 					advance_parser(parser); 
 
@@ -1061,14 +984,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 					{
 						if (peek_token_type(parser) != TOKEN_INT_KEYWORD) {
 							Token tok = peek_token(parser);
-							char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+							char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 							error_unit unit = {.token = tok};
 							Error e = {
 								.type = EXPECTED_INT_KEYWORD,
 								.unit = unit,
 								.message = message,
-								.line = tok.line,
-								.column = tok.column,
+								.line = token_line(parser, tok),
+								.column = token_column(parser, tok),
 								.info = ctx->info
 							};
 							log_error(ctx, e);
@@ -1087,14 +1010,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 						if (peek_token_type(parser) != TOKEN_ASSIGNMENT) {
 							Token tok = peek_token(parser);
-							char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+							char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 							error_unit unit = {.token = tok};
 							Error e = {
 								.type = EXPECTED_ASSIGNMENT,
 								.unit = unit,
 								.message = message,
-								.line = tok.line,
-								.column = tok.column,
+								.line = token_line(parser, tok),
+								.column = token_column(parser, tok),
 								.info = ctx->info
 							};
 							log_error(ctx, e);
@@ -1102,7 +1025,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 						advance_parser(parser);
 						
-						Node* expr_node = parse_logical_or(ctx, parser);
+						Node* expr_node = parse_expression(ctx, parser);
 						if (!expr_node) return NULL;
 
 						Node* assignment = create_node(ctx, NODE_ASSIGNMENT, def, expr_node, NULL, NULL, NULL, NULL);
@@ -1110,14 +1033,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 						if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 							Token tok = peek_token(parser);
-							char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+							char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 							error_unit unit = {.token = tok};
 							Error e = {
 								.type = EXPECTED_SEMICOLON,
 								.unit = unit,
 								.message = message,
-								.line = tok.line,
-								.column = tok.column,
+								.line = token_line(parser, tok),
+								.column = token_column(parser, tok),
 								.info = ctx->info
 							};
 							log_error(ctx, e);
@@ -1125,28 +1048,28 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 						advance_parser(parser);
 						
-						Node* condition = parse_logical_or(ctx, parser);
+						Node* condition = parse_expression(ctx, parser);
 						if (condition) {
-							assignment->next = condition;
+							assignment->next = node_id(condition);
 						}
 
 						advance_parser(parser); // skip ';'
 					
-						Node* update = parse_logical_or(ctx, parser);
+						Node* update = parse_expression(ctx, parser);
 						if (update) {
-							condition->next = update;
+							condition->next = node_id(update);
 						}
 
 						if (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
 							Token tok = peek_token(parser);
-							char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+							char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 							error_unit unit = {.token = tok};
 							Error e = {
 								.type = EXPECTED_RIGHT_PARENTHESES,
 								.unit = unit,
 								.message = message,
-								.line = tok.line,
-								.column = tok.column,
+								.line = token_line(parser, tok),
+								.column = token_column(parser, tok),
 								.info = ctx->info
 							};
 							log_error(ctx, e);
@@ -1155,14 +1078,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 						advance_parser(parser);
 						if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 							Token tok = peek_token(parser);
-							char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+							char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 							error_unit unit = {.token = tok};
 							Error e = {
 								.type = EXPECTED_LEFT_BRACE,
 								.unit = unit,
 								.message = message,
-								.line = tok.line,
-								.column = tok.column,
+								.line = token_line(parser, tok),
+								.column = token_column(parser, tok),
 								.info = ctx->info
 							};
 							log_error(ctx, e);
@@ -1181,19 +1104,19 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 					advance_parser(parser); 
 
-					Node* condition = parse_logical_or(ctx, parser);
+					Node* condition = parse_expression(ctx, parser);
 					if (!condition) return NULL;
 
 					if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 						Token tok = peek_token(parser);
-						char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+						char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 						error_unit unit = {.token = tok};
 						Error e = {
 							.type = EXPECTED_SEMICOLON,
 							.unit = unit,
 							.message = message,
-							.line = tok.line,
-							.column = tok.column,
+							.line = token_line(parser, tok),
+							.column = token_column(parser, tok),
 							.info = ctx->info
 						};
 						log_error(ctx, e);
@@ -1201,22 +1124,22 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 					}
 
 					advance_parser(parser);
-					Node* update = parse_logical_or(ctx, parser);
+					Node* update = parse_expression(ctx, parser);
 					if (!update) return NULL;
 					
-					initializer->next = condition;
-					condition->next = update;
+					initializer->next = node_id(condition);
+					condition->next = node_id(update);
 
 					if (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
 						Token tok = peek_token(parser);
-						char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+						char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 						error_unit unit = {.token = tok};
 						Error e = {
 							.type = EXPECTED_RIGHT_PARENTHESES,
 							.unit = unit,
 							.message = message,
-							.line = tok.line,
-							.column = tok.column,
+							.line = token_line(parser, tok),
+							.column = token_column(parser, tok),
 							.info = ctx->info
 						};
 						log_error(ctx, e);
@@ -1226,14 +1149,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 					if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 						Token tok = peek_token(parser);
-						char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+						char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 						error_unit unit = {.token = tok};
 						Error e = {
 							.type = EXPECTED_LEFT_BRACE,
 							.unit = unit,
 							.message = message,
-							.line = tok.line,
-							.column = tok.column,
+							.line = token_line(parser, tok),
+							.column = token_column(parser, tok),
 							.info = ctx->info
 						};
 						log_error(ctx, e);
@@ -1253,32 +1176,32 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 			if (peek_token_type(parser) != TOKEN_LEFT_PARENTHESES) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_LEFT_PARENTHESES,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
 			}
 
-			Node* condition_node = parse_logical_or(ctx, parser);
+			Node* condition_node = parse_expression(ctx, parser);
 			if (!condition_node) return NULL;
 
 			if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 				Token tok = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {.token = tok};
 				Error e = {
 					.type = EXPECTED_LEFT_BRACE,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -1293,20 +1216,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 		}
 
 		case TOKEN_ID: {
-			char* id = NULL;
-			{
-				Token tok = peek_token(parser);
-				if (tok.value.str) {
-					int length = strlen(tok.value.str);
-					id = arena_allocate(ctx->ast_arena, length + 1);
-					if (!id) {
-						printf("Error: Unable to aalocate space for id\n");
-						return NULL;
-					}
-					strncpy(id, tok.value.str, length);
-					id[length] = '\0';
-				}
-			}
+			char* id = peek_token(parser).value.str;
 
 			Node* node = create_string_node(ctx, NODE_NAME, id, NULL, NULL, NULL, NULL, NULL, NULL);
 			if (!node) return NULL;
@@ -1314,7 +1224,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 			advance_parser(parser);
 
 			if (peek_token_type(parser) == TOKEN_LEFT_BRACKET) {
-				Node* index_node = parse_logical_or(ctx, parser);
+				Node* index_node = parse_expression(ctx, parser);
 				if (!index_node) return NULL;
 
 				Node* subscript_node = create_node(ctx, NODE_SUBSCRIPT, node, index_node, NULL, NULL, NULL, NULL);
@@ -1322,14 +1232,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 				if (peek_token_type(parser) != TOKEN_ASSIGNMENT) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_ASSIGNMENT,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -1337,7 +1247,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 
 				advance_parser(parser);
 				
-				Node* expr_node = parse_logical_or(ctx, parser);
+				Node* expr_node = parse_expression(ctx, parser);
 				if (!expr_node) return NULL;
 
 				Node* aug = create_node(ctx, NODE_AUG, subscript_node, NULL, NULL, NULL, NULL, NULL);
@@ -1361,7 +1271,7 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 			
 			} else if (peek_token_type(parser) == TOKEN_ASSIGNMENT) {
 				advance_parser(parser);
-				Node* expr = parse_logical_or(ctx, parser);
+				Node* expr = parse_expression(ctx, parser);
 				if (!expr) return NULL;
 
 				Node* def = create_node(ctx, NODE_AUG, node, NULL, NULL, NULL, NULL, NULL);
@@ -1377,14 +1287,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				if (peek_token_type(parser) != TOKEN_INT_KEYWORD && peek_token_type(parser) != TOKEN_BOOL_KEYWORD &&
 					peek_token_type(parser) != TOKEN_CHAR_KEYWORD) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_DATATYPE,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -1398,14 +1308,14 @@ Node* parse_statement(CompilerContext* ctx, Parser* parser) {
 				advance_parser(parser);
 				if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 					Token tok = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {.token = tok};
 					Error e = {
 						.type = EXPECTED_SEMICOLON,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -1465,13 +1375,13 @@ Node* parse_block(CompilerContext* ctx, Parser* parser) {
 				head = stmt;
 				current = stmt;
 			} else {
-				current->next = stmt;
-				stmt->prev = current;
+				current->next = node_id(stmt);
+				stmt->prev = node_id(current);
 				current = stmt;
 			}
 
 			if (current->type == NODE_ELSE_IF || current->type == NODE_ELSE) {
-				if (!current->prev || (current->prev && (current->prev->type != NODE_IF && current->prev->type != NODE_ELSE_IF))) {
+				if (!node_prev(ctx, current) || (node_prev(ctx, current) && (node_prev(ctx, current)->type != NODE_IF && node_prev(ctx, current)->type != NODE_ELSE_IF))) {
 					printf("Error: else without matching if\n");
 					return NULL;
 				}
@@ -1482,11 +1392,11 @@ Node* parse_block(CompilerContext* ctx, Parser* parser) {
 	}
 
 	if (current) {
-		current->next = NULL;
+		current->next = 0;
 	}
 
 	if (block) {
-		block->right = head;
+		block->right = node_id(head);
 	}
 
 	advance_parser(parser);
@@ -1502,44 +1412,33 @@ Node* parse_parameters(CompilerContext* ctx, Parser* parser) {
 	while (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
 		if (peek_token_type(parser) != TOKEN_ID) {
 			Token tok = peek_token(parser);
-			char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+			char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 			error_unit unit = {.token = tok};
 			Error e = {
 				.type = EXPECTED_IDENTIFIER,
 				.unit = unit,
 				.message = message,
-				.line = tok.line,
-				.column = tok.column,
+				.line = token_line(parser, tok),
+				.column = token_column(parser, tok),
 				.info = ctx->info
 			};
 			log_error(ctx, e);
 		} 
 
-		char* id = NULL;
-		{
-			Token tok = peek_token(parser);
-			int length = strlen(tok.value.str);
-			id = arena_allocate(ctx->ast_arena, length + 1);
-			if (!id) {
-				printf("Error: Unable to allocate space for parameter id\n");
-				return NULL;
-			} 		
-			strncpy(id, tok.value.str, length);
-			id[length] = '\0';
-		}
+		char* id = peek_token(parser).value.str;
 		
 		advance_parser(parser);
 
 		if (peek_token_type(parser) != TOKEN_COLON) {
 			Token tok = peek_token(parser);
-			char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+			char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 			error_unit unit = {.token = tok};
 			Error e = {
 				.type = EXPECTED_COLON,
 				.unit = unit,
 				.message = message,
-				.line = tok.line,
-				.column = tok.column,
+				.line = token_line(parser, tok),
+				.column = token_column(parser, tok),
 				.info = ctx->info
 			};
 			log_error(ctx, e);
@@ -1552,14 +1451,14 @@ Node* parse_parameters(CompilerContext* ctx, Parser* parser) {
 			peek_token_type(parser) != TOKEN_BOOL_KEYWORD) {
 
 			Token tok = peek_token(parser);
-			char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+			char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 			error_unit unit =  {.token = tok};
 			Error e = {
 				.type = EXPECTED_DATATYPE,
 				.unit = unit,
 				.message = message,
-				.line = tok.line,
-				.column = tok.column,
+				.line = token_line(parser, tok),
+				.column = token_column(parser, tok),
 				.info = ctx->info
 			};
 			log_error(ctx, e);
@@ -1592,8 +1491,8 @@ Node* parse_parameters(CompilerContext* ctx, Parser* parser) {
 				head = wrapped_param;
 				current = wrapped_param;
 			} else {
-				current->next = wrapped_param;
-				wrapped_param->prev = current;
+				current->next = node_id(wrapped_param);
+				wrapped_param->prev = node_id(current);
 				current = wrapped_param;
 			}
 		}
@@ -1605,7 +1504,7 @@ Node* parse_parameters(CompilerContext* ctx, Parser* parser) {
 	}
 
 	if (wrapped_param) {
-		wrapped_param->next = NULL;
+		wrapped_param->next = 0;
 	}
 
 	return head;
@@ -1628,14 +1527,14 @@ Node* parse_function(CompilerContext* ctx, Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_ID) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_IDENTIFIER,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -1676,32 +1575,21 @@ Node* parse_function(CompilerContext* ctx, Parser* parser) {
 		return NULL;
 	}
 
-	char* id = NULL;
-	{
-		Token tok = peek_token(parser);
-		int length = strlen(tok.value.str);
-		id = arena_allocate(ctx->ast_arena, length + 1);
-		if (!id) {
-			printf("In 'parse_function', error: unable to allocate space for function identifier '%s'.\n", tok.value.str);
-			return NULL;
-		}
-		strncpy(id, tok.value.str, length);
-		id[length] = '\0';
-	}
+	char* id = peek_token(parser).value.str;
 
 	advance_parser(parser);
 	
 	Node* params = NULL;
 	if (peek_token_type(parser) != TOKEN_LEFT_PARENTHESES) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_LEFT_PARENTHESES,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -1718,14 +1606,14 @@ Node* parse_function(CompilerContext* ctx, Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_ARROW) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_ARROW,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -1742,14 +1630,14 @@ Node* parse_function(CompilerContext* ctx, Parser* parser) {
 
 	if (!valid_function_return_type(type)) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_DATATYPE,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -1770,14 +1658,14 @@ Node* parse_function(CompilerContext* ctx, Parser* parser) {
 	Node* function_body = NULL;
 	if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 		Token token = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, token.line, token.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, token), token_column(parser, token));
 		error_unit unit = {.token = token};
 		Error e = {
 			.type = EXPECTED_LEFT_BRACE,
 			.unit = unit,
 			.message = message,
-			.line = token.line,
-			.column = token.column,
+			.line = token_line(parser, token),
+			.column = token_column(parser, token),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -1806,7 +1694,7 @@ Node* parse_args(CompilerContext* ctx, Parser* parser) {
 	Node* arg = NULL;
 
 	while (peek_token_type(parser) != TOKEN_RIGHT_PARENTHESES) {
-		arg = parse_logical_or(ctx, parser);
+		arg = parse_expression(ctx, parser);
 		Node* wrapped_arg = create_node(ctx, NODE_ARG, NULL, arg, NULL, NULL, NULL, NULL);
 
 		if (wrapped_arg) {
@@ -1814,8 +1702,8 @@ Node* parse_args(CompilerContext* ctx, Parser* parser) {
 				head = wrapped_arg;
 				current = wrapped_arg;
 			} else {
-				current->next = wrapped_arg;
-				wrapped_arg->prev = current;
+				current->next = node_id(wrapped_arg);
+				wrapped_arg->prev = node_id(current);
 				current = wrapped_arg;
 			}
 		} else {
@@ -1830,7 +1718,7 @@ Node* parse_args(CompilerContext* ctx, Parser* parser) {
 	}
 
 	if (current) {
-		current->next = NULL;
+		current->next = 0;
 	}
 	return head;
 }
@@ -1843,15 +1731,15 @@ Node* parse_array_list(CompilerContext* ctx, Parser* parser, int* element_count)
 	advance_parser(parser);	
 
 	while (peek_token_type(parser) != TOKEN_RIGHT_BRACE) {
-		array_element = parse_logical_or(ctx, parser);
+		array_element = parse_expression(ctx, parser);
 
 		if (array_element) {
 			if (!head) {
 				head = array_element;
 				current = array_element;
 			} else {
-				current->next = array_element;
-				array_element->prev = current;
+				current->next = node_id(array_element);
+				array_element->prev = node_id(current);
 				current = array_element;
 			}
 		} else {
@@ -1867,7 +1755,7 @@ Node* parse_array_list(CompilerContext* ctx, Parser* parser, int* element_count)
 	}
 
 	if (current) {
-		current->right = NULL;
+		current->right = 0;
 	}
 
 	advance_parser(parser);
@@ -1890,9 +1778,13 @@ void synchronize(Parser* parser, token_t* synchronizations, size_t length) {
 
 Node* parse(CompilerContext* ctx, Lexer* lexer) {
 	ctx->phase = PHASE_PARSER;
+	ctx->node_pool = create_node_pool(ctx);
+	if (!ctx->node_pool) return NULL;
 
 	Parser parser =  {
-		.tokens = lexer->tokens,
+		.ctx = ctx,
+		.lexer = lexer,
+		.position = 0,
 		.info = lexer->info
 	};
 
@@ -1938,14 +1830,21 @@ Node* parse(CompilerContext* ctx, Lexer* lexer) {
 				head = node;
 				current = node;
 			} else {
-				current->next = node;
-				node->prev = current;
+				current->next = node_id(node);
+				node->prev = node_id(current);
 				current = node;
 			}
 		} else {
 			synchronize(&parser, synchronizations, length);
 		}
 	}
+
+	// a streaming lexer's errors are only known now; they are reported
+	// instead of the parser's, as they would be without streaming
+	if (lexer->streaming) {
+		ctx->phase = PHASE_LEXER;
+		if (!phase_accumulated_errors(ctx)) ctx->phase = PHASE_PARSER;
+	}
 	return head;
 }
 
@@ -1955,44 +1854,33 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_ID) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_IDENTIFIER,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
 	}
 
-	char* id = NULL;
-	{
-		Token tok = peek_token(parser);
-		int length = strlen(tok.value.str);
-		id = arena_allocate(ctx->ast_arena, length + 1);
-		if (!id) {
-			printf("Error: Unable to allocate space for id in 'parse_let'\n");
-			return NULL;
-		}
-		strncpy(id, tok.value.str, length);
-		id[length] = '\0';
-	}
+	char* id = peek_token(parser).value.str;
 
 	advance_parser(parser);
 	
 	if (peek_token_type(parser) != TOKEN_COLON) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_COLON,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -2004,14 +1892,14 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 		peek_token_type(parser) != TOKEN_CHAR_KEYWORD &&
 		peek_token_type(parser) != TOKEN_BOOL_KEYWORD) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {.token = tok};
 		Error e = {
 			.type = EXPECTED_DATATYPE,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -2030,12 +1918,12 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 			struct Type* array_type = type_create(ctx, TYPE_ARRAY, t);
 			if (!array_type) return NULL;
 
-			Node* expr_node = parse_logical_or(ctx, parser);
+			Node* expr_node = parse_expression(ctx, parser);
 			if (!expr_node) return NULL;
 
 			if (peek_token_type(parser) != TOKEN_RIGHT_BRACKET) {
 				Token token = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {
 					.token = token
 				};
@@ -2044,8 +1932,8 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 					.type = EXPECTED_RIGHT_BRACKET,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -2076,7 +1964,7 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 
 				if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 					Token token = peek_token(parser);
-					char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+					char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 					error_unit unit = {
 						.token = token
 					};
@@ -2085,8 +1973,8 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 						.type = EXPECTED_SEMICOLON,
 						.unit = unit,
 						.message = message,
-						.line = tok.line,
-						.column = tok.column,
+						.line = token_line(parser, tok),
+						.column = token_column(parser, tok),
 						.info = ctx->info
 					};
 					log_error(ctx, e);
@@ -2104,7 +1992,7 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 			Node* assignee = create_string_node(ctx, NODE_NAME, id, NULL, NULL, NULL, NULL, NULL, t);
 			if (!assignee) return NULL;
 
-			Node* expr_node = parse_logical_or(ctx, parser);
+			Node* expr_node = parse_expression(ctx, parser);
 			if (!expr_node) return NULL;
 			
 			let_node = create_string_node(ctx, NODE_ASSIGNMENT, NULL, assignee, expr_node, NULL, NULL, NULL, NULL);
@@ -2112,7 +2000,7 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 
 			if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 				Token token = peek_token(parser);
-				char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+				char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 				error_unit unit = {
 					.token = token
 				};
@@ -2121,8 +2009,8 @@ Node* parse_let(CompilerContext* ctx,Parser* parser) {
 					.type = EXPECTED_SEMICOLON,
 					.unit = unit,
 					.message = message,
-					.line = tok.line,
-					.column = tok.column,
+					.line = token_line(parser, tok),
+					.column = token_column(parser, tok),
 					.info = ctx->info
 				};
 				log_error(ctx, e);
@@ -2142,7 +2030,7 @@ Node* parse_enum_body(CompilerContext* ctx, Parser* parser) {
 	while (peek_token_type(parser) != TOKEN_RIGHT_BRACE) {
 		if (peek_token_type(parser) != TOKEN_ID) {
 			Token tok = peek_token(parser);
-			char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+			char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 			error_unit unit = {
 				.token = tok
 			};
@@ -2151,22 +2039,14 @@ Node* parse_enum_body(CompilerContext* ctx, Parser* parser) {
 				.type = EXPECTED_IDENTIFIER,
 				.unit = unit,
 				.message = message,
-				.line = tok.line,
-				.column = tok.column,
+				.line = token_line(parser, tok),
+				.column = token_column(parser, tok),
 				.info = ctx->info
 			};
 			log_error(ctx, e);
 		}
 
-		char* id = NULL;
-		{
-			Token tok = peek_token(parser);
-			int length = strlen(tok.value.str);
-			id = arena_allocate(ctx->ast_arena, length + 1);
-			if (!id) return NULL;
-			strncpy(id, tok.value.str, length);
-			id[length] = '\0';
-		}
+		char* id = peek_token(parser).value.str;
 
 		stmt = create_string_node(ctx, NODE_NAME, id, NULL, NULL, NULL, NULL, NULL, NULL);
 		if (stmt) {
@@ -2174,8 +2054,8 @@ Node* parse_enum_body(CompilerContext* ctx, Parser* parser) {
 				head = stmt;
 				current = stmt;
 			} else {
-				current->next = stmt;
-				stmt->prev = current;
+				current->next = node_id(stmt);
+				stmt->prev = node_id(current);
 				current = stmt;
 			}
 
@@ -2202,7 +2082,7 @@ Node* parse_enum(CompilerContext* ctx, Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_ID) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {
 			.token = tok
 		};
@@ -2211,28 +2091,20 @@ Node* parse_enum(CompilerContext* ctx, Parser* parser) {
 			.type = EXPECTED_IDENTIFIER,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
 	}
 
-	char* id = NULL;
-	{
-		Token tok = peek_token(parser);
-		int length = strlen(tok.value.str);
-		id = arena_allocate(ctx->ast_arena, length + 1);
-		if (!id) return NULL;
-		strncpy(id, tok.value.str, length);
-		id[length] = '\0';
-	}
+	char* id = peek_token(parser).value.str;
 
 	advance_parser(parser);
 
 	if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {
 			.token = tok
 		};
@@ -2241,8 +2113,8 @@ Node* parse_enum(CompilerContext* ctx, Parser* parser) {
 			.type = EXPECTED_LEFT_BRACE,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -2255,7 +2127,7 @@ Node* parse_enum(CompilerContext* ctx, Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {
 			.token = tok
 		};
@@ -2264,8 +2136,8 @@ Node* parse_enum(CompilerContext* ctx, Parser* parser) {
 			.type = EXPECTED_SEMICOLON,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -2284,7 +2156,7 @@ Node* parse_struct(CompilerContext* ctx, Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_ID) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {
 			.token = tok
 		};
@@ -2293,28 +2165,20 @@ Node* parse_struct(CompilerContext* ctx, Parser* parser) {
 			.type = EXPECTED_IDENTIFIER,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
 	}
 
-	char* id = NULL;
-	{
-		Token tok = peek_token(parser);
-		int length = strlen(tok.value.str);
-		id = arena_allocate(ctx->ast_arena, length + 1);
-		if (!id) return NULL;
-		strncpy(id, tok.value.str, length);
-		id[length] = '\0';
-	}
+	char* id = peek_token(parser).value.str;
 
 	advance_parser(parser);
 
 	if (peek_token_type(parser) != TOKEN_LEFT_BRACE) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = { 
 			.token = tok 
 		};
@@ -2323,8 +2187,8 @@ Node* parse_struct(CompilerContext* ctx, Parser* parser) {
 			.type = EXPECTED_LEFT_BRACE,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -2337,7 +2201,7 @@ Node* parse_struct(CompilerContext* ctx, Parser* parser) {
 
 	if (peek_token_type(parser) != TOKEN_SEMICOLON) {
 		Token tok = peek_token(parser);
-		char* message = error_prelude(ctx, parser->info->filename, tok.line, tok.column);
+		char* message = error_prelude(ctx, parser->info->filename, token_line(parser, tok), token_column(parser, tok));
 		error_unit unit = {
 			.token = tok
 		};
@@ -2346,8 +2210,8 @@ Node* parse_struct(CompilerContext* ctx, Parser* parser) {
 			.type = EXPECTED_SEMICOLON,
 			.unit = unit,
 			.message = message,
-			.line = tok.line,
-			.column = tok.column,
+			.line = token_line(parser, tok),
+			.column = token_column(parser, tok),
 			.info = ctx->info
 		};
 		log_error(ctx, e);
@@ -11,8 +11,22 @@ typedef struct CompilerContext CompilerContext;
 
 #define INIT_SPECIAL_STATEMENTS_CAPACITY 100
 
+// how tightly each binary operator binds, loosest first
+typedef enum {
+	PRECEDENCE_NONE,
+	PRECEDENCE_LOGICAL_OR,
+	PRECEDENCE_LOGICAL_AND,
+	PRECEDENCE_RELATIONAL,
+	PRECEDENCE_ADDITIVE,
+	PRECEDENCE_MULTIPLICATIVE
+} precedence_t;
+
+// tokens are read from the lexer's arrays, which a streaming lexer fills
+// on demand; position is the index of the next one
 typedef struct {
-	Token* tokens;
+	CompilerContext* ctx;
+	Lexer* lexer;
+	int position;
 	FileInfo* info;
 } Parser;
 
@@ -24,7 +38,9 @@ bool match_token(Parser* parser, char expected);
 token_t peek_token_type(Parser* parser);
 Token peek_token(Parser* parser);
 token_t peek_next_token_type(Parser* parser);
-Token advance_parser(Parser* parser);
+void advance_parser(Parser* parser);
+int token_line(Parser* parser, Token token);
+int token_column(Parser* parser, Token token);
 bool at_token_eof(Parser* parser);
 
 node_t get_op_kind(Token* token);
@@ -45,11 +61,9 @@ Node* create_int_node(CompilerContext* ctx, node_t type, int val, Node* left, No
 
 Node* parse_factor(CompilerContext* ctx, Parser* parser);
 Node* parse_unary(CompilerContext* ctx, Parser* parser);
-Node* parse_multiplicative(CompilerContext* ctx, Parser* parser);
-Node* parse_additive(CompilerContext* ctx, Parser* parser);
-Node* parse_relational(CompilerContext* ctx, Parser* parser);
-Node* parse_logical_and(CompilerContext* ctx, Parser* parser);
-Node* parse_logical_or(CompilerContext* ctx, Parser* parser);
+precedence_t get_binary_precedence(token_t type);
+Node* parse_binary(CompilerContext* ctx, Parser* parser, precedence_t min_precedence);
+Node* parse_expression(CompilerContext* ctx, Parser* parser);
 
 Node* parse_statement(CompilerContext* ctx,Parser* parser);
 Node* parse_block(CompilerContext* ctx,Parser* parser);
@@ -0,0 +1,248 @@
+#include "linearscan.h"
+#include "regalloc.h"
+#include "assert.h"
+#include "backend.h"
+#include <limits.h>
+#include <stdlib.h>
+
+int compare_intervals(const void* a, const void* b) {
+	const LiveInterval* first = a;
+	const LiveInterval* second = b;
+	if (first->start != second->start) return first->start - second->start;
+	return first->node - second->node;
+}
+
+void extend_interval(int* starts, int* ends, int node, int position) {
+	if (node == -1) return;
+	if (position < starts[node]) starts[node] = position;
+	if (position > ends[node]) ends[node] = position;
+}
+
+void extend_over_set(BitSet* set, int* starts, int* ends, int position) {
+	for (int w = 0; w < set->num_words; w++) {
+		uint64_t word = set->words[w];
+		while (word) {
+			int node = w * BITSET_WORD_BITS + __builtin_ctzll(word);
+			extend_interval(starts, ends, node, position);
+			word &= word - 1;
+		}
+	}
+}
+
+// positions count instructions in block order; the ids from the TAC builder
+// are not used because an ARG is created before the expression it passes.
+// a value's interval runs from the first to the last position it appears at,
+// and a value live into or out of a block is live at that block's first or
+// last instruction, which also stretches it over loop back edges
+LinearScan* build_live_intervals(CompilerContext* ctx, FunctionInfo* info) {
+	CFG* cfg = info->cfg;
+	OperandNumbering* numbering = cfg->numbering;
+
+	LinearScan* scan = arena_allocate(ctx->codegen_arena, sizeof(LinearScan));
+	int* starts = arena_allocate(ctx->codegen_arena, sizeof(int) * (numbering->count + 1));
+	int* ends = arena_allocate(ctx->codegen_arena, sizeof(int) * (numbering->count + 1));
+	if (!scan || !starts || !ends) return NULL;
+
+	int num_positions = 0;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		num_positions += cfg->all_blocks[i]->num_instructions;
+	}
+	scan->calls = arena_allocate(ctx->codegen_arena, sizeof(int) * (num_positions + 1));
+	scan->divisions = arena_allocate(ctx->codegen_arena, sizeof(int) * (num_positions + 1));
+	if (!scan->calls || !scan->divisions) return NULL;
+	scan->num_calls = 0;
+	scan->num_divisions = 0;
+
+	for (int node = 0; node < numbering->count; node++) {
+		starts[node] = INT_MAX;
+		ends[node] = -1;
+	}
+
+	int position = 0;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		if (block->num_instructions == 0) continue;
+
+		extend_over_set(block->in_set, starts, ends, position);
+		for (int j = 0; j < block->num_instructions; j++, position++) {
+			TACInstruction* tac = block->instructions[j];
+			if (!tac) continue;
+			if (tac->kind == TAC_CALL) scan->calls[scan->num_calls++] = position;
+			if (tac->kind == TAC_DIV || tac->kind == TAC_MODULO) scan->divisions[scan->num_divisions++] = position;
+
+			extend_interval(starts, ends, find_operand_number(numbering, tac->result), position);
+			extend_interval(starts, ends, find_operand_number(numbering, tac->op1), position);
+			extend_interval(starts, ends, find_operand_number(numbering, tac->op2), position);
+		}
+		extend_over_set(block->out_set, starts, ends, position - 1);
+	}
+
+	scan->intervals = arena_allocate(ctx->codegen_arena, sizeof(LiveInterval) * (numbering->count + 1));
+	scan->fixed = arena_allocate(ctx->codegen_arena, sizeof(LiveInterval) * (numbering->count + 1));
+	scan->active = arena_allocate(ctx->codegen_arena, sizeof(LiveInterval*) * (NUM_REGISTERS + 1));
+	if (!scan->intervals || !scan->fixed || !scan->active) return NULL;
+
+	scan->num_intervals = 0;
+	scan->num_fixed = 0;
+	scan->num_active = 0;
+	scan->spilled = 0;
+
+	for (int node = 0; node < numbering->count; node++) {
+		if (ends[node] == -1) continue;
+
+		Operand* op = numbering->operands[node];
+		LiveInterval interval = {
+			.node = node,
+			.start = starts[node],
+			.end = ends[node],
+			.reg = op->assigned_register
+		};
+
+		// same candidates as graph colouring: values that own a definition bundle
+		if (op->assigned_register != -1) {
+			scan->fixed[scan->num_fixed++] = interval;
+		} else if (!op->permanent_frame_position && op->interference_bundle) {
+			scan->intervals[scan->num_intervals++] = interval;
+		}
+	}
+
+	qsort(scan->intervals, scan->num_intervals, sizeof(LiveInterval), compare_intervals);
+	return scan;
+}
+
+bool fixed_interval_overlaps(LinearScan* scan, int reg, LiveInterval* interval) {
+	for (int i = 0; i < scan->num_fixed; i++) {
+		LiveInterval* fixed = &scan->fixed[i];
+		if (fixed->reg != reg) continue;
+		if (fixed->start <= interval->end && interval->start <= fixed->end) return true;
+	}
+	return false;
+}
+
+// a value live on both sides of a call stays out of the caller-saved
+// registers, as with graph colouring; only the pre-coloured parameters are
+// left there, and codegen saves those around the call
+bool crosses_call(LinearScan* scan, LiveInterval* interval) {
+	for (int i = 0; i < scan->num_calls; i++) {
+		int position = scan->calls[i];
+		if (position >= interval->end) break;
+		if (position > interval->start) return true;
+	}
+	return false;
+}
+
+// div writes rax and rdx, so a value live on both sides of one stays out of
+// them. the operands are last read and the result first written at the div
+// itself, so they may still use them
+bool crosses_division(LinearScan* scan, LiveInterval* interval) {
+	for (int i = 0; i < scan->num_divisions; i++) {
+		int position = scan->divisions[i];
+		if (position >= interval->end) break;
+		if (position > interval->start) return true;
+	}
+	return false;
+}
+
+bool register_allowed(LinearScan* scan, Operand* op, int reg, LiveInterval* interval) {
+	if (op->restricted && is_restricted(op->restricted_regs, op->restricted_regs_count, reg)) return false;
+	if (is_caller_saved(reg) && crosses_call(scan, interval)) return false;
+	if ((reg == 0 || reg == 4) && crosses_division(scan, interval)) return false;
+	return !fixed_interval_overlaps(scan, reg, interval);
+}
+
+// intervals are closed, so a value whose last use is the instruction that
+// defines another still holds its register there
+void expire_intervals(LinearScan* scan, int position, bool* in_use) {
+	int kept = 0;
+	for (int i = 0; i < scan->num_active; i++) {
+		LiveInterval* interval = scan->active[i];
+		if (interval->end < position) {
+			in_use[interval->reg] = false;
+		} else {
+			scan->active[kept++] = interval;
+		}
+	}
+	scan->num_active = kept;
+}
+
+void insert_active(LinearScan* scan, LiveInterval* interval) {
+	int i = scan->num_active++;
+	while (i > 0 && scan->active[i - 1]->end > interval->end) {
+		scan->active[i] = scan->active[i - 1];
+		i--;
+	}
+	scan->active[i] = interval;
+}
+
+void linear_scan_function(CompilerContext* ctx, FunctionInfo* info) {
+	LinearScan* scan = build_live_intervals(ctx, info);
+	assert(scan);
+
+	Operand** operands = info->cfg->numbering->operands;
+	bool in_use[NUM_REGISTERS] = {false};
+
+	for (int i = 0; i < scan->num_intervals; i++) {
+		LiveInterval* current = &scan->intervals[i];
+		Operand* op = operands[current->node];
+		expire_intervals(scan, current->start, in_use);
+
+		for (int reg = 0; reg < NUM_REGISTERS; reg++) {
+			if (in_use[reg] || !register_allowed(scan, op, reg, current)) continue;
+
+			current->reg = reg;
+			break;
+		}
+
+		if (current->reg != -1) {
+			op->assigned_register = current->reg;
+			in_use[current->reg] = true;
+			insert_active(scan, current);
+			continue;
+		}
+
+		// no free register: the active value that lives longest goes to the
+		// frame instead, if it outlives this one and its register fits here
+		LiveInterval* victim = NULL;
+		for (int k = scan->num_active - 1; k >= 0; k--) {
+			LiveInterval* candidate = scan->active[k];
+			if (candidate->end <= current->end) break;
+			if (register_allowed(scan, op, candidate->reg, current)) {
+				victim = candidate;
+				break;
+			}
+		}
+
+		if (victim) {
+			Operand* victim_op = operands[victim->node];
+			victim_op->assigned_register = -1;
+			victim_op->permanent_frame_position = true;
+
+			int k = 0;
+			while (scan->active[k] != victim) k++;
+			for (; k < scan->num_active - 1; k++) {
+				scan->active[k] = scan->active[k + 1];
+			}
+			scan->num_active--;
+
+			current->reg = victim->reg;
+			op->assigned_register = current->reg;
+			insert_active(scan, current);
+		} else {
+			op->permanent_frame_position = true;
+		}
+		scan->spilled++;
+	}
+
+	if (ctx->verbose) {
+		fprintf(ctx->function->report, "linear scan: %s: %d intervals, %d fixed, %d in frame\n",
+			info->symbol->name, scan->num_intervals, scan->num_fixed, scan->spilled);
+	}
+}
+
+void linear_scan(CompilerContext* ctx, FunctionList* function_list) {
+	for (int i = 0; i < function_list->size; i++) {
+		FunctionInfo* info = function_list->infos[i];
+		pre_color_nodes(info);
+		linear_scan_function(ctx, info);
+	}
+}
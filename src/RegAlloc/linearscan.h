@@ -0,0 +1,42 @@
+#ifndef LINEAR_SCAN_H
+#define LINEAR_SCAN_H
+
+#include "compilercontext.h"
+#include "IR/cfg.h"
+
+typedef struct {
+	int node;
+	int start; // first position the value is live at
+	int end; // last position the value is live at
+	int reg;
+} LiveInterval;
+
+typedef struct {
+	LiveInterval* intervals; // values that need a register, by start
+	int num_intervals;
+	LiveInterval* fixed; // values pre-coloured by the calling convention
+	int num_fixed;
+	int* calls; // positions of the calls, in order
+	int num_calls;
+	int* divisions; // positions of the divs and mods, in order
+	int num_divisions;
+
+	LiveInterval** active; // intervals holding a register, by end
+	int num_active;
+
+	int spilled;
+} LinearScan;
+
+void extend_interval(int* starts, int* ends, int node, int position);
+void extend_over_set(BitSet* set, int* starts, int* ends, int position);
+LinearScan* build_live_intervals(CompilerContext* ctx, FunctionInfo* info);
+bool fixed_interval_overlaps(LinearScan* scan, int reg, LiveInterval* interval);
+bool crosses_call(LinearScan* scan, LiveInterval* interval);
+bool crosses_division(LinearScan* scan, LiveInterval* interval);
+bool register_allowed(LinearScan* scan, Operand* op, int reg, LiveInterval* interval);
+void expire_intervals(LinearScan* scan, int position, bool* in_use);
+void insert_active(LinearScan* scan, LiveInterval* interval);
+void linear_scan_function(CompilerContext* ctx, FunctionInfo* info);
+void linear_scan(CompilerContext* ctx, FunctionList* function_list);
+
+#endif
@@ -1,27 +1,9 @@
 #include "regalloc.h"
 #include "assert.h"
 #include "IR/tac.h"
-
-void find_new_register(InterferenceBundle* bundle, int* remaining_registers, Operand* op) {
-	for (int i = 0; i < NUM_REGISTERS; i++) {
-		if (remaining_registers[i] == -1) continue;
-		bool can_use = true;
-	
-		for (int j = 0; j < bundle->interferes_with->size; j++) {
-			Operand* interfering_op = bundle->interferes_with->elements[j];
-			if (interfering_op->permanent_frame_position) continue;
-			if (interfering_op->assigned_register == remaining_registers[i]) {
-				can_use = false;
-				break;
-			}
-		}
-
-		if (can_use) {
-			op->assigned_register = remaining_registers[i];
-			break;
-		} 
-	}
-}
+#include "Codegen/codegen.h"
+#include "linearscan.h"
+#include "backend.h"
 
 bool is_restricted(int* restricted_regs, int restricted_regs_count, int reg) {
 	for (int i = 0; i < restricted_regs_count; i++) {
@@ -102,85 +84,505 @@ void pre_color_nodes(FunctionInfo* info) {
 	}
 }
 
-int* get_remaining_registers(CompilerContext* ctx, int* restricted_regs, int restricted_regs_count) {
-	int* remaining_registers = arena_allocate(ctx->codegen_arena, sizeof(int) * NUM_REGISTERS);
-	if (!remaining_registers) return NULL;
+// each occurrence of a value costs a load or store if it lives in the frame,
+// and an occurrence inside k nested loops runs roughly 10^k times as often
+double* compute_spill_costs(CompilerContext* ctx, FunctionInfo* info) {
+	CFG* cfg = info->cfg;
+	double* costs = arena_allocate(ctx->codegen_arena, sizeof(double) * (cfg->numbering->count + 1));
+	assert(costs);
 
-	for (int i = 0; i < NUM_REGISTERS; i++) {
-		remaining_registers[i] = i;
+	for (int i = 0; i < cfg->num_blocks; i++) {
+		BasicBlock* block = cfg->all_blocks[i];
+		int depth = block->loop_depth < MAX_SPILL_LOOP_DEPTH ? block->loop_depth : MAX_SPILL_LOOP_DEPTH;
+
+		double weight = 1.0;
+		for (int d = 0; d < depth; d++) {
+			weight *= SPILL_LOOP_WEIGHT;
+		}
+
+		for (int j = 0; j < block->num_instructions; j++) {
+			TACInstruction* tac = block->instructions[j];
+			if (!tac) continue;
+
+			Operand* ops[3] = {tac->result, tac->op1, tac->op2};
+			for (int k = 0; k < 3; k++) {
+				int node = find_operand_number(cfg->numbering, ops[k]);
+				if (node != -1) costs[node] += weight;
+			}
+		}
 	}
+	return costs;
+}
 
-	for (int i = 0; i < restricted_regs_count; i++) {
-		for (int j = 0; j < NUM_REGISTERS; j++) {
-			if (restricted_regs[i] == remaining_registers[j]) {
-				remaining_registers[j] = -1;
+int available_colors(Allocator* allocator, int node) {
+	return NUM_REGISTERS - __builtin_popcount(allocator->forbidden[node]);
+}
+
+Allocator* create_allocator(CompilerContext* ctx, FunctionInfo* info) {
+	Allocator* allocator = arena_allocate(ctx->codegen_arena, sizeof(Allocator));
+	if (!allocator) return NULL;
+
+	int n = info->graph->num_nodes + 1;
+	allocator->graph = info->graph;
+	allocator->states = arena_allocate(ctx->codegen_arena, sizeof(alloc_state) * n);
+	allocator->degrees = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->stack = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->worklist = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->forbidden = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->clobbered = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->arg_register = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->alias = arena_allocate(ctx->codegen_arena, sizeof(int) * n);
+	allocator->spill_costs = compute_spill_costs(ctx, info);
+	if (!allocator->states || !allocator->degrees || !allocator->stack || !allocator->worklist ||
+		!allocator->forbidden || !allocator->clobbered || !allocator->arg_register || !allocator->alias) return NULL;
+
+	allocator->stack_size = 0;
+	allocator->worklist_size = 0;
+	allocator->rounds = 0;
+	allocator->spilled = 0;
+	allocator->coalesced = 0;
+
+	// only operands that own a definition bundle take part; the rest (call
+	// targets, compares folded into their jump) never need a register
+	for (int node = 0; node < info->graph->num_nodes; node++) {
+		Operand* op = info->graph->numbering->operands[node];
+		allocator->alias[node] = node;
+		allocator->clobbered[node] = 0;
+		allocator->arg_register[node] = -1;
+		allocator->forbidden[node] = 0;
+		for (int i = 0; op->restricted && i < op->restricted_regs_count; i++) {
+			allocator->forbidden[node] |= 1 << op->restricted_regs[i];
+		}
+
+		if (op->assigned_register != -1) {
+			allocator->states[node] = ALLOC_PRECOLORED;
+		} else if (op->permanent_frame_position || !op->interference_bundle) {
+			allocator->states[node] = ALLOC_IGNORED;
+		} else {
+			allocator->states[node] = ALLOC_ACTIVE;
+		}
+	}
+	return allocator;
+}
+
+int find_alias(Allocator* allocator, int node) {
+	while (allocator->alias[node] != node) {
+		node = allocator->alias[node];
+	}
+	return node;
+}
+
+bool is_live_node(Allocator* allocator, int node) {
+	return allocator->states[node] == ALLOC_ACTIVE || allocator->states[node] == ALLOC_PRECOLORED;
+}
+
+// a call overwrites the caller-saved registers and div always writes rax and
+// rdx, so a value live across either must not be coalesced into them, and is
+// kept out of them altogether; codegen saves the caller-saved registers around
+// a call only for the pre-coloured parameters. what a div defines is written
+// after it, so it may still go in rax or rdx
+void collect_clobbers(Allocator* allocator, FunctionInfo* info) {
+	InterferenceGraph* graph = allocator->graph;
+	int caller_saved = 0;
+	for (int reg = 0; reg < NUM_REGISTERS; reg++) {
+		if (is_caller_saved(reg)) caller_saved |= 1 << reg;
+	}
+
+	for (int i = 0; i < info->cfg->num_blocks; i++) {
+		BasicBlock* block = info->cfg->all_blocks[i];
+		for (int j = 0; j < block->num_instructions; j++) {
+			TACInstruction* tac = block->instructions[j];
+			if (!tac) continue;
+
+			int mask = 0;
+			switch (tac->kind) {
+				case TAC_CALL: mask = caller_saved; break;
+				case TAC_DIV:
+				case TAC_MODULO: mask = (1 << 0) | (1 << 4); break;
+				case TAC_ARG: {
+					int node = interference_node(graph, tac->op1);
+					int reg = tac->result->assigned_register;
+					if (node == -1 || reg == -1) break;
+
+					if (allocator->arg_register[node] == -1) {
+						allocator->arg_register[node] = reg;
+					} else if (allocator->arg_register[node] != reg) {
+						allocator->arg_register[node] = -2;
+					}
+					break;
+				}
+				default: break;
+			}
+			if (!mask || !tac->live_out) continue;
+
+			int defined = tac->kind == TAC_CALL ? -1 : interference_node(graph, tac->result);
+			for (int k = 0; k < tac->live_out->size; k++) {
+				int node = interference_node(graph, tac->live_out->elements[k]);
+				if (node == -1) continue;
+
+				allocator->clobbered[node] |= mask;
+				if (node != defined) allocator->forbidden[node] |= mask;
 			}
 		}
 	}
-	return remaining_registers;
 }
 
-void color_interference_graphs(CompilerContext* ctx, FunctionList* function_list) {
-	for (int i = 0; i < function_list->size; i++) {
-		FunctionInfo* info = function_list->infos[i];
-		// printf("\nAbout to color interference graph for function \033[32m%s\033[0m\n", info->symbol->name);
-		InterferenceGraph* graph = info->graph;
+// Briggs: the merged node has fewer than k neighbours of significant degree
+bool can_coalesce_nodes(Allocator* allocator, int node1, int node2) {
+	InterferenceGraph* graph = allocator->graph;
+	if (interferes(graph, node1, node2)) return false;
 
-		pre_color_nodes(info);
+	int forbidden = allocator->forbidden[node1] | allocator->forbidden[node2];
+	int k = NUM_REGISTERS - __builtin_popcount(forbidden);
+	int significant = 0;
+
+	int nodes[2] = {node1, node2};
+	for (int n = 0; n < 2; n++) {
+		for (int i = 0; i < graph->degrees[nodes[n]]; i++) {
+			int neighbour = graph->adjacency[nodes[n]][i];
+			if (!is_live_node(allocator, neighbour)) continue;
+
+			// neighbours of both were already counted, and lose one edge in the merge
+			if (n == 1 && interferes(graph, neighbour, node1)) continue;
+
+			int degree = allocator->degrees[neighbour];
+			if (n == 0 && degree == available_colors(allocator, neighbour) && interferes(graph, neighbour, node2)) {
+				degree--;
+			}
+
+			if (allocator->states[neighbour] == ALLOC_PRECOLORED || degree >= available_colors(allocator, neighbour)) {
+				if (++significant >= k) return false;
+			}
+		}
+	}
+	return true;
+}
+
+void merge_nodes(CompilerContext* ctx, Allocator* allocator, int node, int other) {
+	InterferenceGraph* graph = allocator->graph;
+
+	for (int i = 0; i < graph->degrees[other]; i++) {
+		int neighbour = graph->adjacency[other][i];
+		if (!is_live_node(allocator, neighbour)) continue;
+
+		if (interferes(graph, node, neighbour)) {
+			allocator->degrees[neighbour]--;
+		} else {
+			add_interference(ctx, graph, node, neighbour);
+			allocator->degrees[node]++;
+		}
+	}
+
+	allocator->forbidden[node] |= allocator->forbidden[other];
+	allocator->clobbered[node] |= allocator->clobbered[other];
+	allocator->spill_costs[node] += allocator->spill_costs[other];
+
+	int arg_register = allocator->arg_register[other];
+	if (allocator->arg_register[node] == -1) {
+		allocator->arg_register[node] = arg_register;
+	} else if (arg_register != -1 && arg_register != allocator->arg_register[node]) {
+		allocator->arg_register[node] = -2;
+	}
+
+	allocator->states[other] = ALLOC_COALESCED;
+	allocator->alias[other] = node;
+	allocator->coalesced++;
+}
+
+// George: every neighbour either could not use reg anyway or has few enough
+// neighbours that losing reg cannot stop it being coloured
+bool can_coalesce_register(Allocator* allocator, int node, int reg) {
+	InterferenceGraph* graph = allocator->graph;
+	int bit = 1 << reg;
+
+	if (allocator->clobbered[node] & bit) return false;
+
+	// the move itself is why rax or its own argument register was off limits;
+	// being an argument of another call, or a div operand, still rules it out
+	if (reg >= ARG_OFFSET && reg < ARG_OFFSET + 6) {
+		if (allocator->arg_register[node] != -1 && allocator->arg_register[node] != reg) return false;
+	} else if (reg != 0 && (allocator->forbidden[node] & bit)) {
+		return false;
+	}
+
+	for (int i = 0; i < graph->degrees[node]; i++) {
+		int neighbour = graph->adjacency[node][i];
+		if (!is_live_node(allocator, neighbour)) continue;
+
+		Operand* op = graph->numbering->operands[neighbour];
+		if (allocator->states[neighbour] == ALLOC_PRECOLORED) {
+			if (op->assigned_register == reg) return false;
+			continue;
+		}
+
+		if (allocator->forbidden[neighbour] & bit) continue;
+		if (allocator->degrees[neighbour] >= available_colors(allocator, neighbour)) return false;
+	}
+	return true;
+}
+
+// reg is the fixed register src arrives in, or -1 for a copy between two values
+void coalesce_move(CompilerContext* ctx, Allocator* allocator, Operand* dest, Operand* src, int reg) {
+	InterferenceGraph* graph = allocator->graph;
+	int node = interference_node(graph, dest);
+	if (node == -1) return;
+	node = find_alias(allocator, node);
+
+	if (reg == -1) {
+		int other = interference_node(graph, src);
+		if (other == -1) return;
+		other = find_alias(allocator, other);
+		if (node == other || interferes(graph, node, other)) return;
+
+		if (allocator->states[other] == ALLOC_PRECOLORED) {
+			reg = graph->numbering->operands[other]->assigned_register;
+		} else if (allocator->states[node] == ALLOC_PRECOLORED) {
+			reg = graph->numbering->operands[node]->assigned_register;
+			node = other;
+		} else {
+			if (allocator->states[node] != ALLOC_ACTIVE || allocator->states[other] != ALLOC_ACTIVE) return;
+			if (can_coalesce_nodes(allocator, node, other)) {
+				merge_nodes(ctx, allocator, node, other);
+			}
+			return;
+		}
+	}
+
+	if (allocator->states[node] != ALLOC_ACTIVE) return;
+	if (can_coalesce_register(allocator, node, reg)) {
+		graph->numbering->operands[node]->assigned_register = reg;
+		allocator->states[node] = ALLOC_PRECOLORED;
+		allocator->coalesced++;
+	}
+}
 
-		for (int j = 0; j < graph->size; j++) {
-			InterferenceBundle* bundle = graph->bundles[j];
-			Operand* op = bundle->operand;
-			
-			// pre colored
-			if (op->assigned_register != -1 || op->permanent_frame_position) continue;
-			
-			for (int reg = 0; reg < NUM_REGISTERS; reg++) {
-				bool can_use = true;
-
-				for (int k = 0; k < bundle->interferes_with->size; k++) {
-					Operand* interfering_op = bundle->interferes_with->elements[k];
-
-					if (interfering_op->permanent_frame_position) continue;
-					if (interfering_op->assigned_register == reg) {
-						can_use = false;
+// copies between values are merged first so that a chain like
+// t = _RET; x = t; return x ends up as one node that can sit in rax
+void coalesce_moves(CompilerContext* ctx, Allocator* allocator, FunctionInfo* info) {
+	InterferenceGraph* graph = allocator->graph;
+	collect_clobbers(allocator, info);
+
+	for (int node = 0; node < graph->num_nodes; node++) {
+		if (allocator->states[node] != ALLOC_ACTIVE) continue;
+
+		int degree = 0;
+		for (int k = 0; k < graph->degrees[node]; k++) {
+			if (is_live_node(allocator, graph->adjacency[node][k])) degree++;
+		}
+		allocator->degrees[node] = degree;
+	}
+
+	CFG* cfg = info->cfg;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < cfg->num_blocks; i++) {
+			BasicBlock* block = cfg->all_blocks[i];
+			for (int j = 0; j < block->num_instructions; j++) {
+				TACInstruction* tac = block->instructions[j];
+				if (!tac) continue;
+
+				switch (tac->kind) {
+					case TAC_ASSIGNMENT: {
+						if (!tac->op2) break;
+						if (tac->op2->kind != OP_RETURN && pass == 0) {
+							coalesce_move(ctx, allocator, tac->result, tac->op2, -1);
+						} else if (tac->op2->kind == OP_RETURN && pass == 1) {
+							coalesce_move(ctx, allocator, tac->result, NULL, 0);
+						}
 						break;
 					}
-				}
 
-				if (can_use) {
-					if (op->restricted && is_restricted(op->restricted_regs, op->restricted_regs_count, reg)) {
-						int* remaining_registers = get_remaining_registers(ctx, op->restricted_regs, op->restricted_regs_count);
-						assert(remaining_registers);
-						find_new_register(bundle, remaining_registers, op);	
-					} else {
-						op->assigned_register = reg;
-						// switch (op->kind) {
-						// 	case OP_SYMBOL: {
-						// 		printf("'%s' has been assigned register=%d\n", op->value.sym->name, reg);
-						// 		break;
-						// 	}
-						// 	default: {
-						// 		printf("'%s' has been assigned register=%d\n", op->value.label_name, reg);
-						// 		break;
-						// 	}
-						// }
+					case TAC_ARG: {
+						if (pass == 1 && tac->op1 && tac->result->assigned_register != -1) {
+							coalesce_move(ctx, allocator, tac->op1, NULL, tac->result->assigned_register);
+						}
+						break;
 					}
-					break;
+
+					case TAC_RETURN: {
+						if (pass == 1 && tac->result && tac->op1) {
+							coalesce_move(ctx, allocator, tac->op1, NULL, tac->result->assigned_register);
+						}
+						break;
+					}
+
+					default:
+						break;
 				}
 			}
+		}
+	}
+}
+
+void remove_from_graph(Allocator* allocator, int node) {
+	InterferenceGraph* graph = allocator->graph;
+
+	allocator->states[node] = ALLOC_SIMPLIFIED;
+	allocator->stack[allocator->stack_size++] = node;
+
+	for (int k = 0; k < graph->degrees[node]; k++) {
+		int neighbour = graph->adjacency[node][k];
+		if (allocator->states[neighbour] != ALLOC_ACTIVE) continue;
+
+		allocator->degrees[neighbour]--;
+		if (allocator->degrees[neighbour] == available_colors(allocator, neighbour) - 1) {
+			allocator->worklist[allocator->worklist_size++] = neighbour;
+		}
+	}
+}
+
+// cheapest value per unit of pressure relieved
+int choose_spill_candidate(Allocator* allocator) {
+	int candidate = -1;
+	double best = 0;
+
+	for (int node = 0; node < allocator->graph->num_nodes; node++) {
+		if (allocator->states[node] != ALLOC_ACTIVE) continue;
+
+		double cost = allocator->spill_costs[node] / (allocator->degrees[node] + 1);
+		if (candidate == -1 || cost < best) {
+			candidate = node;
+			best = cost;
+		}
+	}
+	return candidate;
+}
+
+void simplify(Allocator* allocator) {
+	InterferenceGraph* graph = allocator->graph;
+	int remaining = 0;
+
+	allocator->stack_size = 0;
+	allocator->worklist_size = 0;
+	for (int node = 0; node < graph->num_nodes; node++) {
+		if (allocator->states[node] != ALLOC_ACTIVE) continue;
+
+		int degree = 0;
+		for (int k = 0; k < graph->degrees[node]; k++) {
+			alloc_state state = allocator->states[graph->adjacency[node][k]];
+			if (state == ALLOC_ACTIVE || state == ALLOC_PRECOLORED) degree++;
+		}
+		allocator->degrees[node] = degree;
+		remaining++;
+
+		if (degree < available_colors(allocator, node)) {
+			allocator->worklist[allocator->worklist_size++] = node;
+		}
+	}
+
+	while (remaining > 0) {
+		int node = -1;
+		while (allocator->worklist_size > 0) {
+			int candidate = allocator->worklist[--allocator->worklist_size];
+			if (allocator->states[candidate] == ALLOC_ACTIVE) {
+				node = candidate;
+				break;
+			}
+		}
+
+		// every remaining node is significant; push the cheapest one anyway
+		// and let select find out whether its neighbours left it a colour
+		if (node == -1) {
+			node = choose_spill_candidate(allocator);
+		}
+
+		remove_from_graph(allocator, node);
+		remaining--;
+	}
+}
+
+// returns the number of nodes that found no register
+int select_registers(Allocator* allocator) {
+	InterferenceGraph* graph = allocator->graph;
+	int spilled = 0;
+
+	while (allocator->stack_size > 0) {
+		int node = allocator->stack[--allocator->stack_size];
+		Operand* op = graph->numbering->operands[node];
+
+		bool used[NUM_REGISTERS] = {false};
+		for (int k = 0; k < graph->degrees[node]; k++) {
+			Operand* neighbour = graph->numbering->operands[graph->adjacency[node][k]];
+			if (neighbour->permanent_frame_position || neighbour->assigned_register == -1) continue;
+			used[neighbour->assigned_register] = true;
+		}
+
+		for (int reg = 0; reg < NUM_REGISTERS; reg++) {
+			if (used[reg]) continue;
+			if (allocator->forbidden[node] & (1 << reg)) continue;
 
-			if (op->assigned_register == -1) {
+			op->assigned_register = reg;
+			break;
+		}
+
+		if (op->assigned_register == -1) {
+			allocator->states[node] = ALLOC_SPILLED;
+			spilled++;
+		}
+	}
+	return spilled;
+}
+
+// values that do not get a register are kept in their frame slot and
+// codegen borrows a register around each access, so spilling adds no new
+// live ranges; the graph is rebuilt without the spilled nodes and coloured
+// again until a round spills nothing new
+void color_function(CompilerContext* ctx, FunctionInfo* info) {
+	Allocator* allocator = create_allocator(ctx, info);
+	assert(allocator);
+
+	InterferenceGraph* graph = info->graph;
+	coalesce_moves(ctx, allocator, info);
+
+	int spilled = 0;
+	do {
+		allocator->rounds++;
+		for (int node = 0; node < graph->num_nodes; node++) {
+			Operand* op = graph->numbering->operands[node];
+			if (allocator->states[node] == ALLOC_SPILLED) {
 				op->permanent_frame_position = true;
+				allocator->states[node] = ALLOC_IGNORED;
+			} else if (allocator->states[node] == ALLOC_SIMPLIFIED) {
+				op->assigned_register = -1;
+				allocator->states[node] = ALLOC_ACTIVE;
 			}
 		}
+
+		simplify(allocator);
+		spilled = select_registers(allocator);
+		allocator->spilled += spilled;
+	} while (spilled > 0);
+
+	for (int node = 0; node < graph->num_nodes; node++) {
+		if (allocator->states[node] != ALLOC_COALESCED) continue;
+
+		Operand* op = graph->numbering->operands[node];
+		Operand* representative = graph->numbering->operands[find_alias(allocator, node)];
+		op->assigned_register = representative->assigned_register;
+		op->permanent_frame_position = representative->permanent_frame_position;
+	}
+
+	if (ctx->verbose) {
+		fprintf(ctx->function->report, "regalloc: %s: %d nodes, %d edges, %d coalesced, %d in frame, %d rounds\n",
+			info->symbol->name, graph->num_nodes, graph->num_edges, allocator->coalesced, allocator->spilled, allocator->rounds);
+	}
+}
+
+void color_interference_graphs(CompilerContext* ctx, FunctionList* function_list) {
+	for (int i = 0; i < function_list->size; i++) {
+		FunctionInfo* info = function_list->infos[i];
+		pre_color_nodes(info);
+		color_function(ctx, info);
 	}
 }
 
 void reg_alloc(CompilerContext* ctx, FunctionList* function_list) {
 	if (!function_list) return;
 
-	color_interference_graphs(ctx, function_list);
+	if (ctx->linear_scan) {
+		linear_scan(ctx, function_list);
+	} else {
+		color_interference_graphs(ctx, function_list);
+	}
 	// check_regs(function_list);
 }
 
@@ -7,12 +7,58 @@
 #define INIT_IDEALIZED_ASM_INSTRUCTIONS_CAPACITY 500
 #define NUM_REGISTERS 14
 #define ARG_OFFSET 2
+#define SPILL_LOOP_WEIGHT 10
+#define MAX_SPILL_LOOP_DEPTH 6
+
+typedef enum {
+	ALLOC_IGNORED,
+	ALLOC_PRECOLORED,
+	ALLOC_ACTIVE,
+	ALLOC_SIMPLIFIED,
+	ALLOC_SPILLED,
+	ALLOC_COALESCED
+} alloc_state;
+
+typedef struct {
+	InterferenceGraph* graph;
+	alloc_state* states;
+	int* degrees; // neighbours still in the graph while simplifying
+	double* spill_costs;
+
+	int* forbidden; // mask of registers the node must avoid
+	int* clobbered; // mask of registers a call or div overwrites while the node is live
+	int* arg_register; // argument register the node is passed in, -2 if passed in several
+	int* alias; // node a coalesced node was merged into
+
+	int* stack;
+	int stack_size;
+	int* worklist;
+	int worklist_size;
+
+	int rounds;
+	int spilled;
+	int coalesced;
+} Allocator;
 
 bool is_restricted(int* restricted_regs, int restricted_regs_count, int reg);
-void find_new_register(InterferenceBundle* bundle, int* remaining_registers, Operand* op);
 void application_binary_interface(TACInstruction* tac, int* arg_index, int* param_index);
 void pre_color_nodes(FunctionInfo* info);
-int* get_remaining_registers(CompilerContext* ctx, int* restricted_regs, int restricted_regs_count);
+double* compute_spill_costs(CompilerContext* ctx, FunctionInfo* info);
+int available_colors(Allocator* allocator, int node);
+Allocator* create_allocator(CompilerContext* ctx, FunctionInfo* info);
+int find_alias(Allocator* allocator, int node);
+bool is_live_node(Allocator* allocator, int node);
+void collect_clobbers(Allocator* allocator, FunctionInfo* info);
+bool can_coalesce_nodes(Allocator* allocator, int node1, int node2);
+void merge_nodes(CompilerContext* ctx, Allocator* allocator, int node, int other);
+bool can_coalesce_register(Allocator* allocator, int node, int reg);
+void coalesce_move(CompilerContext* ctx, Allocator* allocator, Operand* dest, Operand* src, int reg);
+void coalesce_moves(CompilerContext* ctx, Allocator* allocator, FunctionInfo* info);
+void remove_from_graph(Allocator* allocator, int node);
+int choose_spill_candidate(Allocator* allocator);
+void simplify(Allocator* allocator);
+int select_registers(Allocator* allocator);
+void color_function(CompilerContext* ctx, FunctionInfo* info);
 void color_interference_graphs(CompilerContext* ctx, FunctionList* list);
 void reg_alloc(CompilerContext* ctx, FunctionList* function_list);
 void check_regs(FunctionList* function_list);
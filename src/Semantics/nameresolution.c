@@ -99,53 +99,53 @@ bool is_stack_empty(CompilerContext* ctx) {
 	return ctx->symbol_stack->top == -1;
 }
 
+unsigned int hash_name(char* name) {
+	unsigned int hash = 0;
+	while (*name) {
+		hash = (hash << 1) + (unsigned char)*name++;
+	}
+	return hash;
+}
+
 int hash(int table_capacity, char* name) {
 	if (!name) return -1;
-	int hash = 0;
-	while (*name) {
-		hash = (hash << 1) + *name++;
+	return hash_name(name) % (unsigned int)table_capacity;
+}
+
+Symbol* lookup_symbol_in_table(SymbolTable* table, char* name, unsigned int name_hash) {
+	Symbol* current_symbol = table->symbols[name_hash % (unsigned int)table->capacity];
+	while (current_symbol) {
+		if (current_symbol->name == name) {
+			return current_symbol;
+		}
+		current_symbol = current_symbol->link;
 	}
-	return hash % table_capacity;
+	return NULL;
 }
 
-Symbol* lookup_symbol_in_all_scopes(CompilerContext* ctx, Symbol* symbol) {
-	if (!symbol) return NULL;
+// 'name' must be interned
+Symbol* lookup_symbol_in_all_scopes(CompilerContext* ctx, char* name) {
+	if (!name) return NULL;
 
+	unsigned int name_hash = hash_name(name);
 	for (int i = ctx->symbol_stack->top; i >= 0; i--) {
 		SymbolTable* current_table = ctx->symbol_stack->tables[i];
 		if (!current_table) continue;
 
-		for (int j = 0; j < current_table->capacity; j++) {
-			Symbol* current_symbol = current_table->symbols[j];
-			while (current_symbol) {
-				Symbol* link_to_current_symbol = current_symbol->link;
-				if (symbol->name && strcmp(symbol->name, current_symbol->name) == 0) {
-					return current_symbol;
-				}
-				current_symbol = link_to_current_symbol;
-			}
-		}
+		Symbol* found = lookup_symbol_in_table(current_table, name, name_hash);
+		if (found) return found;
 	}
 	return NULL;
 }
 
-Symbol* lookup_symbol_in_current_scope(CompilerContext* ctx, Symbol* symbol) {
-	if (!symbol) return NULL;
+// 'name' must be interned
+Symbol* lookup_symbol_in_current_scope(CompilerContext* ctx, char* name) {
+	if (!name) return NULL;
 
 	SymbolTable* current_table = ctx->symbol_stack->tables[ctx->symbol_stack->top];
 	if (!current_table) return NULL;
-	
-	for (int i = 0; i < current_table->capacity; i++) {
-		Symbol* current_symbol = current_table->symbols[i];
-		while (current_symbol) {
-			Symbol* link_to_current_symbol = current_symbol->link;
-			if (symbol->name && strcmp(symbol->name, current_symbol->name) == 0) {
-				return current_symbol;
-			}
-			current_symbol = link_to_current_symbol;
-		}
-	}
-	return NULL;
+
+	return lookup_symbol_in_table(current_table, name, hash_name(name));
 }
 
 TypeKind get_kind(struct Type* t) {
@@ -221,11 +221,11 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 			push_context(ctx, CONTEXT_OP);
 
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 
 			if (node->right) {
-				resolve_expression(ctx, node->right);
+				resolve_expression(ctx, node_right(ctx, node));
 			}
 			pop_context();
 			break;
@@ -236,7 +236,7 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 		case NODE_NOT: {
 			push_context(ctx, CONTEXT_OP);
 			if (node->right) {
-				resolve_expression(ctx, node->right);
+				resolve_expression(ctx, node_right(ctx, node));
 			}
 			pop_context();
 			break;
@@ -246,7 +246,7 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 		case NODE_INCREMENT: {
 			push_context(ctx, CONTEXT_OP);
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 			pop_context();
 			break;
@@ -255,10 +255,10 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 
 		case NODE_ARRAY_LIST: {
 			if (node->right) {
-				Node* element = node->right;
+				Node* element = node_right(ctx, node);
 				while (element) {
 					resolve_expression(ctx, element);
-					element = element->next;
+					element = node_next(ctx, element);
 				}
 			}
 			break;
@@ -268,14 +268,14 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 			push_context(ctx, CONTEXT_CALL);
 			
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 			pop_context();
 
-			if (node->params) {
-				Node* arg = node->params;
+			if (node_params(ctx, node)) {
+				Node* arg = node_params(ctx, node);
 				while (arg) {
-					Node* next = arg->next;
+					Node* next = node_next(ctx, arg);
 					resolve_expression(ctx, arg);
 					arg = next;	
 				}
@@ -285,7 +285,7 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 
 		case NODE_ARG: {
 			if (node->right) {
-				resolve_expression(ctx, node->right);
+				resolve_expression(ctx, node_right(ctx, node));
 			} 
 			break;
 		}
@@ -294,27 +294,26 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 			SymbolTable* current_table = ctx->symbol_stack->tables[ctx->symbol_stack->top];
 			if (!current_table) return;
 				
-			Symbol* node_symbol = node->symbol;
-
 			// for definitions
-			if (node->t && !node->symbol) {
+			if (node_datatype(ctx, node) && !node_symbol(ctx, node)) {
 				// ensure def names are distinct from function names and keywords
-				bool valid_def = distinct_from_keywords(ctx, node->value.name);
+				bool valid_def = distinct_from_keywords(ctx, node_name(ctx, node));
 				if (!valid_def) {
 					assert(false);
 				} 
 
-				Symbol* new_symbol = create_symbol(ctx, SYMBOL_LOCAL, node->value.name, NULL, node->t);
-				int hash_key = hash(current_table->capacity, node->value.name);
+				char* name = node_name(ctx, node);
+				Symbol* new_symbol = create_symbol(ctx, SYMBOL_LOCAL, name, NULL, node_datatype(ctx, node));
+				int hash_key = hash(current_table->capacity, name);
 
 				if (hash_key >= 0) {
 					bind(ctx, LOCAL, new_symbol, hash_key);
-					node->symbol = (void*)new_symbol;
+					set_node_symbol(ctx, node, (void*)new_symbol);
 				}
 
 				// if array, resolving index
 				if (node->left) {
-					resolve_expression(ctx, node->left);
+					resolve_expression(ctx, node_left(ctx, node));
 				}
 				break;
 			} 
@@ -322,33 +321,22 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 			context_t type = peek_context();
 			if (type == CONTEXT_CALL) {
 				// log error if calling main function.
-				if (strcmp(node->value.name, "main") == 0) {
+				if (strcmp(node_name(ctx, node), "main") == 0) {
 					assert(false);
 				}
 				
-				Symbol* temp_symbol = create_symbol(ctx, SYMBOL_LOCAL, node->value.name, NULL, NULL);
-				Symbol* func_symbol = lookup_function_symbol(ctx, temp_symbol);
+				Symbol* func_symbol = lookup_function_symbol(ctx, node_name(ctx, node));
 				if (!func_symbol) {
-					printf("\033[31mError\033[0m: attempting to invoke function '%s' that does not exist\n", node->value.name);
+					printf("\033[31mError\033[0m: attempting to invoke function '%s' that does not exist\n", node_name(ctx, node));
 				} 
-				node->symbol = func_symbol;
+				set_node_symbol(ctx, node, func_symbol);
 				break;
 			}
 
-			Symbol* temp_symbol = create_symbol(ctx, SYMBOL_LOCAL, node->value.name, NULL, NULL);
-			
-			Symbol* retrieved_symbol = lookup_symbol_in_current_scope(ctx, temp_symbol);
+			Symbol* retrieved_symbol = lookup_symbol_in_all_scopes(ctx, node_name(ctx, node));
 			if (retrieved_symbol) {
-				node->symbol = (void*)retrieved_symbol;
-				node->t = (void*)retrieved_symbol->type;
-			
-			} else {
-				retrieved_symbol = lookup_symbol_in_all_scopes(ctx, temp_symbol);
-				
-				if (retrieved_symbol) {
-					node->symbol = (void*)retrieved_symbol;
-					node->t = (void*)retrieved_symbol->type;
-				} 
+				set_node_symbol(ctx, node, (void*)retrieved_symbol);
+				set_node_datatype(ctx, node, (void*)retrieved_symbol->type);
 			}
 			break;
 		}
@@ -356,7 +344,7 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 		case NODE_DEF:
 		case NODE_DECL: {
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 			break;
 		}
@@ -364,8 +352,8 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 		case NODE_AUG: {
 			push_context(ctx, CONTEXT_AUG);
 			if (node->left) {
-				resolve_expression(ctx, node->left);
-				node->symbol = node->left->symbol;
+				resolve_expression(ctx, node_left(ctx, node));
+				set_node_symbol(ctx, node, node_symbol(ctx, node_left(ctx, node)));
 			}
 			pop_context();
 			break;
@@ -374,23 +362,23 @@ void resolve_expression(CompilerContext* ctx, Node* node) {
 		case NODE_SUBSCRIPT: {
 			push_context(ctx, CONTEXT_SUBSCRIPT);
 			if (node->left) {
-				resolve_expression(ctx, node->left);	
+				resolve_expression(ctx, node_left(ctx, node));	
 			}
 
 			if (node->right) {
-				resolve_expression(ctx, node->right);
+				resolve_expression(ctx, node_right(ctx, node));
 			}
 
 			if (node->left) {
-				node->symbol = node->left->symbol;
+				set_node_symbol(ctx, node, node_symbol(ctx, node_left(ctx, node)));
 				
 				Type* retrieved_type = NULL;
-				if (node->symbol) {
-					retrieved_type = ((Symbol*)node->symbol)->type;
+				if (node_symbol(ctx, node)) {
+					retrieved_type = ((Symbol*)node_symbol(ctx, node))->type;
 				}
 
 				if (retrieved_type) {
-					node->t = (void*)retrieved_type->subtype;
+					set_node_datatype(ctx, node, (void*)retrieved_type->subtype);
 				}
 			}
 
@@ -409,11 +397,11 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 			push_context(ctx, CONTEXT_IF);
 			push_scope(ctx);
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 
 			if (node->right) {
-				resolve_statement(ctx, node->right);
+				resolve_statement(ctx, node_right(ctx, node));
 			} 
 			
 			pop_scope(ctx);
@@ -424,7 +412,7 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 		case NODE_ELSE: {
 			push_scope(ctx);
 			if (node->right) {
-				resolve_statement(ctx, node->right);
+				resolve_statement(ctx, node_right(ctx, node));
 			}
 			pop_scope(ctx);
 			break;
@@ -435,11 +423,11 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 			push_context(ctx, CONTEXT_LOOP);
 
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 
 			if (node->right) {
-				resolve_statement(ctx, node->right);
+				resolve_statement(ctx, node_right(ctx, node));
 			}
 
 			pop_scope(ctx);
@@ -452,21 +440,21 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 			push_context(ctx, CONTEXT_LOOP);
 
 			if (node->left) {
-				resolve_statement(ctx, node->left);
+				resolve_statement(ctx, node_left(ctx, node));
 			}
 
-			Node* condition = node->left ? node->left->next : NULL;
+			Node* condition = node_left(ctx, node) ? node_next(ctx, node_left(ctx, node)) : NULL;
 			if (condition) {
 				resolve_expression(ctx, condition);
 			}
 
-			Node* update = condition ? condition->next : NULL;
+			Node* update = condition ? node_next(ctx, condition) : NULL;
 			if (update) {
 				resolve_expression(ctx, update);
 			}
 
 			if (node->right) {
-				resolve_statement(ctx, node->right);
+				resolve_statement(ctx, node_right(ctx, node));
 			}
 
 			pop_context();
@@ -480,7 +468,7 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 			} else {
 				context_lookup(CONTEXT_NONVOID_FUNCTION);
 				push_context(ctx, CONTEXT_RETURN);
-				resolve_expression(ctx, node->right);
+				resolve_expression(ctx, node_right(ctx, node));
 				pop_context();
 			}
 			break;
@@ -488,12 +476,12 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 
 		case NODE_ASSIGNMENT: {
 			if (node->left) {
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 			}
 			
 			if (node->right) {
 				push_context(ctx, CONTEXT_ASSIGNMENT);
-				resolve_expression(ctx, node->right);
+				resolve_expression(ctx, node_right(ctx, node));
 				pop_context();
 			}
 			break;
@@ -501,9 +489,9 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 
 		case NODE_BLOCK: {
 			if (node->right) {
-				Node* stmt = node->right;
+				Node* stmt = node_right(ctx, node);
 				while (stmt) {
-					Node* stmt_next = stmt->next;
+					Node* stmt_next = node_next(ctx, stmt);
 					resolve_statement(ctx, stmt);
 					stmt = stmt_next;
 				}
@@ -515,7 +503,7 @@ void resolve_statement(CompilerContext* ctx, Node* node) {
 		case NODE_INCREMENT: {
 			if (node->left) {
 				push_context(ctx, CONTEXT_OP);
-				resolve_expression(ctx, node->left);
+				resolve_expression(ctx, node_left(ctx, node));
 				pop_context();
 			}
 			break;
@@ -540,15 +528,16 @@ void resolve_params(CompilerContext* ctx, Node* node) {
 
 	Node* current_wrapped_param = node;
 	while (current_wrapped_param) {
-		Node* next_wrapped_param = current_wrapped_param->next;
+		Node* next_wrapped_param = node_next(ctx, current_wrapped_param);
 
-		Node* param = current_wrapped_param->right;
+		Node* param = node_right(ctx, current_wrapped_param);
 		if (param) {
-			int hash_key = hash(current_table->capacity, param->value.name);
+			char* name = node_name(ctx, param);
+			int hash_key = hash(current_table->capacity, name);
 			if (hash_key >= 0) {
-				Symbol* sym = create_symbol(ctx, SYMBOL_PARAM, param->value.name, NULL, param->t);
+				Symbol* sym = create_symbol(ctx, SYMBOL_PARAM, name, NULL, node_datatype(ctx, param));
 				bind(ctx, LOCAL, sym, hash_key);
-				param->symbol = (void*)sym;
+				set_node_symbol(ctx, param, (void*)sym);
 			}
 		}
 
@@ -563,22 +552,24 @@ void resolve_globals(CompilerContext* ctx, Node* node) {
 			assert(current_table);
 
 			int hash_key = -1;
+			char* name = NULL;
 			if (node->left) {
-				hash_key = hash(current_table->capacity, node->left->value.name);
+				name = node_name(ctx, node_left(ctx, node));
+				hash_key = hash(current_table->capacity, name);
 			}
 
 			if (hash_key >= 0) {
-				Symbol* sym = create_symbol(ctx, SYMBOL_GLOBAL, node->left->value.name, NULL, node->left->t);		
-				if (!lookup_symbol_in_current_scope(sym, hash_key)) {
+				Symbol* sym = create_symbol(ctx, SYMBOL_GLOBAL, name, NULL, node_datatype(ctx, node_left(ctx, node)));		
+				if (!lookup_symbol_in_current_scope(ctx, name)) {
 					bind(ctx, GLOBAL, sym, hash_key);
-					node->left->symbol = (void*)sym;
+					set_node_symbol(ctx, node_left(ctx, node), (void*)sym);
 				} 
 			}
 			break;
 		}
 
 		case NODE_NAME: {
-			Type* type = node->t;
+			Type* type = node_datatype(ctx, node);
 			if (!type) return;
 
 			if (type->kind != TYPE_FUNCTION) return;
@@ -595,22 +586,23 @@ void resolve_globals(CompilerContext* ctx, Node* node) {
 			SymbolTable* current_table = ctx->symbol_stack->tables[ctx->symbol_stack->top];
 			assert(current_table);
 
-			Symbol* local_func_symbol = create_symbol(ctx, SYMBOL_LOCAL, node->value.name, NULL, NULL);
+			char* name = node_name(ctx, node);
+			Symbol* local_func_symbol = create_symbol(ctx, SYMBOL_LOCAL, name, NULL, NULL);
 			assert(local_func_symbol);
 			
-			int hash_key = hash(current_table->capacity, node->value.name);
+			int hash_key = hash(current_table->capacity, name);
 			if (hash_key != -1) {
 				// treating func symbol as LOCAL to scope to prevent variable name conflicts
 				// for function calls, we'll still use global table
 				bind(ctx, LOCAL, local_func_symbol, hash_key);
 			}
 			
-			if (node->params) {
-				resolve_params(ctx, node->params);
+			if (node_params(ctx, node)) {
+				resolve_params(ctx, node_params(ctx, node));
 			}
 
 			if (node->right) {
-				resolve_statement(ctx, node->right);
+				resolve_statement(ctx, node_right(ctx, node));
 			}
 
 			pop_scope(ctx);
@@ -758,37 +750,17 @@ bool function_symbol_bind(CompilerContext* ctx, Symbol* func_symbol, int hash_ke
 }
 
 bool variable_symbol_exists(CompilerContext* ctx, Symbol* symbol) {
-	SymbolTable* current_table = ctx->symbol_stack->tables[ctx->symbol_stack->top];
-	if (!current_table) return false;
-
-	// printf("In 'variable_symbol_exists'\n");
-	// printf("\033[32mGot table at level %d\033[0m\n", ctx->symbol_stack->top);
-
-	for (int i = 0; i < current_table->capacity; i++) {
-		Symbol* current_symbol = current_table->symbols[i];
-		while (current_symbol) {
-			Symbol* link_for_current_symbol = current_symbol->link;
-			if (symbol->name && strcmp(symbol->name, current_symbol->name) == 0) {
-				printf("\033[31mError\033[0m: cannot have two variables with identical names in same scope\n");
-				return true;
-			}
-			current_symbol = link_for_current_symbol;
-		}
+	if (lookup_symbol_in_current_scope(ctx, symbol->name)) {
+		printf("\033[31mError\033[0m: cannot have two variables with identical names in same scope\n");
+		return true;
 	}
 	return false;
 }
 
 bool function_symbol_exists(CompilerContext* ctx, Symbol* symbol) {
-	for (int i = 0; i < ctx->global_table->capacity; i++) {
-		Symbol* current_global_symbol = ctx->global_table->symbols[i];
-		while (current_global_symbol) {
-			Symbol* link_for_current_global_symbol = current_global_symbol->link;
-			if (symbol->name && strcmp(symbol->name, current_global_symbol->name) == 0) {
-				printf("\033[31mError\033[0m: cannot have two functions with the same name\n");
-				return true;
-			}
-			current_global_symbol = link_for_current_global_symbol;
-		}
+	if (lookup_symbol_in_table(ctx->global_table, symbol->name, hash_name(symbol->name))) {
+		printf("\033[31mError\033[0m: cannot have two functions with the same name\n");
+		return true;
 	}
 	return false;
 }
@@ -828,30 +800,20 @@ bool bind(CompilerContext* ctx, bind_t kind, Symbol* symbol, int hash_key) {
 	}
 }
 
-Symbol* lookup_function_symbol(CompilerContext* ctx, Symbol* symbol) {
-	if (!symbol || (symbol && !symbol->name)) {
+// 'name' must be interned
+Symbol* lookup_function_symbol(CompilerContext* ctx, char* name) {
+	if (!name) {
 		printf("\033[31mSymbol is NULL\033[0m\n");
 		return NULL;
 	}
 
-	for (int i = 0; i < ctx->global_table->capacity; i++) {
-		Symbol* current_func_symbol = ctx->global_table->symbols[i];
-		while (current_func_symbol) {
-			// printf("Index: %d -> processing function symbol with name: '%s'\n", i, current_func_symbol->name);
-			Symbol* link_for_current_func_symbol = current_func_symbol->link;
-			if (strcmp(symbol->name, current_func_symbol->name) == 0) {
-				return current_func_symbol;
-			}
-			current_func_symbol = link_for_current_func_symbol;
-		}
-	}
-	return NULL;
+	return lookup_symbol_in_table(ctx->global_table, name, hash_name(name));
 }
 
 void validate_node_signature(CompilerContext* ctx, Node* node) {
 	switch (node->type) {
 		case NODE_NAME: {
-			Type* type = node->t;
+			Type* type = node_datatype(ctx, node);
 			if (type) {
 				switch (type->kind) {
 					case TYPE_INTEGER: 
@@ -867,15 +829,15 @@ void validate_node_signature(CompilerContext* ctx, Node* node) {
 						Symbol* func_symbol = create_symbol(
 							ctx, 
 							SYMBOL_GLOBAL, 
-							node->value.name, 
-							node->params,
-							node->t
+							node_name(ctx, node), 
+							node_params(ctx, node),
+							node_datatype(ctx, node)
 						);
 
 						int hash_key = hash(ctx->global_table->capacity, func_symbol->name);
 						if (hash_key != -1) {
 							bind(ctx, FUNCTION, func_symbol, hash_key);
-							node->symbol = (void*)func_symbol;
+							set_node_symbol(ctx, node, (void*)func_symbol);
 						}						
 						break;
 					}
@@ -893,7 +855,7 @@ void validate_node_signature(CompilerContext* ctx, Node* node) {
 void collect_function_symbols(CompilerContext* ctx, Node* root) {
 	Node* current = root;
 	while (current) {
-		Node* next = current->next;
+		Node* next = node_next(ctx, current);
 		validate_node_signature(ctx, current);
 		current = next;
 	}
@@ -915,13 +877,14 @@ void resolve_tree(CompilerContext* ctx, Node* root) {
 	context_stack = create_context_stack(ctx);
 	assert(context_stack);
 
+
 	collect_function_symbols(ctx, root);
 
 	push_scope(ctx);
 	
 	Node* current = root;
 	while (current) {
-		Node* next = current->next;
+		Node* next = node_next(ctx, current);
 		resolve_globals(ctx, current);
 		current = next;
 	}
@@ -50,9 +50,11 @@ bool has_expression_context();
 int peek_scope_level(CompilerContext* ctx);
 bool distinct_from_keywords(CompilerContext* ctx, char* variable_name);
 
+unsigned int hash_name(char* name);
 int hash(int table_capacity, char* name);
-Symbol* lookup_symbol_in_all_scopes(CompilerContext* ctx, Symbol* symbol);
-Symbol* lookup_symbol_in_current_scope(CompilerContext* ctx, Symbol* symbol);
+Symbol* lookup_symbol_in_table(SymbolTable* table, char* name, unsigned int name_hash);
+Symbol* lookup_symbol_in_all_scopes(CompilerContext* ctx, char* name);
+Symbol* lookup_symbol_in_current_scope(CompilerContext* ctx, char* name);
 bool rehash_local_symbols(CompilerContext* ctx, Symbol** prev_symbols, int new_capacity, int prev_capacity);
 bool rehash_function_symbols(CompilerContext* ctx, Symbol** prev_symbols, int new_capacity, int prev_capacity);
 bool variable_symbol_exists(CompilerContext* ctx, Symbol* symbol);
@@ -61,7 +63,7 @@ bool symbol_exists(CompilerContext* ctx, bind_t kind, Symbol* symbol);
 bool variable_symbol_bind(CompilerContext* ctx, Symbol* symbol, int hash_key);
 bool function_symbol_bind(CompilerContext* ctx, Symbol* func_symbol, int hash_key);
 bool bind(CompilerContext* ctx, bind_t kind, Symbol* symbol, int hash_key);
-Symbol* lookup_function_symbol(CompilerContext* ctx, Symbol* symbol);
+Symbol* lookup_function_symbol(CompilerContext* ctx, char* name);
 void validate_node_signature(CompilerContext* ctx, Node* node);
 void collect_function_symbols(CompilerContext* ctx, Node* root);
 
@@ -101,8 +101,8 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 		case NODE_GREATER:
 		case NODE_LESS_EQUAL:
 		case NODE_GREATER_EQUAL: {
-			lt = typecheck_expression(ctx, node->left);
-			rt = typecheck_expression(ctx, node->right);
+			lt = typecheck_expression(ctx, node_left(ctx, node));
+			rt = typecheck_expression(ctx, node_right(ctx, node));
 
 			if (!lt || !rt) {
 				return type_create(ctx, TYPE_UNKNOWN, NULL);
@@ -134,8 +134,8 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 		case NODE_SUB:
 		case NODE_MUL:
 		case NODE_DIV: {
-			lt = typecheck_expression(ctx, node->left);
-			rt = typecheck_expression(ctx, node->right);
+			lt = typecheck_expression(ctx, node_left(ctx, node));
+			rt = typecheck_expression(ctx, node_right(ctx, node));
 
 			if (!lt || !rt) {
 				return type_create(ctx, TYPE_UNKNOWN, NULL);
@@ -153,8 +153,8 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 
 		case NODE_LOGICAL_OR:
 		case NODE_LOGICAL_AND: {
-			lt = typecheck_expression(ctx, node->left);
-			rt = typecheck_expression(ctx, node->right);
+			lt = typecheck_expression(ctx, node_left(ctx, node));
+			rt = typecheck_expression(ctx, node_right(ctx, node));
 
 			if (!lt || !rt) {
 				return type_create(ctx, TYPE_UNKNOWN, NULL);
@@ -172,7 +172,7 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 
 		case NODE_UNARY_ADD:
 		case NODE_UNARY_SUB: {
-			rt = typecheck_expression(ctx, node->right);
+			rt = typecheck_expression(ctx, node_right(ctx, node));
 			if (!rt) {
 				return type_create(ctx, TYPE_UNKNOWN, NULL);
 			}
@@ -186,7 +186,7 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_NOT: {
-			rt = typecheck_expression(ctx, node->right);
+			rt = typecheck_expression(ctx, node_right(ctx, node));
 			if (!rt) {
 				return type_create(ctx, TYPE_UNKNOWN, NULL);
 			}
@@ -202,7 +202,7 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 
 		case NODE_DECREMENT:
 		case NODE_INCREMENT: {
-			lt = typecheck_expression(ctx, node->left);
+			lt = typecheck_expression(ctx, node_left(ctx, node));
 			if (!lt) {
 				result = type_create(ctx, TYPE_UNKNOWN, NULL);
 			}
@@ -216,17 +216,17 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_CALL: {
-			Node* wrapped_arg = node->params;
+			Node* wrapped_arg = node_params(ctx, node);
 
-			Symbol* sym = node->left->symbol;
+			Symbol* sym = node_symbol(ctx, node_left(ctx, node));
 			Node* wrapped_param = sym->params;
 
 			while (wrapped_arg && wrapped_param) {
-				Node* next_arg = wrapped_arg->next;
-				Node* next_param = wrapped_param->next;
+				Node* next_arg = node_next(ctx, wrapped_arg);
+				Node* next_param = node_next(ctx, wrapped_param);
 
-				Type* arg_type = typecheck_expression(ctx, wrapped_arg->right);
-				Type* param_type = ((Symbol*)wrapped_param->right->symbol)->type;
+				Type* arg_type = typecheck_expression(ctx, node_right(ctx, wrapped_arg));
+				Type* param_type = ((Symbol*)node_symbol(ctx, node_right(ctx, wrapped_param)))->type;
 				if (!type_equals(arg_type, param_type)) {
 					return type_create(ctx, TYPE_UNKNOWN, NULL);
 				}
@@ -253,7 +253,7 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 		}
 
 		case NODE_NAME: {
-			void* sym = node->symbol;
+			void* sym = node_symbol(ctx, node);
 			if ((Symbol*)sym) {
 				Type* t = ((Symbol*)sym)->type;
 				if (t && (t->kind == TYPE_ARRAY || t->kind == TYPE_FUNCTION)) {
@@ -277,13 +277,13 @@ struct Type* typecheck_expression(CompilerContext* ctx, Node* node) {
 		case NODE_AUG:
 		case NODE_DEF:
 		case NODE_DECL: {
-			result = typecheck_expression(ctx, node->left);
+			result = typecheck_expression(ctx, node_left(ctx, node));
 			break;
 		}
 
 		case NODE_SUBSCRIPT: {
-			lt = typecheck_expression(ctx, node->left);
-			rt = typecheck_expression(ctx, node->right);
+			lt = typecheck_expression(ctx, node_left(ctx, node));
+			rt = typecheck_expression(ctx, node_right(ctx, node));
 			
 			if (!lt || !rt) {
 				return type_create(ctx, TYPE_UNKNOWN, NULL);
@@ -313,25 +313,25 @@ void typecheck_statement(CompilerContext* ctx, Node* node) {
 
 	switch (node->type) {
 		case NODE_ASSIGNMENT: {
-			if (node->right && node->right->type == NODE_ARRAY_LIST) {
-				lt = typecheck_expression(ctx, node->left);
+			if (node_right(ctx, node) && node_right(ctx, node)->type == NODE_ARRAY_LIST) {
+				lt = typecheck_expression(ctx, node_left(ctx, node));
 				if (!lt) return;
 
 				if (lt->subtype) {
-					Node* array_list = node->right;
-					Node* element = array_list->right;
+					Node* array_list = node_right(ctx, node);
+					Node* element = node_right(ctx, array_list);
 					while (element) {
-						struct Type* element_type = element->t;
+						struct Type* element_type = node_datatype(ctx, element);
 						if (!type_equals(lt->subtype, element_type)) {
 							printf("Array element and subtype not equal. Subtype kind is %d\n", lt->subtype->kind);
 							return;
 						}
-						element = element->next;
+						element = node_next(ctx, element);
 					}
 				}
 			} else {
-				lt = typecheck_expression(ctx, node->left);
-				rt = typecheck_expression(ctx, node->right);
+				lt = typecheck_expression(ctx, node_left(ctx, node));
+				rt = typecheck_expression(ctx, node_right(ctx, node));
 				if (!lt || !rt) {
 					return type_create(ctx, TYPE_UNKNOWN, NULL);
 				}
@@ -345,7 +345,7 @@ void typecheck_statement(CompilerContext* ctx, Node* node) {
 
 		case NODE_ELSE: {
 			if (node->right) {
-				typecheck_statement(ctx, node->right);
+				typecheck_statement(ctx, node_right(ctx, node));
 			}
 			break;
 		} 
@@ -360,7 +360,7 @@ void typecheck_statement(CompilerContext* ctx, Node* node) {
 					func_return_type = func_symbol->type->subtype;
 				}
 
-				rt = typecheck_expression(ctx, node->right);
+				rt = typecheck_expression(ctx, node_right(ctx, node));
 				if (!type_equals(rt, func_return_type)) {
 					result = type_create(ctx, TYPE_UNKNOWN, NULL);
 					assert(false);
@@ -378,9 +378,9 @@ void typecheck_statement(CompilerContext* ctx, Node* node) {
 
 		case NODE_BLOCK: {
 			if (node->right) {
-				Node* stmt = node->right;
+				Node* stmt = node_right(ctx, node);
 				while (stmt) {
-					Node* stmt_next = stmt->next;
+					Node* stmt_next = node_next(ctx, stmt);
 					typecheck_statement(ctx, stmt);
 					stmt = stmt_next;
 				}
@@ -391,7 +391,7 @@ void typecheck_statement(CompilerContext* ctx, Node* node) {
 		case NODE_INCREMENT:
 		case NODE_DECREMENT: {
 			if (node->left) {
-				typecheck_expression(ctx, node->left);
+				typecheck_expression(ctx, node_left(ctx, node));
 			}
 			break;
 		}
@@ -400,47 +400,47 @@ void typecheck_statement(CompilerContext* ctx, Node* node) {
 		case NODE_ELSE_IF:
 		case NODE_WHILE: {
 			if (node->left) {
-				result = typecheck_expression(ctx, node->left);
+				result = typecheck_expression(ctx, node_left(ctx, node));
 				if (!result || (result && result->kind != TYPE_BOOL)) return;
 			}
 
 			if (node->right) {
-				typecheck_statement(ctx, node->right);
+				typecheck_statement(ctx, node_right(ctx, node));
 			}
 			break;
 		} 
 	
 		case NODE_FOR: {
-			Node* initializer = node->left;
+			Node* initializer = node_left(ctx, node);
 
 			if (initializer) {
 				typecheck_statement(ctx, initializer);
 			}
 
-			Node* condition = initializer ? initializer->next : NULL;
+			Node* condition = initializer ? node_next(ctx, initializer) : NULL;
 			if (condition) {
 				typecheck_expression(ctx, condition);
 			}
 
-			Node* update = condition ? condition->next : NULL;
+			Node* update = condition ? node_next(ctx, condition) : NULL;
 			if (update) {
 				typecheck_expression(ctx, update);
 			}
 
 			if (node->right) {
-				typecheck_statement(ctx, node->right);
+				typecheck_statement(ctx, node_right(ctx, node));
 			}
 			break;
 		}
 	}
 }
 
-void typecheck_params(Node* params) {
+void typecheck_params(CompilerContext* ctx, Node* params) {
 	if (!params) return;
 
-	Node* actual_param = params->right;
+	Node* actual_param = node_right(ctx, params);
 	if (!actual_param) { return; }
-	if (!type_equals(actual_param->t, ((Symbol*)actual_param->symbol)->type)) { 
+	if (!type_equals(node_datatype(ctx, actual_param), ((Symbol*)node_symbol(ctx, actual_param))->type)) { 
 		return; 
 	}
 }
@@ -451,31 +451,31 @@ void typecheck_globals(CompilerContext* ctx, Node* node) {
 	switch (node->type) {
 		case NODE_ASSIGNMENT: {
 			if (node->left) {
-				typecheck_expression(ctx, node->left);
+				typecheck_expression(ctx, node_left(ctx, node));
 			}
 
 			if (node->right) {
-				typecheck_expression(ctx, node->right);
+				typecheck_expression(ctx, node_right(ctx, node));
 			}
 			break;
 		}
 
 		case NODE_NAME: {
-			if ((Type*)node->t) {
-				if (((Type*)node->t)->kind == TYPE_FUNCTION) {
-					add_func_symbol(ctx, (Symbol*)node->symbol);
+			if ((Type*)node_datatype(ctx, node)) {
+				if (((Type*)node_datatype(ctx, node))->kind == TYPE_FUNCTION) {
+					add_func_symbol(ctx, (Symbol*)node_symbol(ctx, node));
 					// printf("\033[32mAbout to typecheck function '%s'\033[0m\n", node->value.name);
-					if (node->params) {
-						Node* wrapped_param = node->params;
+					if (node_params(ctx, node)) {
+						Node* wrapped_param = node_params(ctx, node);
 						while (wrapped_param) {
-							Node* next_wrapped_param = wrapped_param->next;
-							typecheck_params(wrapped_param);
+							Node* next_wrapped_param = node_next(ctx, wrapped_param);
+							typecheck_params(ctx, wrapped_param);
 							wrapped_param = next_wrapped_param;
 						}
 					}
 
 					if (node->right) {
-						typecheck_statement(ctx, node->right);
+						typecheck_statement(ctx, node_right(ctx, node));
 					}
 					// printf("\033[32mFinished typechecking function'%s'\033[0m\n", node->value.name);
 					pop_func_symbol();
@@ -494,7 +494,7 @@ void typecheck_tree(CompilerContext* ctx, Node* root) {
 
 	Node* node = root;
 	while (node) {
-		Node* next = node->next;
+		Node* next = node_next(ctx, node);
 		typecheck_globals(ctx, node);
 		node = next;
 	}
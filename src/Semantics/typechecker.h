@@ -25,7 +25,7 @@ bool add_func_symbol(CompilerContext* ctx, Symbol* symbol);
 bool init_typechecker_symbol_stack(CompilerContext* ctx);
 TypeCheckerSymbolStack create_typechecker_symbol_stack(CompilerContext* ctx);
 
-void typecheck_params(Node* params);
+void typecheck_params(CompilerContext* ctx, Node* params);
 struct Type* typecheck_expression(CompilerContext* ctx, Node* expr);
 void typecheck_statement(CompilerContext* ctx, Node* stmt);
 void typecheck_globals(CompilerContext* ctx, Node* globals);
@@ -0,0 +1,258 @@
+#include "backend.h"
+#include "IR/tac.h"
+#include "IR/cfg.h"
+#include "IR/constfold.h"
+#include "RegAlloc/regalloc.h"
+#include "interner.h"
+#include "assert.h"
+#include <unistd.h>
+
+FunctionContext* create_function_context(CompilerContext* ctx, Node* node) {
+	FunctionContext* function = arena_allocate(ctx->ir_arena, sizeof(FunctionContext));
+	if (!function) {
+		perror("In 'create_function_context', unable to allocate space for function context\n");
+		return NULL;
+	}
+
+	function->node = node;
+	function->jmp_true_index = 1;
+	function->jmp_false_index = 1;
+	function->jmp_end_index = 1;
+	function->report = stdout;
+	return function;
+}
+
+// one context per function definition, in the order build_tacs would have
+// lowered them, which is also the order their code is laid out in
+FunctionContext** collect_function_contexts(CompilerContext* ctx, Node* root, int* num_functions) {
+	int size = 0;
+	int capacity = INIT_FUNCTION_CONTEXTS_CAPACITY;
+	FunctionContext** functions = arena_allocate(ctx->ir_arena, sizeof(FunctionContext*) * capacity);
+	if (!functions) return NULL;
+
+	for (Node* current = root; current; current = node_next(ctx, current)) {
+		if (current->type != NODE_NAME) continue;
+
+		Symbol* sym = node_symbol(ctx, current);
+		if (!sym || !sym->type || sym->type->kind != TYPE_FUNCTION) continue;
+
+		if (size >= capacity) {
+			int prev_capacity = capacity;
+			capacity *= 2;
+
+			FunctionContext** new_functions = arena_reallocate(
+				ctx->ir_arena,
+				functions,
+				prev_capacity * sizeof(FunctionContext*),
+				capacity * sizeof(FunctionContext*)
+			);
+			if (!new_functions) return NULL;
+			functions = new_functions;
+		}
+
+		functions[size] = create_function_context(ctx, current);
+		if (!functions[size]) return NULL;
+		size++;
+	}
+
+	*num_functions = size;
+	return functions;
+}
+
+int count_jobs(CompilerContext* ctx, int num_functions) {
+	int jobs = ctx->jobs;
+	if (jobs <= 0) {
+		jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	if (jobs > num_functions) jobs = num_functions;
+	if (jobs < 1) jobs = 1;
+	return jobs;
+}
+
+// a worker shares everything in ctx except the arenas the backend allocates from
+bool init_worker(CompilerContext* ctx, Worker* worker, FunctionQueue* queue) {
+	worker->ctx = *ctx;
+	worker->ctx.function = NULL;
+	worker->queue = queue;
+
+	worker->ctx.ir_arena = create_arena(IR_ARENA);
+	if (!worker->ctx.ir_arena) {
+		printf("could not create worker ir arena\n");
+		return false;
+	}
+
+	worker->ctx.codegen_arena = create_arena(CODEGEN_ARENA);
+	if (!worker->ctx.codegen_arena) {
+		printf("could not create worker codegen arena\n");
+		free_arena(worker->ctx.ir_arena);
+		return false;
+	}
+	return true;
+}
+
+void free_worker(Worker* worker) {
+	free_arena(worker->ctx.ir_arena);
+	free_arena(worker->ctx.codegen_arena);
+}
+
+// a spill is an operand the allocator left in the frame
+void count_function(FunctionContext* function, FunctionInfo* info) {
+	CFG* cfg = info->cfg;
+	function->basic_blocks += cfg->num_blocks;
+	function->removed_instructions += cfg->dead_instructions;
+	if (info->graph) {
+		function->interference_edges += info->graph->num_edges;
+	}
+
+	for (int i = 0; i < cfg->numbering->count; i++) {
+		if (cfg->numbering->operands[i]->permanent_frame_position) {
+			function->spills++;
+		}
+	}
+}
+
+void compile_function(CompilerContext* ctx, FunctionContext* function) {
+	ctx->function = function;
+	if (ctx->verbose || ctx->dump_cfg) {
+		function->report = open_memstream(&function->report_text, &function->report_length);
+		assert(function->report);
+	}
+
+	double started = report_clock();
+	TACTable* tac_table = build_function_tacs(ctx);
+	assert(tac_table);
+	double finished = report_clock();
+	function->phase_ms[REPORT_TAC] = finished - started;
+
+	started = finished;
+	if (!ctx->no_fold) {
+		function->removed_instructions = fold_constants(ctx, tac_table);
+	}
+	finished = report_clock();
+	function->phase_ms[REPORT_FOLD] = finished - started;
+
+	started = finished;
+	FunctionList* function_list = build_cfg(ctx, tac_table);
+	finished = report_clock();
+	function->phase_ms[REPORT_CFG] = finished - started;
+
+	started = finished;
+	reg_alloc(ctx, function_list);
+	finished = report_clock();
+	function->phase_ms[REPORT_REGALLOC] = finished - started;
+
+	started = finished;
+	function->writer = emit_function_asm(ctx, function_list);
+	function->phase_ms[REPORT_CODEGEN] = report_clock() - started;
+
+	for (int i = 0; i < function_list->size; i++) {
+		count_function(function, function_list->infos[i]);
+	}
+
+	if (ctx->verbose || ctx->dump_cfg) {
+		fclose(function->report);
+	}
+}
+
+void add_function_report(TimeReport* report, FunctionContext* function) {
+	for (int i = REPORT_TAC; i < NUM_REPORT_PHASES; i++) {
+		report->phase_ms[i] += function->phase_ms[i];
+	}
+
+	report->functions++;
+	report->tac_instructions += function->tac_table->size;
+	report->removed_instructions += function->removed_instructions;
+	report->basic_blocks += function->basic_blocks;
+	report->interference_edges += function->interference_edges;
+	report->spills += function->spills;
+}
+
+void* run_worker(void* arg) {
+	Worker* worker = arg;
+	FunctionQueue* queue = worker->queue;
+
+	while (true) {
+		pthread_mutex_lock(&queue->lock);
+		int next = queue->next_function++;
+		pthread_mutex_unlock(&queue->lock);
+
+		if (next >= queue->num_functions) break;
+		compile_function(&worker->ctx, queue->functions[next]);
+	}
+	return NULL;
+}
+
+// lowers, allocates and encodes every function on its own worker, then lays
+// the results out in program order, so the output does not depend on --jobs
+void compile_functions(CompilerContext* ctx, Node* root, char* file) {
+	ASMWriter* writer = create_asm_writer(ctx, file);
+	assert(writer);
+
+	ensure_main_function_exists(ctx);
+	generate_globals(ctx, writer);
+
+	FunctionQueue queue;
+	queue.next_function = 0;
+	queue.functions = collect_function_contexts(ctx, root, &queue.num_functions);
+	assert(queue.functions);
+	pthread_mutex_init(&queue.lock, NULL);
+
+	int jobs = count_jobs(ctx, queue.num_functions);
+	Worker* workers = calloc(jobs, sizeof(Worker));
+	assert(workers);
+
+	for (int i = 0; i < jobs; i++) {
+		bool initialized = init_worker(ctx, &workers[i], &queue);
+		assert(initialized);
+	}
+
+	// the calling thread is the first worker, so --jobs 1 starts no threads
+	ctx->interner->shared = jobs > 1;
+	for (int i = 1; i < jobs; i++) {
+		int error = pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]);
+		assert(error == 0);
+	}
+
+	run_worker(&workers[0]);
+	for (int i = 1; i < jobs; i++) {
+		pthread_join(workers[i].thread, NULL);
+	}
+	ctx->interner->shared = false;
+
+	for (int i = 0; i < queue.num_functions; i++) {
+		FunctionContext* function = queue.functions[i];
+		append_asm_writer(writer, function->writer);
+
+		if (function->report_text) {
+			fwrite(function->report_text, 1, function->report_length, stdout);
+			free(function->report_text);
+		}
+
+		if (ctx->time_report) {
+			add_function_report(ctx->time_report, function);
+		}
+	}
+
+	bool resolved = resolve_code_labels(writer->code);
+	assert(resolved);
+
+	if (writer->listing) {
+		flush_asm_writer(writer);
+	}
+	generate_executable(ctx, writer, file);
+
+	if (ctx->time_report) {
+		ctx->time_report->jobs = jobs;
+	}
+
+	for (int i = 0; i < jobs; i++) {
+		if (ctx->time_report) {
+			add_arena_stats(ctx->time_report, workers[i].ctx.ir_arena);
+			add_arena_stats(ctx->time_report, workers[i].ctx.codegen_arena);
+		}
+		free_worker(&workers[i]);
+	}
+	free(workers);
+	pthread_mutex_destroy(&queue.lock);
+}
@@ -0,0 +1,76 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "compilercontext.h"
+#include "Parser/node.h"
+#include "Codegen/codegen.h"
+#include "timereport.h"
+
+#define INIT_FUNCTION_CONTEXTS_CAPACITY 40
+
+// everything the passes from build_tacs to generate_function_body keep
+// between calls; once typechecking is done a function needs nothing from
+// the others, so each one gets its own and they can be lowered at once
+typedef struct FunctionContext {
+	Node* node;
+	char* name; // namespaces the function's labels
+
+	int label_counter;
+	int tac_variable_index;
+	int tac_parameter_index;
+	int tac_function_argument_index;
+	int tac_instruction_index;
+	TACTable* tac_table;
+	TACContextStack tac_context_stack;
+
+	FunctionList* function_list;
+	TACLeaders leaders_list;
+	int block_id;
+
+	int jmp_true_index;
+	int jmp_false_index;
+	int jmp_end_index;
+	ASMWriter* writer;
+
+	// --verbose lines, printed in function order once every function is done
+	FILE* report;
+	char* report_text;
+	size_t report_length;
+
+	// for --time-report, summed over functions once they are all done
+	double phase_ms[NUM_REPORT_PHASES];
+	long removed_instructions;
+	long basic_blocks;
+	long interference_edges;
+	long spills;
+} FunctionContext;
+
+// workers take the next function off the list until none are left; each
+// allocates from its own arenas, since arena_allocate is not thread safe
+typedef struct {
+	FunctionContext** functions;
+	int num_functions;
+	int next_function;
+	pthread_mutex_t lock;
+} FunctionQueue;
+
+typedef struct {
+	CompilerContext ctx;
+	FunctionQueue* queue;
+	pthread_t thread;
+} Worker;
+
+FunctionContext* create_function_context(CompilerContext* ctx, Node* node);
+FunctionContext** collect_function_contexts(CompilerContext* ctx, Node* root, int* num_functions);
+int count_jobs(CompilerContext* ctx, int num_functions);
+bool init_worker(CompilerContext* ctx, Worker* worker, FunctionQueue* queue);
+void free_worker(Worker* worker);
+void count_function(FunctionContext* function, FunctionInfo* info);
+void compile_function(CompilerContext* ctx, FunctionContext* function);
+void add_function_report(TimeReport* report, FunctionContext* function);
+void* run_worker(void* arg);
+void compile_functions(CompilerContext* ctx, Node* root, char* file);
+
+#endif
@@ -84,6 +84,18 @@ void* arena_reallocate(Arena* A, void* prev_ptr, size_t bytes_to_copy, size_t re
 	return new_ptr;
 }
 
+ArenaStats arena_stats(Arena* A) {
+	ArenaStats stats = {0};
+	if (!A) return stats;
+
+	for (MemoryBlock* block = A->head; block; block = block->next) {
+		stats.used += block->offset;
+		stats.reserved += block->capacity;
+		stats.blocks++;
+	}
+	return stats;
+}
+
 void free_arena(Arena* A) {
 	if (!A) return;
 	MemoryBlock* block = A->head;
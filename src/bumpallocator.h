@@ -16,7 +16,8 @@ typedef enum {
 	SYMBOL_ARENA,
 	IR_ARENA,
 	CODEGEN_ARENA,
-	ERROR_ARENA
+	ERROR_ARENA,
+	STRING_ARENA
 } arena_t;
 
 typedef struct MemoryBlock {
@@ -32,9 +33,17 @@ typedef struct Arena {
 	MemoryBlock* current_block;
 } Arena;
 
+// bytes handed out (alignment padding included) against bytes malloc'd
+typedef struct {
+	size_t used;
+	size_t reserved;
+	int blocks;
+} ArenaStats;
+
 void* arena_reallocate(Arena* A, void* prev_ptr, size_t prev_size, size_t req_size);
 void* arena_allocate(Arena* A, size_t req_size);
 MemoryBlock* create_memory_block(size_t req_size);
 Arena* create_arena(arena_t type);
+ArenaStats arena_stats(Arena* A);
 void free_arena(Arena* A);
 #endif
\ No newline at end of file
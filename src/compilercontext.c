@@ -1,6 +1,7 @@
 #include "compilercontext.h"
 #include "symbols.h"
 #include "errors.h"
+#include "interner.h"
 
 char* keywords[KEYWORDS] = {"function", "let", "int", "char", "bool",
 							"void", "struct", "enum", "if",
@@ -17,6 +18,20 @@ CompilerContext* create_compiler_context() {
 	}
 
 	ctx->keywords = keywords;
+	ctx->verbose = false;
+	ctx->linear_scan = false;
+	ctx->asm_listing = false;
+	ctx->stream_tokens = false;
+	ctx->no_fold = false;
+	ctx->no_dce = false;
+	ctx->no_ssa = false;
+	ctx->no_licm = false;
+	ctx->dump_cfg = false;
+	ctx->info = NULL;
+	ctx->function = NULL;
+	ctx->node_pool = NULL;
+	ctx->jobs = 0;
+	ctx->time_report = NULL;
 
 	ctx->lexer_arena = create_arena(LEXER_ARENA);
 	if (!ctx->lexer_arena) {
@@ -129,11 +144,41 @@ CompilerContext* create_compiler_context() {
 		printf("codegen arena failed\n");
 		return NULL;
 	}
+
+	ctx->string_arena = create_arena(STRING_ARENA);
+	if (!ctx->string_arena) {
+		free_arena(ctx->codegen_arena);
+		free_arena(ctx->error_arena);
+		free_arena(ctx->ir_arena);
+		free_arena(ctx->symbol_arena);
+		free_arena(ctx->type_arena);
+		free_arena(ctx->ast_arena);
+		free_arena(ctx->lexer_arena);
+		free(ctx);
+		printf("string arena failed\n");
+		return NULL;
+	}
+
+	ctx->interner = create_interner(ctx);
+	if (!ctx->interner) {
+		free_arena(ctx->string_arena);
+		free_arena(ctx->codegen_arena);
+		free_arena(ctx->error_arena);
+		free_arena(ctx->ir_arena);
+		free_arena(ctx->symbol_arena);
+		free_arena(ctx->type_arena);
+		free_arena(ctx->ast_arena);
+		free_arena(ctx->lexer_arena);
+		free(ctx);
+		printf("interner failed\n");
+		return NULL;
+	}
 	return ctx;
 }
 
 void free_compiler_context(CompilerContext* ctx) {
 	if (ctx) {
+		release_file_contents(ctx->info);
 		free_arena(ctx->lexer_arena);
 		free_arena(ctx->ast_arena);
 		free_arena(ctx->type_arena);
@@ -141,6 +186,8 @@ void free_compiler_context(CompilerContext* ctx) {
 		free_arena(ctx->ir_arena);
 		free_arena(ctx->error_arena);
 		free_arena(ctx->codegen_arena);
+		free_arena(ctx->string_arena);
+		free(ctx->time_report);
 		free(ctx);		
 	}
 }
\ No newline at end of file
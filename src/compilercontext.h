@@ -1,12 +1,17 @@
 #ifndef COMPILER_CONTEXT_H
 #define COMPILER_CONTEXT_H
 
+#include <stdbool.h>
 #include "bumpallocator.h"
 #include "phases.h"
 typedef struct SymbolTable SymbolTable;
 typedef struct SymbolStack SymbolStack;
 typedef struct ErrorTable ErrorTable;
 typedef struct FileInfo FileInfo;
+typedef struct Interner Interner;
+typedef struct FunctionContext FunctionContext;
+typedef struct TimeReport TimeReport;
+typedef struct NodePool NodePool;
 
 #define KEYWORDS 20
 #define NUM_PHASES 7
@@ -19,15 +24,32 @@ typedef struct CompilerContext {
 	Arena* ir_arena;
 	Arena* codegen_arena;
 	Arena* error_arena;
+	Arena* string_arena;
 
 	SymbolTable* global_table; // for having access to function symbols, say with CALL Nodes
 	SymbolStack* symbol_stack; // for scopes
 
 	char** keywords;
+	Interner* interner; // shared by tokens, symbols and IR labels
+	NodePool* node_pool; // the nodes and bindings of the tree being parsed
 
 	phase_t phase;
 	ErrorTable* error_tables;
 	FileInfo* info;
+
+	FunctionContext* function; // the function the backend is working on
+	int jobs; // --jobs N: functions compiled at once, 0 for one per cpu
+
+	bool verbose; // --verbose: per-function pass statistics
+	bool linear_scan; // --linear-scan: allocate registers without an interference graph
+	bool asm_listing; // --emit-asm: also write the .asm the executable was encoded from
+	bool stream_tokens; // --stream-tokens: lex on demand while parsing
+	bool no_fold; // --no-fold: skip constant propagation between tac and cfg
+	bool no_dce; // --no-dce: keep unreachable blocks and dead instructions
+	bool no_ssa; // --no-ssa: leave the cfg out of ssa form before liveness
+	bool no_licm; // --no-licm: keep loop invariant instructions inside their loops
+	bool dump_cfg; // --dump-cfg: print each function's blocks, dominators and loops
+	TimeReport* time_report; // --time-report[=json]: phase times, arena usage and counts
 } CompilerContext;
 
 CompilerContext* create_compiler_context();
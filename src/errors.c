@@ -86,7 +86,7 @@ void display_parser_error(CompilerContext* ctx, Error* e) {
 		default: break;
 	}
 
-	int gutter_width = snprintf(NULL, 0, "%d", e->unit.token.line);
+	int gutter_width = snprintf(NULL, 0, "%d", e->line);
 	char space[gutter_width + 1];
 	for (int i = 0; i < gutter_width; i++) {
 		space[i] = ' ';
@@ -101,7 +101,9 @@ void display_parser_error(CompilerContext* ctx, Error* e) {
 			
 			printf("%s%s|\n", space, space);
 
-			printf("%d%s| %s\n", e->line, space, e->info->lines[e->line - 1]);
+			int line_length = 0;
+			char* line = get_source_line(e->info, e->line, &line_length);
+			printf("%d%s| %.*s\n", e->line, space, line_length, line);
 			printf("%s%s|", space, space);
 			char buffer[2 * gutter_width + 1];
 			snprintf(buffer, sizeof(buffer), "%s%s|", space, space);
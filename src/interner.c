@@ -0,0 +1,115 @@
+#include "interner.h"
+#include "compilercontext.h"
+#include <stdio.h>
+
+unsigned int hash_string(char* str, int length) {
+	unsigned int hash = 0;
+	for (int i = 0; i < length; i++) {
+		hash = (hash << 1) + (unsigned char)str[i];
+	}
+	return hash;
+}
+
+Interner* create_interner(CompilerContext* ctx) {
+	Interner* interner = arena_allocate(ctx->string_arena, sizeof(Interner));
+	if (!interner) {
+		perror("In 'create_interner', unable to allocate space for interner\n");
+		return NULL;
+	}
+
+	interner->size = 0;
+	interner->capacity = INIT_INTERNER_CAPACITY;
+	interner->buckets = arena_allocate(ctx->string_arena, sizeof(InternedString*) * interner->capacity);
+	interner->entries = arena_allocate(ctx->string_arena, sizeof(InternedString*) * interner->capacity);
+	if (!interner->buckets || !interner->entries) {
+		perror("In 'create_interner', unable to allocate space for interner buckets\n");
+		return NULL;
+	}
+
+	interner->shared = false;
+	pthread_mutex_init(&interner->lock, NULL);
+	return interner;
+}
+
+bool grow_interner(CompilerContext* ctx, Interner* interner) {
+	int prev_capacity = interner->capacity;
+	int new_capacity = prev_capacity * 2;
+
+	InternedString** new_buckets = arena_allocate(ctx->string_arena, sizeof(InternedString*) * new_capacity);
+	InternedString** new_entries = arena_reallocate(
+		ctx->string_arena,
+		interner->entries,
+		prev_capacity * sizeof(InternedString*),
+		new_capacity * sizeof(InternedString*)
+	);
+	if (!new_buckets || !new_entries) return false;
+
+	for (int i = 0; i < interner->size; i++) {
+		InternedString* entry = new_entries[i];
+		unsigned int index = entry->hash % new_capacity;
+		entry->link = new_buckets[index];
+		new_buckets[index] = entry;
+	}
+
+	interner->buckets = new_buckets;
+	interner->entries = new_entries;
+	interner->capacity = new_capacity;
+	return true;
+}
+
+InternedString* insert_string(CompilerContext* ctx, Interner* interner, char* str, int length) {
+	unsigned int hash = hash_string(str, length);
+
+	InternedString* current = interner->buckets[hash % interner->capacity];
+	while (current) {
+		if (current->hash == hash && current->length == length && memcmp(current->str, str, length) == 0) {
+			return current;
+		}
+		current = current->link;
+	}
+
+	if (interner->size >= interner->capacity) {
+		if (!grow_interner(ctx, interner)) return NULL;
+	}
+
+	InternedString* entry = arena_allocate(ctx->string_arena, sizeof(InternedString));
+	if (!entry) return NULL;
+
+	entry->str = arena_allocate(ctx->string_arena, length + 1);
+	if (!entry->str) return NULL;
+	memcpy(entry->str, str, length);
+	entry->str[length] = '\0';
+
+	entry->id = interner->size;
+	entry->length = length;
+	entry->hash = hash;
+
+	unsigned int index = hash % interner->capacity;
+	entry->link = interner->buckets[index];
+	interner->buckets[index] = entry;
+	interner->entries[interner->size++] = entry;
+	return entry;
+}
+
+InternedString* intern_string(CompilerContext* ctx, char* str, int length) {
+	if (!str) return NULL;
+
+	Interner* interner = ctx->interner;
+	if (!interner->shared) return insert_string(ctx, interner, str, length);
+
+	pthread_mutex_lock(&interner->lock);
+	InternedString* entry = insert_string(ctx, interner, str, length);
+	pthread_mutex_unlock(&interner->lock);
+	return entry;
+}
+
+char* intern_n(CompilerContext* ctx, char* str, int length) {
+	InternedString* entry = intern_string(ctx, str, length);
+	return entry ? entry->str : NULL;
+}
+
+char* intern(CompilerContext* ctx, char* str) {
+	if (!str) return NULL;
+	return intern_n(ctx, str, strlen(str));
+}
+
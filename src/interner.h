@@ -0,0 +1,41 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "bumpallocator.h"
+
+typedef struct CompilerContext CompilerContext;
+
+#define INIT_INTERNER_CAPACITY 1024
+
+typedef struct InternedString {
+	int id;
+	int length;
+	unsigned int hash;
+	char* str;
+	struct InternedString* link;
+} InternedString;
+
+// every identifier, symbol name and IR label goes through here once, so two
+// names are the same name exactly when their pointers (or ids) are equal
+typedef struct Interner {
+	int size;
+	int capacity;
+	InternedString** buckets;
+	InternedString** entries; // indexed by id
+
+	// set while compile_functions has workers running, which intern labels
+	bool shared;
+	pthread_mutex_t lock;
+} Interner;
+
+unsigned int hash_string(char* str, int length);
+Interner* create_interner(CompilerContext* ctx);
+bool grow_interner(CompilerContext* ctx, Interner* interner);
+InternedString* insert_string(CompilerContext* ctx, Interner* interner, char* str, int length);
+InternedString* intern_string(CompilerContext* ctx, char* str, int length);
+char* intern(CompilerContext* ctx, char* str);
+char* intern_n(CompilerContext* ctx, char* str, int length);
+
+#endif
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "compilercontext.h" 
 #include "Lexer/lexer.h"
 #include "Parser/parser.h"
@@ -9,30 +10,72 @@
 #include "IR/cfg.h"
 #include "RegAlloc/regalloc.h"
 #include "Codegen/codegen.h"
+#include "backend.h"
+#include "timereport.h"
 #include "errors.h"
 
 int main(int argc, char** argv) {
-	if (argc != 2) {
-		printf("Expected only two arguments\n");
-		return 1;
-	}
-
 	CompilerContext* ctx = create_compiler_context();
 	if (!ctx) {
 		printf("compiler context is NULL\n");
 		return 1;
 	} 
 
-	char* file = argv[1];
-	Lexer* lexer = lex(ctx, file);
+	char* file = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--verbose") == 0) {
+			ctx->verbose = true;
+		} else if (strcmp(argv[i], "--linear-scan") == 0) {
+			ctx->linear_scan = true;
+		} else if (strcmp(argv[i], "--emit-asm") == 0) {
+			ctx->asm_listing = true;
+		} else if (strcmp(argv[i], "--stream-tokens") == 0) {
+			ctx->stream_tokens = true;
+		} else if (strcmp(argv[i], "--no-fold") == 0) {
+			ctx->no_fold = true;
+		} else if (strcmp(argv[i], "--no-dce") == 0) {
+			ctx->no_dce = true;
+		} else if (strcmp(argv[i], "--no-ssa") == 0) {
+			ctx->no_ssa = true;
+		} else if (strcmp(argv[i], "--no-licm") == 0) {
+			ctx->no_licm = true;
+		} else if (strcmp(argv[i], "--dump-cfg") == 0) {
+			ctx->dump_cfg = true;
+		} else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+			ctx->jobs = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--time-report") == 0 || strcmp(argv[i], "--time-report=json") == 0) {
+			free(ctx->time_report);
+			ctx->time_report = create_time_report(strcmp(argv[i], "--time-report=json") == 0);
+		} else if (argv[i][0] == '-' || file) {
+			printf("Usage: zxal [--verbose] [--linear-scan] [--emit-asm] [--stream-tokens] [--no-fold] [--no-dce] [--no-ssa] [--no-licm] [--dump-cfg] [--jobs N] [--time-report[=json]] <file>\n");
+			free_compiler_context(ctx);
+			return 1;
+		} else {
+			file = argv[i];
+		}
+	}
+
+	if (!file) {
+		printf("Usage: zxal [--verbose] [--linear-scan] [--emit-asm] [--stream-tokens] [--no-fold] [--no-dce] [--no-ssa] [--no-licm] [--dump-cfg] [--jobs N] [--time-report[=json]] <file>\n");
+		free_compiler_context(ctx);
+		return 1;
+	}
+
+	double started = report_clock();
+	double phase_started = started;
+
+	Lexer* lexer = ctx->stream_tokens ? stream_tokens(ctx, file) : lex(ctx, file);
 	if (phase_accumulated_errors(ctx)) {
 		emit_errors(ctx);
 		free_compiler_context(ctx);
 		return 1;
 	}
-	// print_tokens(lexer->tokens);
+	// print_tokens(lexer, ctx->interner);
 
+	// with --stream-tokens lexing happens inside parse and is charged to it
+	phase_started = time_phase(ctx, REPORT_LEX, phase_started);
 	Node* ast_root = parse(ctx, lexer);
+	phase_started = time_phase(ctx, REPORT_PARSE, phase_started);
 	if (phase_accumulated_errors(ctx)) {
 		emit_errors(ctx);
 		free_compiler_context(ctx);
@@ -40,6 +83,7 @@ int main(int argc, char** argv) {
 	}
 	
 	resolve_tree(ctx, ast_root);
+	phase_started = time_phase(ctx, REPORT_RESOLVE, phase_started);
 	if (phase_accumulated_errors(ctx)) {
 		emit_errors(ctx);
 		free_compiler_context(ctx);
@@ -47,17 +91,26 @@ int main(int argc, char** argv) {
 	}
 
 	typecheck_tree(ctx, ast_root);
+	phase_started = time_phase(ctx, REPORT_TYPECHECK, phase_started);
 	if (phase_accumulated_errors(ctx)) {
 		emit_errors(ctx);
 		free_compiler_context(ctx);
 		return 1;
 	}
 
-	TACTable* tac_table = build_tacs(ctx, ast_root);
-	FunctionList* function_list = build_cfg(ctx, tac_table);
-	reg_alloc(ctx, function_list);
-	codegen(ctx, function_list, file);
-	
+	compile_functions(ctx, ast_root, file);
+
+	if (ctx->time_report) {
+		TimeReport* report = ctx->time_report;
+		double finished = report_clock();
+		report->backend_ms = finished - phase_started;
+		report->total_ms = finished - started;
+		report->tokens = lexer->size;
+		report->nodes = ctx->node_pool->num_nodes;
+		collect_arena_stats(ctx, report);
+		print_time_report(report);
+	}
+
 	free_compiler_context(ctx);
 	return 0;
 }
\ No newline at end of file
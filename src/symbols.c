@@ -4,6 +4,7 @@
 #include "Parser/node.h"
 #include "types.h"
 
+// 'name' is stored as given; it comes from the context's interner
 Symbol* create_symbol(CompilerContext* ctx, symbol_t kind,
 	char* name, Node* params, struct Type* t) {
 	Symbol* sym = arena_allocate(ctx->symbol_arena, sizeof(Symbol));
@@ -11,21 +12,13 @@ Symbol* create_symbol(CompilerContext* ctx, symbol_t kind,
 
 	sym->kind = kind;
 	sym->scope_level = ctx->symbol_stack->top;
-	sym->name = NULL;
+	sym->name = name;
 	sym->type = t;
 	sym->params = params;
 	sym->link = NULL;
 	sym->next = NULL;
 	sym->frame_byte_offset = -1;
 
-	if (name) {
-		int length = strlen(name);
-		sym->name = arena_allocate(ctx->symbol_arena, length + 1);
-		if (!sym->name) return NULL; 
-		strncpy(sym->name, name, length);
-		sym->name[length] = '\0';
-	} 
-
 	return sym;
 }
 
@@ -0,0 +1,130 @@
+#include "timereport.h"
+#include "compilercontext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+double report_clock() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+// charges the time since started to phase and returns now, so phases can be
+// timed back to back
+double time_phase(CompilerContext* ctx, report_phase_t phase, double started) {
+	double now = report_clock();
+	if (ctx->time_report) {
+		ctx->time_report->phase_ms[phase] += now - started;
+	}
+	return now;
+}
+
+TimeReport* create_time_report(bool json) {
+	TimeReport* report = calloc(1, sizeof(TimeReport));
+	if (!report) {
+		perror("In 'create_time_report', unable to allocate space for time report\n");
+		return NULL;
+	}
+	report->json = json;
+	return report;
+}
+
+const char* report_phase_name(report_phase_t phase) {
+	switch (phase) {
+		case REPORT_LEX: return "lex";
+		case REPORT_PARSE: return "parse";
+		case REPORT_RESOLVE: return "resolve";
+		case REPORT_TYPECHECK: return "typecheck";
+		case REPORT_TAC: return "tac";
+		case REPORT_FOLD: return "fold";
+		case REPORT_CFG: return "cfg";
+		case REPORT_REGALLOC: return "regalloc";
+		case REPORT_CODEGEN: return "codegen";
+		default: return "unknown";
+	}
+}
+
+const char* arena_name(arena_t type) {
+	switch (type) {
+		case LEXER_ARENA: return "lexer";
+		case AST_ARENA: return "ast";
+		case TYPE_ARENA: return "type";
+		case SYMBOL_ARENA: return "symbol";
+		case IR_ARENA: return "ir";
+		case CODEGEN_ARENA: return "codegen";
+		case ERROR_ARENA: return "error";
+		case STRING_ARENA: return "string";
+		default: return "unknown";
+	}
+}
+
+void add_arena_stats(TimeReport* report, Arena* A) {
+	if (!A) return;
+
+	ArenaStats stats = arena_stats(A);
+	report->arenas[A->type].used += stats.used;
+	report->arenas[A->type].reserved += stats.reserved;
+	report->arenas[A->type].blocks += stats.blocks;
+}
+
+// workers add their own arenas before freeing them, in compile_functions
+void collect_arena_stats(CompilerContext* ctx, TimeReport* report) {
+	add_arena_stats(report, ctx->lexer_arena);
+	add_arena_stats(report, ctx->ast_arena);
+	add_arena_stats(report, ctx->type_arena);
+	add_arena_stats(report, ctx->symbol_arena);
+	add_arena_stats(report, ctx->ir_arena);
+	add_arena_stats(report, ctx->codegen_arena);
+	add_arena_stats(report, ctx->error_arena);
+	add_arena_stats(report, ctx->string_arena);
+}
+
+void print_json_time_report(TimeReport* report) {
+	printf("{\"jobs\": %d, \"phases_ms\": {", report->jobs);
+	for (int i = 0; i < NUM_REPORT_PHASES; i++) {
+		printf("%s\"%s\": %.3f", i ? ", " : "", report_phase_name(i), report->phase_ms[i]);
+	}
+	printf("}, \"backend_ms\": %.3f, \"total_ms\": %.3f, \"arenas\": {", report->backend_ms, report->total_ms);
+
+	for (int i = 0; i < NUM_ARENAS; i++) {
+		ArenaStats* stats = &report->arenas[i];
+		printf("%s\"%s\": {\"used\": %zu, \"reserved\": %zu, \"blocks\": %d}",
+			i ? ", " : "", arena_name(i), stats->used, stats->reserved, stats->blocks);
+	}
+
+	printf("}, \"counts\": {\"tokens\": %ld, \"nodes\": %ld, \"functions\": %ld, "
+		"\"tac_instructions\": %ld, \"removed_instructions\": %ld, \"basic_blocks\": %ld, \"interference_edges\": %ld, \"spills\": %ld}}\n",
+		report->tokens, report->nodes, report->functions, report->tac_instructions, report->removed_instructions,
+		report->basic_blocks, report->interference_edges, report->spills);
+}
+
+void print_time_report(TimeReport* report) {
+	if (report->json) {
+		print_json_time_report(report);
+		return;
+	}
+
+	printf("phase              ms\n");
+	for (int i = 0; i < NUM_REPORT_PHASES; i++) {
+		printf("  %-12s %9.3f\n", report_phase_name(i), report->phase_ms[i]);
+	}
+	printf("  %-12s %9.3f  (--jobs %d)\n", "backend", report->backend_ms, report->jobs);
+	printf("  %-12s %9.3f\n", "total", report->total_ms);
+
+	printf("arena            used     reserved  blocks\n");
+	for (int i = 0; i < NUM_ARENAS; i++) {
+		ArenaStats* stats = &report->arenas[i];
+		printf("  %-8s %12zu %12zu %7d\n", arena_name(i), stats->used, stats->reserved, stats->blocks);
+	}
+
+	printf("counts\n");
+	printf("  %-20s %ld\n", "tokens", report->tokens);
+	printf("  %-20s %ld\n", "nodes", report->nodes);
+	printf("  %-20s %ld\n", "functions", report->functions);
+	printf("  %-20s %ld\n", "tac instructions", report->tac_instructions);
+	printf("  %-20s %ld\n", "removed instructions", report->removed_instructions);
+	printf("  %-20s %ld\n", "basic blocks", report->basic_blocks);
+	printf("  %-20s %ld\n", "interference edges", report->interference_edges);
+	printf("  %-20s %ld\n", "spills", report->spills);
+}
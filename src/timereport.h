@@ -0,0 +1,57 @@
+#ifndef TIME_REPORT_H
+#define TIME_REPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "bumpallocator.h"
+
+typedef struct CompilerContext CompilerContext;
+
+#define NUM_ARENAS 8
+
+typedef enum {
+	REPORT_LEX,
+	REPORT_PARSE,
+	REPORT_RESOLVE,
+	REPORT_TYPECHECK,
+	REPORT_TAC,
+	REPORT_FOLD,
+	REPORT_CFG,
+	REPORT_REGALLOC,
+	REPORT_CODEGEN,
+	NUM_REPORT_PHASES
+} report_phase_t;
+
+// --time-report: where the time and memory of one compile went. the front
+// end phases are wall time; the backend ones are summed over functions, so
+// with --jobs above 1 they can add up to more than backend_ms
+typedef struct TimeReport {
+	bool json;
+	double phase_ms[NUM_REPORT_PHASES];
+	double backend_ms;
+	double total_ms;
+
+	ArenaStats arenas[NUM_ARENAS]; // indexed by arena_t, workers' arenas included
+
+	long tokens;
+	long nodes;
+	long functions;
+	long tac_instructions;
+	long removed_instructions;
+	long basic_blocks;
+	long interference_edges;
+	long spills;
+	int jobs;
+} TimeReport;
+
+double report_clock();
+double time_phase(CompilerContext* ctx, report_phase_t phase, double started);
+TimeReport* create_time_report(bool json);
+const char* report_phase_name(report_phase_t phase);
+const char* arena_name(arena_t type);
+void add_arena_stats(TimeReport* report, Arena* A);
+void collect_arena_stats(CompilerContext* ctx, TimeReport* report);
+void print_json_time_report(TimeReport* report);
+void print_time_report(TimeReport* report);
+
+#endif